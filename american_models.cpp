@@ -0,0 +1,523 @@
+#include "american_models.h"
+#include "finite_difference.h"
+#include "math_utils.h"
+#include "pricing_exceptions.h"
+#include <cmath>
+#include <algorithm>
+#include <string>
+
+namespace {
+
+// Generalized Black-Scholes price with cost of carry b = r - q
+template<typename T>
+T generalizedBlackScholes(OptionStyle style, T S, T K, T r, T b, T sigma, T time) {
+    T sigmaSqrtT = sigma * std::sqrt(time);
+    T d1 = (std::log(S / K) + (b + T(0.5) * sigma * sigma) * time) / sigmaSqrtT;
+    T d2 = d1 - sigmaSqrtT;
+    T carry = std::exp((b - r) * time);
+    T discount = std::exp(-r * time);
+    if (style == OptionStyle::Call) {
+        return S * carry * normalCDF(d1) - K * discount * normalCDF(d2);
+    }
+    return K * discount * normalCDF(-d2) - S * carry * normalCDF(-d1);
+}
+
+// M / (1 - e^{-rT}) from Barone-Adesi & Whaley, with its limit 2 / (sigma^2 T) as r -> 0
+template<typename T>
+T discountedRateRatio(T r, T sigma, T time) {
+    T M = T(2) * r / (sigma * sigma);
+    if (r * time < T(1e-12)) {
+        return T(2) / (sigma * sigma * time);
+    }
+    return M / (T(1) - std::exp(-r * time));
+}
+
+// Critical stock price above which the Barone-Adesi & Whaley call is exercised
+template<typename T>
+T baroneAdesiWhaleyCallBoundary(T K, T r, T b, T sigma, T time) {
+    T N = T(2) * b / (sigma * sigma);
+    T M = T(2) * r / (sigma * sigma);
+    T q2 = (-(N - T(1)) + std::sqrt((N - T(1)) * (N - T(1)) + T(4) * discountedRateRatio(r, sigma, time))) / T(2);
+    T sqrtT = std::sqrt(time);
+
+    // Seed from the perpetual boundary
+    T q2Infinity = (-(N - T(1)) + std::sqrt((N - T(1)) * (N - T(1)) + T(4) * M)) / T(2);
+    T boundaryInfinity = K / (T(1) - T(1) / q2Infinity);
+    T h2 = -(b * time + T(2) * sigma * sqrtT) * K / (boundaryInfinity - K);
+    T Si = K + (boundaryInfinity - K) * (T(1) - std::exp(h2));
+
+    T carry = std::exp((b - r) * time);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        T d1 = (std::log(Si / K) + (b + T(0.5) * sigma * sigma) * time) / (sigma * sqrtT);
+        T pd1;
+        T nd1 = normalCDF(d1, pd1);
+        T rhs = generalizedBlackScholes(OptionStyle::Call, Si, K, r, b, sigma, time) +
+                (T(1) - carry * nd1) * Si / q2;
+        if (std::abs(Si - K - rhs) / K < T(1e-12)) {
+            break;
+        }
+        T slope = carry * nd1 * (T(1) - T(1) / q2) +
+                  (T(1) - carry * pd1 / (sigma * sqrtT)) / q2;
+        Si = (K + rhs - slope * Si) / (T(1) - slope);
+    }
+    return Si;
+}
+
+// Critical stock price below which the Barone-Adesi & Whaley put is exercised
+template<typename T>
+T baroneAdesiWhaleyPutBoundary(T K, T r, T b, T sigma, T time) {
+    T N = T(2) * b / (sigma * sigma);
+    T M = T(2) * r / (sigma * sigma);
+    T q1 = (-(N - T(1)) - std::sqrt((N - T(1)) * (N - T(1)) + T(4) * discountedRateRatio(r, sigma, time))) / T(2);
+    T sqrtT = std::sqrt(time);
+
+    // Seed from the perpetual boundary
+    T q1Infinity = (-(N - T(1)) - std::sqrt((N - T(1)) * (N - T(1)) + T(4) * M)) / T(2);
+    T boundaryInfinity = K / (T(1) - T(1) / q1Infinity);
+    T h1 = (b * time - T(2) * sigma * sqrtT) * K / (K - boundaryInfinity);
+    T Si = boundaryInfinity + (K - boundaryInfinity) * std::exp(h1);
+
+    T carry = std::exp((b - r) * time);
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        T d1 = (std::log(Si / K) + (b + T(0.5) * sigma * sigma) * time) / (sigma * sqrtT);
+        T pd1;
+        T nd1 = normalCDF(-d1, pd1);
+        T rhs = generalizedBlackScholes(OptionStyle::Put, Si, K, r, b, sigma, time) -
+                (T(1) - carry * nd1) * Si / q1;
+        if (std::abs(K - Si - rhs) / K < T(1e-12)) {
+            break;
+        }
+        T slope = -carry * nd1 * (T(1) - T(1) / q1) -
+                  (T(1) + carry * pd1 / (sigma * sqrtT)) / q1;
+        Si = (K - rhs + slope * Si) / (T(1) + slope);
+    }
+    return Si;
+}
+
+template<typename T>
+T baroneAdesiWhaleyPrice(OptionStyle style, T S, T K, T r, T q, T sigma, T time) {
+    T b = r - q;
+    T european = generalizedBlackScholes(style, S, K, r, b, sigma, time);
+    T carry = std::exp((b - r) * time);
+    T N = T(2) * b / (sigma * sigma);
+    T ratio = discountedRateRatio(r, sigma, time);
+
+    if (style == OptionStyle::Call) {
+        // Never optimal to exercise a call early without a dividend yield
+        if (b >= r) {
+            return european;
+        }
+        T boundary = baroneAdesiWhaleyCallBoundary(K, r, b, sigma, time);
+        if (S >= boundary) {
+            return S - K;
+        }
+        T q2 = (-(N - T(1)) + std::sqrt((N - T(1)) * (N - T(1)) + T(4) * ratio)) / T(2);
+        T d1 = (std::log(boundary / K) + (b + T(0.5) * sigma * sigma) * time) / (sigma * std::sqrt(time));
+        T A2 = boundary / q2 * (T(1) - carry * normalCDF(d1));
+        return european + A2 * std::pow(S / boundary, q2);
+    }
+
+    // Without interest there is no reason to exercise a put early
+    if (r <= T(0)) {
+        return european;
+    }
+    T boundary = baroneAdesiWhaleyPutBoundary(K, r, b, sigma, time);
+    if (S <= boundary) {
+        return K - S;
+    }
+    T q1 = (-(N - T(1)) - std::sqrt((N - T(1)) * (N - T(1)) + T(4) * ratio)) / T(2);
+    T d1 = (std::log(boundary / K) + (b + T(0.5) * sigma * sigma) * time) / (sigma * std::sqrt(time));
+    T A1 = -boundary / q1 * (T(1) - carry * normalCDF(-d1));
+    return european + A1 * std::pow(S / boundary, q1);
+}
+
+// Bjerksund-Stensland helper functions phi and psi (Haug's notation)
+template<typename T>
+T bjerksundPhi(T S, T time, T gamma, T H, T I, T r, T b, T sigma) {
+    T sigmaSqrtT = sigma * std::sqrt(time);
+    T lambda = (-r + gamma * b + T(0.5) * gamma * (gamma - T(1)) * sigma * sigma) * time;
+    T d = -(std::log(S / H) + (b + (gamma - T(0.5)) * sigma * sigma) * time) / sigmaSqrtT;
+    T kappa = T(2) * b / (sigma * sigma) + T(2) * gamma - T(1);
+    return std::exp(lambda) * std::pow(S, gamma) *
+           (normalCDF(d) - std::pow(I / S, kappa) * normalCDF(d - T(2) * std::log(I / S) / sigmaSqrtT));
+}
+
+template<typename T>
+T bjerksundPsi(T S, T time, T gamma, T H, T I2, T I1, T t1, T r, T b, T sigma) {
+    T drift1 = (b + (gamma - T(0.5)) * sigma * sigma) * t1;
+    T drift2 = (b + (gamma - T(0.5)) * sigma * sigma) * time;
+    T vol1 = sigma * std::sqrt(t1);
+    T vol2 = sigma * std::sqrt(time);
+
+    T e1 = (std::log(S / I1) + drift1) / vol1;
+    T e2 = (std::log(I2 * I2 / (S * I1)) + drift1) / vol1;
+    T e3 = (std::log(S / I1) - drift1) / vol1;
+    T e4 = (std::log(I2 * I2 / (S * I1)) - drift1) / vol1;
+
+    T f1 = (std::log(S / H) + drift2) / vol2;
+    T f2 = (std::log(I2 * I2 / (S * H)) + drift2) / vol2;
+    T f3 = (std::log(I1 * I1 / (S * H)) + drift2) / vol2;
+    T f4 = (std::log(S * I1 * I1 / (H * I2 * I2)) + drift2) / vol2;
+
+    T rho = std::sqrt(t1 / time);
+    T lambda = -r + gamma * b + T(0.5) * gamma * (gamma - T(1)) * sigma * sigma;
+    T kappa = T(2) * b / (sigma * sigma) + T(2) * gamma - T(1);
+
+    return std::exp(lambda * time) * std::pow(S, gamma) *
+           (bivariateNormalCDF(-e1, -f1, rho)
+            - std::pow(I2 / S, kappa) * bivariateNormalCDF(-e2, -f2, rho)
+            - std::pow(I1 / S, kappa) * bivariateNormalCDF(-e3, -f3, -rho)
+            + std::pow(I1 / I2, kappa) * bivariateNormalCDF(-e4, -f4, -rho));
+}
+
+template<typename T>
+T bjerksundStenslandCall(T S, T K, T r, T b, T sigma, T time) {
+    // Never optimal to exercise a call early without a dividend yield
+    if (b >= r) {
+        return generalizedBlackScholes(OptionStyle::Call, S, K, r, b, sigma, time);
+    }
+
+    T t1 = T(0.5) * (std::sqrt(T(5)) - T(1)) * time;
+    T sigma2 = sigma * sigma;
+    T beta = (T(0.5) - b / sigma2) + std::sqrt((b / sigma2 - T(0.5)) * (b / sigma2 - T(0.5)) + T(2) * r / sigma2);
+    T boundaryInfinity = beta / (beta - T(1)) * K;
+    T boundaryZero = std::max(K, r / (r - b) * K);
+
+    T ht1 = -(b * t1 + T(2) * sigma * std::sqrt(t1)) * K * K / ((boundaryInfinity - boundaryZero) * boundaryZero);
+    T ht2 = -(b * time + T(2) * sigma * std::sqrt(time)) * K * K / ((boundaryInfinity - boundaryZero) * boundaryZero);
+    T I1 = boundaryZero + (boundaryInfinity - boundaryZero) * (T(1) - std::exp(ht1));
+    T I2 = boundaryZero + (boundaryInfinity - boundaryZero) * (T(1) - std::exp(ht2));
+
+    if (S >= I2) {
+        return S - K;
+    }
+
+    T alpha1 = (I1 - K) * std::pow(I1, -beta);
+    T alpha2 = (I2 - K) * std::pow(I2, -beta);
+
+    return alpha2 * std::pow(S, beta)
+         - alpha2 * bjerksundPhi(S, t1, beta, I2, I2, r, b, sigma)
+         + bjerksundPhi(S, t1, T(1), I2, I2, r, b, sigma)
+         - bjerksundPhi(S, t1, T(1), I1, I2, r, b, sigma)
+         - K * bjerksundPhi(S, t1, T(0), I2, I2, r, b, sigma)
+         + K * bjerksundPhi(S, t1, T(0), I1, I2, r, b, sigma)
+         + alpha1 * bjerksundPhi(S, t1, beta, I1, I2, r, b, sigma)
+         - alpha1 * bjerksundPsi(S, time, beta, I1, I2, I1, t1, r, b, sigma)
+         + bjerksundPsi(S, time, T(1), I1, I2, I1, t1, r, b, sigma)
+         - bjerksundPsi(S, time, T(1), K, I2, I1, t1, r, b, sigma)
+         - K * bjerksundPsi(S, time, T(0), I1, I2, I1, t1, r, b, sigma)
+         + K * bjerksundPsi(S, time, T(0), K, I2, I1, t1, r, b, sigma);
+}
+
+// Gauss-Legendre rule with n points mapped to [0, 1]
+template<typename T>
+void gaussLegendre(int n, std::vector<T>& abscissas, std::vector<T>& weights) {
+    abscissas.assign(n, T(0));
+    weights.assign(n, T(0));
+    for (int i = 0; i < (n + 1) / 2; ++i) {
+        double x = std::cos(M_PI * (i + 0.75) / (n + 0.5));
+        double derivative = 0.0;
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            double p0 = 1.0;
+            double p1 = 0.0;
+            for (int j = 0; j < n; ++j) {
+                double p2 = p1;
+                p1 = p0;
+                p0 = ((2.0 * j + 1.0) * x * p1 - j * p2) / (j + 1.0);
+            }
+            derivative = n * (x * p0 - p1) / (x * x - 1.0);
+            double dx = p0 / derivative;
+            x -= dx;
+            if (std::abs(dx) < 1e-15) {
+                break;
+            }
+        }
+        double weight = 2.0 / ((1.0 - x * x) * derivative * derivative);
+        abscissas[i] = T(0.5 * (1.0 - x));
+        abscissas[n - 1 - i] = T(0.5 * (1.0 + x));
+        weights[i] = weights[n - 1 - i] = T(0.5 * weight);
+    }
+}
+
+// Finite-difference Greeks around a cheap pricing function, using the repo's theta
+// convention (price decay per year as expiry shortens)
+template<typename T, typename PriceFunction>
+PricingResultT<T> approximationResult(const OptionParametersT<T>& params, PriceFunction price) {
+    const T h = params.S * T(0.0001);                    // Step for delta/gamma
+    const T dt = std::min(T(1) / T(365), params.expiry / T(2));
+    const T dvol = T(0.0001);                            // Step for vega
+    const T dr = T(0.0001);                              // Step for rho
+
+    PricingResultT<T> result;
+    result.price = price(params);
+
+    OptionParametersT<T> up = params, down = params, theta = params, vega = params, rho = params;
+    up.S += h;
+    down.S -= h;
+    theta.expiry -= dt;
+    vega.sigma += dvol;
+    rho.r += dr;
+
+    T priceUp = price(up);
+    T priceDown = price(down);
+    result.greeks.delta = (priceUp - priceDown) / (T(2) * h);
+    result.greeks.gamma = (priceUp - T(2) * result.price + priceDown) / (h * h);
+    result.greeks.theta = (result.price - price(theta)) / dt;
+    result.greeks.vega = (price(vega) - result.price) / dvol;
+    result.greeks.rho = (price(rho) - result.price) / dr;
+    return result;
+}
+
+} // namespace
+
+template<typename T>
+T BaroneAdesiWhaleyModelT<T>::calculatePrice(const OptionParametersT<T>& params) const {
+    validateOptionParametersT(params);
+    if (params.type == OptionType::European) {
+        return generalizedBlackScholes(params.style, params.S, params.K, params.r, params.r - params.q,
+                                       params.sigma, params.expiry);
+    }
+    return baroneAdesiWhaleyPrice(params.style, params.S, params.K, params.r, params.q, params.sigma, params.expiry);
+}
+
+template<typename T>
+PricingResultT<T> BaroneAdesiWhaleyModelT<T>::calculate(const OptionParametersT<T>& params) const {
+    if (params.type == OptionType::European) {
+        return BlackScholesModelT<T>().calculate(params);
+    }
+    validateOptionParametersT(params);
+    return approximationResult(params, [this](const OptionParametersT<T>& p) { return calculatePrice(p); });
+}
+
+template<typename T>
+T BjerksundStenslandModelT<T>::calculatePrice(const OptionParametersT<T>& params) const {
+    validateOptionParametersT(params);
+    T b = params.r - params.q;
+    if (params.type == OptionType::European) {
+        return generalizedBlackScholes(params.style, params.S, params.K, params.r, b, params.sigma, params.expiry);
+    }
+    if (params.style == OptionStyle::Call) {
+        return bjerksundStenslandCall(params.S, params.K, params.r, b, params.sigma, params.expiry);
+    }
+    // Put-call transformation P(S, K, r, b) = C(K, S, r - b, -b)
+    return bjerksundStenslandCall(params.K, params.S, params.r - b, -b, params.sigma, params.expiry);
+}
+
+template<typename T>
+PricingResultT<T> BjerksundStenslandModelT<T>::calculate(const OptionParametersT<T>& params) const {
+    if (params.type == OptionType::European) {
+        return BlackScholesModelT<T>().calculate(params);
+    }
+    validateOptionParametersT(params);
+    return approximationResult(params, [this](const OptionParametersT<T>& p) { return calculatePrice(p); });
+}
+
+template<typename T>
+AndersenLakeOffengeltModelT<T>::AndersenLakeOffengeltModelT(AloAccuracy accuracy) {
+    int boundaryPoints;
+    int pricePoints;
+    switch (accuracy) {
+        case AloAccuracy::Fast:
+            boundaryNodes = 7;
+            iterations = 3;
+            boundaryPoints = 15;
+            pricePoints = 31;
+            break;
+        case AloAccuracy::Accurate:
+            boundaryNodes = 10;
+            iterations = 5;
+            boundaryPoints = 21;
+            pricePoints = 41;
+            break;
+        case AloAccuracy::HighPrecision:
+        default:
+            boundaryNodes = 16;
+            iterations = 8;
+            boundaryPoints = 31;
+            pricePoints = 63;
+            break;
+    }
+    gaussLegendre(boundaryPoints, boundaryAbscissas, boundaryWeights);
+    gaussLegendre(pricePoints, priceAbscissas, priceWeights);
+}
+
+template<typename T>
+T AndersenLakeOffengeltModelT<T>::putPrice(T S, T K, T r, T q, T sigma, T expiry) const {
+    T european = generalizedBlackScholes(OptionStyle::Put, S, K, r, r - q, sigma, expiry);
+
+    // Without interest there is no reason to exercise a put early
+    if (r <= T(0)) {
+        return european;
+    }
+
+    // Boundary just before expiry
+    T X = q > r ? K * r / q : K;
+    T sqrtExpiry = std::sqrt(expiry);
+    const int n = boundaryNodes;
+
+    // The boundary is tracked as H(xi) = log(B / X)^2 on Chebyshev-Lobatto nodes in
+    // xi = sqrt(tau), where it is close to linear. Node 0 is tau = 0 with B = X.
+    std::vector<T> tau(n + 1), boundary(n + 1), H(n + 1);
+    for (int i = 0; i <= n; ++i) {
+        T z = -std::cos(T(M_PI) * T(i) / T(n));
+        T xi = T(0.5) * sqrtExpiry * (T(1) + z);
+        tau[i] = xi * xi;
+    }
+
+    // Chebyshev coefficients of H and evaluation of the interpolated boundary
+    std::vector<T> coefficients(n + 1);
+    auto fitBoundary = [&]() {
+        for (int i = 0; i <= n; ++i) {
+            T logRatio = std::log(std::min(boundary[i], X) / X);
+            H[i] = logRatio * logRatio;
+        }
+        for (int k = 0; k <= n; ++k) {
+            T sum = T(0);
+            for (int i = 0; i <= n; ++i) {
+                T weight = (i == 0 || i == n) ? T(0.5) : T(1);
+                sum += weight * H[i] * std::cos(T(M_PI) * T(k) * T(i) / T(n));
+            }
+            // Nodes run from z = -1, so T_k(z_i) = (-1)^k cos(k i pi / n)
+            T scale = (k == 0 || k == n) ? T(1) / T(n) : T(2) / T(n);
+            coefficients[k] = (k % 2 ? -scale : scale) * sum;
+        }
+    };
+    auto boundaryAt = [&](T t) {
+        if (t <= T(0)) {
+            return X;
+        }
+        T z = T(2) * std::sqrt(t) / sqrtExpiry - T(1);
+        // Clenshaw recurrence
+        T b1 = T(0), b2 = T(0);
+        for (int k = n; k >= 1; --k) {
+            T b0 = T(2) * z * b1 - b2 + coefficients[k];
+            b2 = b1;
+            b1 = b0;
+        }
+        T h = std::max(T(0), z * b1 - b2 + coefficients[0]);
+        return X * std::exp(-std::sqrt(h));
+    };
+
+    auto dPlus = [&](T t, T moneyness) {
+        return (std::log(moneyness) + (r - q + T(0.5) * sigma * sigma) * t) / (sigma * std::sqrt(t));
+    };
+    auto dMinus = [&](T t, T moneyness) {
+        return (std::log(moneyness) + (r - q - T(0.5) * sigma * sigma) * t) / (sigma * std::sqrt(t));
+    };
+
+    // Initial guess from the Barone-Adesi & Whaley critical price at each node
+    boundary[0] = X;
+    for (int i = 1; i <= n; ++i) {
+        boundary[i] = std::min(X, baroneAdesiWhaleyPutBoundary(K, r, r - q, sigma, tau[i]));
+    }
+    fitBoundary();
+
+    // Fixed-point iteration B = K exp(-(r - q) tau) N / D built from the smooth-pasting
+    // condition (ALO's FP-B). The integrals substitute tau - u = s^2 to remove the
+    // 1 / sqrt(tau - u) singularity.
+    const int m = int(boundaryAbscissas.size());
+    std::vector<T> next(n + 1);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        next[0] = X;
+        for (int i = 1; i <= n; ++i) {
+            T t = tau[i];
+            T B = boundary[i];
+            T sqrtT = std::sqrt(t);
+
+            T densityPlus;
+            T numerator = normalPDF(dMinus(t, B / K)) / (sigma * sqrtT);
+            T denominator = normalCDF(dPlus(t, B / K), densityPlus) + densityPlus / (sigma * sqrtT);
+
+            T numeratorIntegral = T(0);
+            T denominatorIntegral = T(0);
+            for (int j = 0; j < m; ++j) {
+                T s = sqrtT * boundaryAbscissas[j];
+                T u = t - s * s;
+                T ratio = B / boundaryAt(u);
+                T weight = sqrtT * boundaryWeights[j];
+                T dp = dPlus(s * s, ratio);
+                T dm = dMinus(s * s, ratio);
+                // du = 2 s ds, and phi / (sigma s) * 2 s = 2 phi / sigma
+                numeratorIntegral += weight * std::exp(r * u) * T(2) * normalPDF(dm) / sigma;
+                T densityPlus;
+                T cumulativePlus = normalCDF(dp, densityPlus);
+                denominatorIntegral += weight * std::exp(q * u) *
+                                       (T(2) * s * cumulativePlus + T(2) * densityPlus / sigma);
+            }
+            numerator += r * numeratorIntegral;
+            denominator += q * denominatorIntegral;
+
+            next[i] = std::min(X, K * std::exp(-(r - q) * t) * numerator / denominator);
+        }
+        boundary = next;
+        fitBoundary();
+    }
+
+    if (S <= boundaryAt(expiry)) {
+        return K - S;
+    }
+
+    // Early exercise premium, integrated over s = sqrt(expiry - u)
+    const int p = int(priceAbscissas.size());
+    T premium = T(0);
+    for (int j = 0; j < p; ++j) {
+        T s = sqrtExpiry * priceAbscissas[j];
+        T u = expiry - s * s;
+        T ratio = S / boundaryAt(u);
+        T t = s * s;
+        T integrand = r * K * std::exp(-r * t) * normalCDF(-dMinus(t, ratio)) -
+                      q * S * std::exp(-q * t) * normalCDF(-dPlus(t, ratio));
+        premium += sqrtExpiry * priceWeights[j] * T(2) * s * integrand;
+    }
+
+    return std::max(european + premium, K - S);
+}
+
+template<typename T>
+T AndersenLakeOffengeltModelT<T>::calculatePrice(const OptionParametersT<T>& params) const {
+    validateOptionParametersT(params);
+    if (params.type == OptionType::European) {
+        return generalizedBlackScholes(params.style, params.S, params.K, params.r, params.r - params.q,
+                                       params.sigma, params.expiry);
+    }
+    if (params.style == OptionStyle::Put) {
+        return putPrice(params.S, params.K, params.r, params.q, params.sigma, params.expiry);
+    }
+    // Put-call symmetry C(S, K, r, q) = P(K, S, q, r)
+    return putPrice(params.K, params.S, params.q, params.r, params.sigma, params.expiry);
+}
+
+template<typename T>
+PricingResultT<T> AndersenLakeOffengeltModelT<T>::calculate(const OptionParametersT<T>& params) const {
+    if (params.type == OptionType::European) {
+        return BlackScholesModelT<T>().calculate(params);
+    }
+    validateOptionParametersT(params);
+    return approximationResult(params, [this](const OptionParametersT<T>& p) { return calculatePrice(p); });
+}
+
+template<typename T>
+PricingModelPtr<T> createPricingModelT(OptionType type, AmericanModel americanModel, int steps) {
+    if (type == OptionType::European) {
+        return std::make_unique<BlackScholesModelT<T>>();
+    }
+    switch (americanModel) {
+        case AmericanModel::BaroneAdesiWhaley:
+            return std::make_unique<BaroneAdesiWhaleyModelT<T>>();
+        case AmericanModel::BjerksundStensland:
+            return std::make_unique<BjerksundStenslandModelT<T>>();
+        case AmericanModel::AndersenLakeOffengelt:
+            return std::make_unique<AndersenLakeOffengeltModelT<T>>();
+        case AmericanModel::CrankNicolson:
+            return std::make_unique<CrankNicolsonModelT<T>>();
+        case AmericanModel::Binomial:
+        default:
+            return std::make_unique<BinomialModelT<T>>(steps);
+    }
+}
+
+// Explicit instantiations
+template class BaroneAdesiWhaleyModelT<double>;
+template class BjerksundStenslandModelT<double>;
+template class AndersenLakeOffengeltModelT<double>;
+template PricingModelPtr<double> createPricingModelT<double>(OptionType, AmericanModel, int);
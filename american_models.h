@@ -0,0 +1,68 @@
+#ifndef AMERICAN_MODELS_H
+#define AMERICAN_MODELS_H
+
+#include "option_pricing.h"
+#include <vector>
+
+// Analytic and semi-analytic approximations for American options. European
+// options passed to these models are priced with Black-Scholes. Greeks come
+// from bumping the (cheap) approximation itself.
+
+// Barone-Adesi & Whaley (1987) quadratic approximation
+template<typename T = double>
+class BaroneAdesiWhaleyModelT : public PricingModelBaseT<T> {
+public:
+    PricingResultT<T> calculate(const OptionParametersT<T>& params) const override;
+    T calculatePrice(const OptionParametersT<T>& params) const;
+
+    double costEstimate(const OptionParametersT<T>& params) const override {
+        return params.type == OptionType::American ? 30.0 : 1.0;
+    }
+};
+
+// Bjerksund & Stensland (2002) two-step flat boundary approximation
+template<typename T = double>
+class BjerksundStenslandModelT : public PricingModelBaseT<T> {
+public:
+    PricingResultT<T> calculate(const OptionParametersT<T>& params) const override;
+    T calculatePrice(const OptionParametersT<T>& params) const;
+
+    double costEstimate(const OptionParametersT<T>& params) const override {
+        return params.type == OptionType::American ? 400.0 : 1.0;
+    }
+};
+
+// Andersen, Lake & Offengelt (2016) style solver: the early-exercise boundary is found
+// by fixed-point iteration on its integral equation, interpolated with Chebyshev
+// polynomials in sqrt(time), and the price follows from the early exercise premium.
+template<typename T = double>
+class AndersenLakeOffengeltModelT : public PricingModelBaseT<T> {
+public:
+    explicit AndersenLakeOffengeltModelT(AloAccuracy accuracy = AloAccuracy::Accurate);
+
+    PricingResultT<T> calculate(const OptionParametersT<T>& params) const override;
+    T calculatePrice(const OptionParametersT<T>& params) const;
+
+    double costEstimate(const OptionParametersT<T>& params) const override {
+        if (params.type == OptionType::European) {
+            return 1.0;
+        }
+        return 6.0 * iterations * (boundaryNodes + 1) * boundaryAbscissas.size();
+    }
+
+private:
+    int boundaryNodes;       // Chebyshev nodes for the boundary
+    int iterations;          // Fixed-point iterations
+    // Gauss-Legendre rules on [0, 1] for the boundary and price integrals
+    std::vector<T> boundaryAbscissas, boundaryWeights;
+    std::vector<T> priceAbscissas, priceWeights;
+
+    T putPrice(T S, T K, T r, T q, T sigma, T expiry) const;
+};
+
+// Type aliases for backward compatibility
+using BaroneAdesiWhaleyModel = BaroneAdesiWhaleyModelT<double>;
+using BjerksundStenslandModel = BjerksundStenslandModelT<double>;
+using AndersenLakeOffengeltModel = AndersenLakeOffengeltModelT<double>;
+
+#endif // AMERICAN_MODELS_H
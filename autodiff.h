@@ -0,0 +1,337 @@
+#ifndef AUTODIFF_H
+#define AUTODIFF_H
+
+#include "option_pricing.h"
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Automatic differentiation number types for the T parameter of the pricing templates.
+// Math functions are found by argument-dependent lookup, so templated code calls them
+// unqualified after `using std::exp;` and friends.
+
+// Forward mode: a value carrying N directional derivatives. V may itself be a DualT, which
+// gives second derivatives (DualT<DualT<double, 1>, N>).
+template<typename V, int N>
+struct DualT {
+    V value{};
+    V grad[N]{};
+
+    DualT() = default;
+
+    // Constants, from anything the value type accepts
+    template<typename A, typename = std::enable_if_t<std::is_convertible_v<A, V> &&
+                                                     !std::is_same_v<std::decay_t<A>, DualT>>>
+    DualT(const A& constant) : value(constant) {}
+
+    friend DualT operator+(const DualT& a, const DualT& b) {
+        DualT c;
+        c.value = a.value + b.value;
+        for (int i = 0; i < N; ++i) c.grad[i] = a.grad[i] + b.grad[i];
+        return c;
+    }
+    friend DualT operator-(const DualT& a, const DualT& b) {
+        DualT c;
+        c.value = a.value - b.value;
+        for (int i = 0; i < N; ++i) c.grad[i] = a.grad[i] - b.grad[i];
+        return c;
+    }
+    friend DualT operator-(const DualT& a) {
+        DualT c;
+        c.value = -a.value;
+        for (int i = 0; i < N; ++i) c.grad[i] = -a.grad[i];
+        return c;
+    }
+    friend DualT operator*(const DualT& a, const DualT& b) {
+        DualT c;
+        c.value = a.value * b.value;
+        for (int i = 0; i < N; ++i) c.grad[i] = a.grad[i] * b.value + a.value * b.grad[i];
+        return c;
+    }
+    friend DualT operator/(const DualT& a, const DualT& b) {
+        DualT c;
+        c.value = a.value / b.value;
+        for (int i = 0; i < N; ++i) c.grad[i] = (a.grad[i] - c.value * b.grad[i]) / b.value;
+        return c;
+    }
+    DualT& operator+=(const DualT& b) { return *this = *this + b; }
+    DualT& operator-=(const DualT& b) { return *this = *this - b; }
+    DualT& operator*=(const DualT& b) { return *this = *this * b; }
+    DualT& operator/=(const DualT& b) { return *this = *this / b; }
+
+    // Comparisons look at the value only
+    friend bool operator<(const DualT& a, const DualT& b) { return a.value < b.value; }
+    friend bool operator>(const DualT& a, const DualT& b) { return a.value > b.value; }
+    friend bool operator<=(const DualT& a, const DualT& b) { return a.value <= b.value; }
+    friend bool operator>=(const DualT& a, const DualT& b) { return a.value >= b.value; }
+    friend bool operator==(const DualT& a, const DualT& b) { return a.value == b.value; }
+    friend bool operator!=(const DualT& a, const DualT& b) { return a.value != b.value; }
+
+    // f(a) with f'(a) = derivative
+    friend DualT chain(const DualT& a, const V& value, const V& derivative) {
+        DualT c;
+        c.value = value;
+        for (int i = 0; i < N; ++i) c.grad[i] = derivative * a.grad[i];
+        return c;
+    }
+    friend DualT exp(const DualT& a) {
+        using std::exp;
+        V e = exp(a.value);
+        return chain(a, e, e);
+    }
+    friend DualT log(const DualT& a) {
+        using std::log;
+        return chain(a, log(a.value), V(1) / a.value);
+    }
+    friend DualT sqrt(const DualT& a) {
+        using std::sqrt;
+        V s = sqrt(a.value);
+        return chain(a, s, V(0.5) / s);
+    }
+    friend DualT abs(const DualT& a) { return a.value < V(0) ? -a : a; }
+    friend bool isnan(const DualT& a) { using std::isnan; return isnan(a.value); }
+    friend bool isinf(const DualT& a) { using std::isinf; return isinf(a.value); }
+    friend bool isfinite(const DualT& a) { using std::isfinite; return isfinite(a.value); }
+};
+
+// Reverse mode: operations on AdjointT record onto the calling thread's tape, and one
+// backward sweep then yields the derivative of a result with respect to every input.
+// Partials are of type V, so AdjointT<DualT<double, 1>> differentiates the adjoints once
+// more in a forward direction (second order).
+template<typename V>
+class AdjointTapeT {
+public:
+    struct Entry {
+        int parent[2];
+        V partial[2];
+    };
+
+    static AdjointTapeT& active() {
+        thread_local AdjointTapeT tape;
+        return tape;
+    }
+
+    int record(int a, const V& da, int b, const V& db) {
+        entries.push_back({{a, b}, {da, db}});
+        return int(entries.size()) - 1;
+    }
+
+    void clear() { entries.clear(); }
+    std::size_t size() const { return entries.size(); }
+
+    // d(output)/d(entry) for every entry up to output
+    std::vector<V> adjoints(int output) const {
+        std::vector<V> bar(output + 1);
+        bar[output] = V(1);
+        for (int i = output; i >= 0; --i) {
+            const Entry& e = entries[i];
+            for (int k = 0; k < 2; ++k) {
+                if (e.parent[k] >= 0) {
+                    bar[e.parent[k]] += e.partial[k] * bar[i];
+                }
+            }
+        }
+        return bar;
+    }
+
+private:
+    std::vector<Entry> entries;
+};
+
+template<typename V>
+struct AdjointT {
+    V value{};
+    int index = -1;   // Tape entry, or -1 for a constant
+
+    AdjointT() = default;
+
+    template<typename A, typename = std::enable_if_t<std::is_convertible_v<A, V> &&
+                                                     !std::is_same_v<std::decay_t<A>, AdjointT>>>
+    AdjointT(const A& constant) : value(constant) {}
+
+    // A new independent variable on the active tape
+    static AdjointT variable(const V& value) {
+        AdjointT x;
+        x.value = value;
+        x.index = AdjointTapeT<V>::active().record(-1, V(0), -1, V(0));
+        return x;
+    }
+
+    // Result with value and partials da, db with respect to a and b. Constants are folded.
+    static AdjointT node(const V& value, const AdjointT& a, const V& da, const AdjointT& b, const V& db) {
+        AdjointT c;
+        c.value = value;
+        if (a.index >= 0 || b.index >= 0) {
+            c.index = AdjointTapeT<V>::active().record(a.index, da, b.index, db);
+        }
+        return c;
+    }
+    static AdjointT node(const V& value, const AdjointT& a, const V& da) {
+        return node(value, a, da, AdjointT(), V(0));
+    }
+
+    friend AdjointT operator+(const AdjointT& a, const AdjointT& b) {
+        return node(a.value + b.value, a, V(1), b, V(1));
+    }
+    friend AdjointT operator-(const AdjointT& a, const AdjointT& b) {
+        return node(a.value - b.value, a, V(1), b, V(-1));
+    }
+    friend AdjointT operator-(const AdjointT& a) {
+        return node(-a.value, a, V(-1));
+    }
+    friend AdjointT operator*(const AdjointT& a, const AdjointT& b) {
+        return node(a.value * b.value, a, b.value, b, a.value);
+    }
+    friend AdjointT operator/(const AdjointT& a, const AdjointT& b) {
+        V c = a.value / b.value;
+        return node(c, a, V(1) / b.value, b, -c / b.value);
+    }
+    AdjointT& operator+=(const AdjointT& b) { return *this = *this + b; }
+    AdjointT& operator-=(const AdjointT& b) { return *this = *this - b; }
+    AdjointT& operator*=(const AdjointT& b) { return *this = *this * b; }
+    AdjointT& operator/=(const AdjointT& b) { return *this = *this / b; }
+
+    friend bool operator<(const AdjointT& a, const AdjointT& b) { return a.value < b.value; }
+    friend bool operator>(const AdjointT& a, const AdjointT& b) { return a.value > b.value; }
+    friend bool operator<=(const AdjointT& a, const AdjointT& b) { return a.value <= b.value; }
+    friend bool operator>=(const AdjointT& a, const AdjointT& b) { return a.value >= b.value; }
+    friend bool operator==(const AdjointT& a, const AdjointT& b) { return a.value == b.value; }
+    friend bool operator!=(const AdjointT& a, const AdjointT& b) { return a.value != b.value; }
+
+    friend AdjointT exp(const AdjointT& a) {
+        using std::exp;
+        V e = exp(a.value);
+        return node(e, a, e);
+    }
+    friend AdjointT log(const AdjointT& a) {
+        using std::log;
+        return node(log(a.value), a, V(1) / a.value);
+    }
+    friend AdjointT sqrt(const AdjointT& a) {
+        using std::sqrt;
+        V s = sqrt(a.value);
+        return node(s, a, V(0.5) / s);
+    }
+    friend AdjointT abs(const AdjointT& a) { return a.value < V(0) ? -a : a; }
+    friend bool isnan(const AdjointT& a) { using std::isnan; return isnan(a.value); }
+    friend bool isinf(const AdjointT& a) { using std::isinf; return isinf(a.value); }
+    friend bool isfinite(const AdjointT& a) { using std::isfinite; return isfinite(a.value); }
+};
+
+// Number types used for Greeks. Both carry an inner tangent in spot for gamma.
+using Dual = DualT<double, 1>;
+using HyperDual = DualT<Dual, 4>;        // Outer tangents: S, sigma, r, expiry
+using Adjoint = AdjointT<Dual>;
+
+namespace autodiff_detail {
+
+template<typename T>
+T modelPrice(const BlackScholesModelT<T>& model, const OptionParametersT<T>& params) {
+    return model.calculate(params).price;
+}
+
+template<typename T>
+T modelPrice(const BinomialModelT<T>& model, const OptionParametersT<T>& params) {
+    return model.calculatePrice(params);
+}
+
+// A lattice price is piecewise linear in spot, so its second derivative there is zero. For
+// such models gamma is read from the tree nodes of a double valuation instead.
+template<typename T>
+constexpr bool hasNodeGamma(const BlackScholesModelT<T>&) {
+    return false;
+}
+
+template<typename T>
+constexpr bool hasNodeGamma(const BinomialModelT<T>&) {
+    return true;
+}
+
+template<template<typename> class Model, typename... Args>
+double nodeGamma(const OptionParameters& params, const Args&... modelArgs) {
+    return Model<double>(modelArgs...).calculate(params).greeks.gamma;
+}
+
+template<typename T>
+OptionParametersT<T> liftParameters(const OptionParameters& params) {
+    OptionParametersT<T> lifted;
+    lifted.S = params.S;
+    lifted.K = params.K;
+    lifted.r = params.r;
+    lifted.q = params.q;
+    lifted.sigma = params.sigma;
+    lifted.expiry = params.expiry;
+    lifted.type = params.type;
+    lifted.style = params.style;
+    return lifted;
+}
+
+} // namespace autodiff_detail
+
+// Price and Greeks from one forward-mode valuation of Model<HyperDual>, e.g.
+// forwardModeGreeks<BinomialModelT>(params, 500). Gamma is the second derivative in spot,
+// except for BinomialModelT, whose gamma comes from the nodes of a double tree as in
+// BinomialModelT::calculate. On a 500-step tree this costs about 15x that calculate (35-55x
+// in adjoint mode), so lattice models are better served by their own Greeks.
+template<template<typename> class Model, typename... Args>
+PricingResult forwardModeGreeks(const OptionParameters& params, const Args&... modelArgs) {
+    OptionParametersT<HyperDual> x = autodiff_detail::liftParameters<HyperDual>(params);
+    x.S.value.grad[0] = 1.0;
+    x.S.grad[0] = Dual(1.0);
+    x.sigma.grad[1] = Dual(1.0);
+    x.r.grad[2] = Dual(1.0);
+    x.expiry.grad[3] = Dual(1.0);
+
+    Model<HyperDual> model(modelArgs...);
+    HyperDual price = autodiff_detail::modelPrice(model, x);
+
+    PricingResult result;
+    result.price = price.value.value;
+    result.greeks.delta = price.grad[0].value;
+    result.greeks.gamma = price.grad[0].grad[0];
+    result.greeks.vega = price.grad[1].value;
+    result.greeks.rho = price.grad[2].value;
+    result.greeks.theta = price.grad[3].value;   // Reported positive, as in the models
+    if (autodiff_detail::hasNodeGamma(model)) {
+        result.greeks.gamma = autodiff_detail::nodeGamma<Model>(params, modelArgs...);
+    }
+    return result;
+}
+
+// Same Greeks from one taped valuation of Model<Adjoint> and a single backward sweep. The
+// tape of the calling thread is cleared before and after.
+template<template<typename> class Model, typename... Args>
+PricingResult adjointModeGreeks(const OptionParameters& params, const Args&... modelArgs) {
+    AdjointTapeT<Dual>& tape = AdjointTapeT<Dual>::active();
+    tape.clear();
+
+    OptionParametersT<Adjoint> x = autodiff_detail::liftParameters<Adjoint>(params);
+    Dual spot(params.S);
+    spot.grad[0] = 1.0;
+    x.S = Adjoint::variable(spot);
+    x.sigma = Adjoint::variable(Dual(params.sigma));
+    x.r = Adjoint::variable(Dual(params.r));
+    x.expiry = Adjoint::variable(Dual(params.expiry));
+
+    Model<Adjoint> model(modelArgs...);
+    Adjoint price = autodiff_detail::modelPrice(model, x);
+
+    PricingResult result;
+    result.price = price.value.value;
+    if (price.index >= 0) {
+        std::vector<Dual> bar = tape.adjoints(price.index);
+        result.greeks.delta = bar[x.S.index].value;
+        result.greeks.gamma = bar[x.S.index].grad[0];
+        result.greeks.vega = bar[x.sigma.index].value;
+        result.greeks.rho = bar[x.r.index].value;
+        result.greeks.theta = bar[x.expiry.index].value;
+    }
+    tape.clear();
+    if (autodiff_detail::hasNodeGamma(model)) {
+        result.greeks.gamma = autodiff_detail::nodeGamma<Model>(params, modelArgs...);
+    }
+    return result;
+}
+
+#endif // AUTODIFF_H
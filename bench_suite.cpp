@@ -0,0 +1,603 @@
+// Micro-benchmark suite with machine-readable output. Each case times one operation on a
+// rotating set of inputs and reports throughput, cycles per option and latency percentiles
+// as JSON. --compare reads two such files and flags cases that got slower.
+
+#include "option_pricing.h"
+#include "greek_calculations.h"
+#include "math_utils.h"
+#include "vector_math.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define OPTION_PRICING_HAS_TSC 1
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const usage =
+    "usage: option_pricing_bench_suite [--filter TEXT] [--min-time SECONDS] [--output FILE]\n"
+    "       option_pricing_bench_suite --compare BASELINE CURRENT [--threshold FRACTION]\n"
+    "\n"
+    "Runs the cases whose name contains TEXT (all by default) and writes JSON to FILE or\n"
+    "stdout, with a summary table on stderr. --compare matches cases by name and flags a\n"
+    "regression when the median latency grew by more than FRACTION (default 0.10); the exit\n"
+    "status is 1 when any case regressed.\n";
+
+std::uint64_t readCycles() {
+#ifdef OPTION_PRICING_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Keeps results observable so the timed work is not optimized away
+volatile double sink;
+
+struct Measurement {
+    std::string name;
+    std::size_t operations = 0;
+    double nsPerOp = 0.0;
+    double cyclesPerOp = 0.0;   // Time-stamp counter ticks; zero without one
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;   // Nanoseconds per operation
+    std::map<std::string, double> extra;
+};
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    std::size_t index = std::size_t(fraction * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+class Suite {
+    std::string filter;
+    double minTime;
+    std::vector<Measurement> results;
+
+public:
+    Suite(std::string filter, double minTime) : filter(std::move(filter)), minTime(minTime) {}
+
+    const std::vector<Measurement>& measurements() const { return results; }
+
+    bool selected(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    // Times op(i) for i = 0, 1, 2, ... Each latency sample covers enough consecutive calls
+    // to last about a microsecond, so cheap operations are not swamped by timer overhead;
+    // samples are taken until minTime has passed.
+    template<typename F>
+    Measurement* measure(const std::string& name, F&& op) {
+        if (!selected(name)) {
+            return nullptr;
+        }
+
+        // Warm up, and estimate the cost per call
+        std::size_t calls = 1;
+        double estimate = 0.0;
+        for (;;) {
+            auto start = Clock::now();
+            for (std::size_t i = 0; i < calls; ++i) {
+                op(i);
+            }
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if (elapsed > 1e-3 || calls >= (std::size_t(1) << 24)) {
+                estimate = elapsed / double(calls);
+                break;
+            }
+            calls *= 4;
+        }
+        std::size_t perSample = std::max<std::size_t>(1, std::size_t(1e-6 / std::max(estimate, 1e-12)));
+
+        std::vector<double> samples;
+        std::size_t index = 0;
+        std::uint64_t cycles = 0;
+        double total = 0.0;
+        while (total < minTime || samples.size() < 20) {
+            auto start = Clock::now();
+            std::uint64_t startCycles = readCycles();
+            for (std::size_t i = 0; i < perSample; ++i) {
+                op(index++);
+            }
+            std::uint64_t endCycles = readCycles();
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            cycles += endCycles - startCycles;
+            total += elapsed;
+            samples.push_back(elapsed * 1e9 / double(perSample));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Measurement m;
+        m.name = name;
+        m.operations = index;
+        m.nsPerOp = total * 1e9 / double(index);
+        m.cyclesPerOp = double(cycles) / double(index);
+        m.p50 = percentile(samples, 0.50);
+        m.p90 = percentile(samples, 0.90);
+        m.p99 = percentile(samples, 0.99);
+        m.max = samples.back();
+        results.push_back(m);
+        std::fprintf(stderr, "  %-40s %12.1f ns %12.0f cycles   p50 %10.1f  p99 %10.1f ns\n", name.c_str(),
+                     m.nsPerOp, m.cyclesPerOp, m.p50, m.p99);
+        return &results.back();
+    }
+};
+
+// The normal CDF before the rational kernel (Abramowitz and Stegun 26.2.17), kept as the
+// baseline for the accuracy and throughput cases
+double abramowitzStegunNormalCDF(double x) {
+    if (x < -10.0) return 0.0;
+    if (x > 10.0) return 1.0;
+    if (x < 0.0) {
+        return 1.0 - abramowitzStegunNormalCDF(-x);
+    }
+    double t = 1.0 / (1.0 + 0.2316419 * x);
+    double poly = t * (0.319381530 + t * (-0.356563782 + t * (1.781477937 + t * (-1.821255978 + t * 1.330274429))));
+    return 1.0 - 0.39894228040143267794 * std::exp(-0.5 * x * x) * poly;
+}
+
+// Error of value in units in the last place of exact
+double ulpError(double value, long double exact) {
+    int exponent;
+    std::frexp(double(exact), &exponent);
+    double ulp = std::ldexp(1.0, std::max(exponent - 53, -1074));
+    return double(std::fabs(value - exact) / ulp);
+}
+
+// Largest ulp error of cdf against a long double erfc, in the lower tail (x < -5, where
+// most of the result's bits come from the exponential) and elsewhere. The reference is only
+// exact to double precision where long double is wider than double.
+template<typename F>
+void recordNormalCDFError(Measurement* measurement, F cdf) {
+    if (!measurement) {
+        return;
+    }
+    constexpr int samples = 200000;
+    const long double invSqrt2 = 0.707106781186547524400844362104849039L;
+    double tail = 0.0;
+    double body = 0.0;
+    for (int i = 0; i < samples; ++i) {
+        double x = -37.5 + 32.5 * (i + 0.5) / samples;
+        tail = std::max(tail, ulpError(cdf(x), 0.5L * std::erfc(-x * invSqrt2)));
+        x = -5.0 + 13.3 * (i + 0.5) / samples;
+        body = std::max(body, ulpError(cdf(x), 0.5L * std::erfc(-x * invSqrt2)));
+    }
+    measurement->extra["max_ulp_lower_tail"] = tail;
+    measurement->extra["max_ulp_elsewhere"] = body;
+}
+
+// Options spread over moneyness, volatility and expiry, half calls and half puts
+std::vector<OptionParameters> makeOptions(std::size_t n, OptionType type) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> moneyness(0.7, 1.3);
+    std::uniform_real_distribution<double> rate(0.0, 0.08);
+    std::uniform_real_distribution<double> yield(0.0, 0.04);
+    std::uniform_real_distribution<double> vol(0.1, 0.6);
+    std::uniform_real_distribution<double> years(0.05, 2.0);
+    std::vector<OptionParameters> options(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        options[i].S = 100.0;
+        options[i].K = 100.0 * moneyness(rng);
+        options[i].r = rate(rng);
+        options[i].q = yield(rng);
+        options[i].sigma = vol(rng);
+        options[i].expiry = years(rng);
+        options[i].type = type;
+        options[i].style = i % 2 ? OptionStyle::Put : OptionStyle::Call;
+    }
+    return options;
+}
+
+void runSuite(Suite& suite) {
+    constexpr std::size_t inputCount = 1024;   // Rotated through; small enough to stay in cache
+    std::vector<OptionParameters> european = makeOptions(inputCount, OptionType::European);
+    std::vector<OptionParameters> american = makeOptions(inputCount, OptionType::American);
+    // In shuffled order, as d1 and d2 arrive when pricing, so that kernels branching on the
+    // sign are not flattered by a predictable pattern
+    std::vector<double> points(inputCount);
+    for (std::size_t i = 0; i < inputCount; ++i) {
+        points[i] = -6.0 + 12.0 * double(i) / double(inputCount - 1);
+    }
+    std::shuffle(points.begin(), points.end(), std::mt19937_64(11));
+    auto at = [&](std::size_t i) { return i % inputCount; };
+
+    Measurement* cdf = suite.measure("math/normalCDF", [&](std::size_t i) { sink = normalCDF(points[at(i)]); });
+    recordNormalCDFError(cdf, [](double x) { return normalCDF(x); });
+    suite.measure("math/normalPDF", [&](std::size_t i) { sink = normalPDF(points[at(i)]); });
+    suite.measure("math/normalCDF_and_PDF", [&](std::size_t i) {
+        double pdf;
+        sink = normalCDF(points[at(i)], pdf) + pdf;
+    });
+    Measurement* legacy = suite.measure("math/normalCDF_abramowitz_stegun", [&](std::size_t i) {
+        sink = abramowitzStegunNormalCDF(points[at(i)]);
+    });
+    recordNormalCDFError(legacy, abramowitzStegunNormalCDF);
+    if (cdf && legacy) {
+        legacy->extra["time_vs_normalCDF"] = legacy->nsPerOp / cdf->nsPerOp;
+    }
+#if OPTION_PRICING_HAS_SIMD
+    // One op is a full lane group; cycles and latency are per group, not per value
+    Measurement* packed = suite.measure("math/packedNormalCDF", [&](std::size_t i) {
+        double out[PackedDouble::width];
+        packedStore(out, packedNormalCDF(packedLoad(&points[(i * PackedDouble::width) % inputCount])));
+        sink = out[0];
+    });
+    recordNormalCDFError(packed, [](double x) {
+        double out[PackedDouble::width];
+        packedStore(out, packedNormalCDF(packedSet(x)));
+        return out[0];
+    });
+    if (packed) {
+        packed->extra["values_per_op"] = PackedDouble::width;
+    }
+#endif
+
+    BlackScholesModel blackScholes;
+    const PricingModelBase& model = blackScholes;
+    suite.measure("blackscholes/calculate", [&](std::size_t i) { sink = model.calculate(european[at(i)]).price; });
+
+    Measurement* longDouble = suite.measure("greeks/calculateGreeksBS_long_double", [&](std::size_t i) {
+        sink = calculateGreeksBS(european[at(i)]).delta;
+    });
+    if (longDouble) {
+        // Largest relative difference from the model's own double-precision Greeks
+        double worst = 0.0;
+        for (const OptionParameters& params : european) {
+            Greeks reference = calculateGreeksBS(params);
+            Greeks own = blackScholes.calculate(params).greeks;
+            double pairs[][2] = {{reference.delta, own.delta}, {reference.gamma, own.gamma},
+                                 {reference.theta, own.theta}, {reference.vega, own.vega},
+                                 {reference.rho, own.rho}};
+            for (auto& pair : pairs) {
+                worst = std::max(worst, std::abs(pair[0] - pair[1]) / std::max(1e-12, std::abs(pair[0])));
+            }
+        }
+        longDouble->extra["max_rel_diff_vs_model"] = worst;
+    }
+
+    for (int steps : {50, 100, 200, 500, 1000, 2000}) {
+        BinomialModel binomial(steps);
+        std::string prefix = "binomial/" + std::to_string(steps) + "/";
+        suite.measure(prefix + "price", [&](std::size_t i) { sink = binomial.calculatePrice(american[at(i)]); });
+        suite.measure(prefix + "price_and_greeks", [&](std::size_t i) {
+            sink = binomial.calculate(american[at(i)]).greeks.theta;
+        });
+    }
+
+    // Finite-difference Greeks around each model, against the model's own Greeks
+    auto blackScholesPrice = [&](const OptionParameters& params) { return blackScholes.calculate(params).price; };
+    Measurement* fd = suite.measure("greeks_fd/blackscholes", [&](std::size_t i) {
+        sink = calculateGreeksFD(european[at(i)], blackScholesPrice).delta;
+    });
+    if (fd) {
+        fd->extra["pricings_per_option"] = finiteDiffScenarioCount;
+        for (const Measurement& m : suite.measurements()) {
+            if (m.name == "blackscholes/calculate") {
+                fd->extra["overhead_vs_analytic"] = fd->nsPerOp / m.nsPerOp;
+            }
+        }
+    }
+    BinomialModel binomial(200);
+    auto binomialPrice = [&](const OptionParameters& params) { return binomial.calculatePrice(params); };
+    fd = suite.measure("greeks_fd/binomial/200", [&](std::size_t i) {
+        sink = calculateGreeksFD(american[at(i)], binomialPrice).delta;
+    });
+    if (fd) {
+        for (const Measurement& m : suite.measurements()) {
+            if (m.name == "binomial/200/price_and_greeks") {
+                fd->extra["overhead_vs_tree_greeks"] = fd->nsPerOp / m.nsPerOp;
+            }
+        }
+    }
+}
+
+void writeNumber(std::FILE* out, double value) {
+    if (std::isfinite(value)) {
+        std::fprintf(out, "%.6g", value);
+    } else {
+        std::fputs("null", out);
+    }
+}
+
+void writeJson(std::FILE* out, const std::vector<Measurement>& measurements) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::fprintf(out, "{\n  \"schema\": 1,\n  \"context\": {\n");
+    std::fprintf(out, "    \"date\": \"%s\",\n", date);
+#ifdef __VERSION__
+    std::fprintf(out, "    \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+#ifdef NDEBUG
+    std::fprintf(out, "    \"assertions\": false,\n");
+#else
+    std::fprintf(out, "    \"assertions\": true,\n");
+#endif
+#ifdef OPTION_PRICING_HAS_TSC
+    std::fprintf(out, "    \"cycle_counter\": \"tsc\"\n  },\n");
+#else
+    std::fprintf(out, "    \"cycle_counter\": null\n  },\n");
+#endif
+    std::fprintf(out, "  \"benchmarks\": [");
+    for (std::size_t k = 0; k < measurements.size(); ++k) {
+        const Measurement& m = measurements[k];
+        std::fprintf(out, "%s\n    {\"name\": \"%s\", \"operations\": %zu, \"ns_per_op\": ", k ? "," : "",
+                     m.name.c_str(), m.operations);
+        writeNumber(out, m.nsPerOp);
+        std::fprintf(out, ", \"cycles_per_op\": ");
+#ifdef OPTION_PRICING_HAS_TSC
+        writeNumber(out, m.cyclesPerOp);
+#else
+        std::fputs("null", out);
+#endif
+        std::fprintf(out, ", \"ops_per_second\": ");
+        writeNumber(out, 1e9 / m.nsPerOp);
+        std::fprintf(out, ",\n     \"latency_ns\": {\"p50\": ");
+        writeNumber(out, m.p50);
+        std::fprintf(out, ", \"p90\": ");
+        writeNumber(out, m.p90);
+        std::fprintf(out, ", \"p99\": ");
+        writeNumber(out, m.p99);
+        std::fprintf(out, ", \"max\": ");
+        writeNumber(out, m.max);
+        std::fprintf(out, "}");
+        for (const auto& entry : m.extra) {
+            std::fprintf(out, ", \"%s\": ", entry.first.c_str());
+            writeNumber(out, entry.second);
+        }
+        std::fprintf(out, "}");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+// Just enough JSON to read files written by writeJson back: a benchmark's name mapped to
+// its numeric fields, with nested objects flattened to "outer.inner"
+class JsonReader {
+    const char* cursor;
+    const char* end;
+
+public:
+    JsonReader(const std::string& text) : cursor(text.data()), end(text.data() + text.size()) {}
+
+    std::map<std::string, std::map<std::string, double>> benchmarks() {
+        std::map<std::string, std::map<std::string, double>> found;
+        expect('{');
+        while (!consume('}')) {
+            std::string key = string();
+            expect(':');
+            if (key == "benchmarks") {
+                expect('[');
+                while (!consume(']')) {
+                    std::map<std::string, double> fields;
+                    std::string name;
+                    object("", fields, name);
+                    found[name] = fields;
+                    consume(',');
+                }
+            } else {
+                skip();
+            }
+            consume(',');
+        }
+        return found;
+    }
+
+private:
+    [[noreturn]] void fail() { throw std::runtime_error("malformed benchmark JSON"); }
+
+    void whitespace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) {
+            ++cursor;
+        }
+    }
+
+    bool consume(char c) {
+        whitespace();
+        if (cursor < end && *cursor == c) {
+            ++cursor;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail();
+        }
+    }
+
+    std::string string() {
+        expect('"');
+        std::string value;
+        while (cursor < end && *cursor != '"') {
+            if (*cursor == '\\' && cursor + 1 < end) {
+                ++cursor;
+            }
+            value += *cursor++;
+        }
+        expect('"');
+        return value;
+    }
+
+    void object(const std::string& prefix, std::map<std::string, double>& fields, std::string& name) {
+        expect('{');
+        while (!consume('}')) {
+            std::string key = string();
+            expect(':');
+            whitespace();
+            if (cursor < end && *cursor == '{') {
+                object(prefix + key + ".", fields, name);
+            } else if (cursor < end && *cursor == '"') {
+                std::string value = string();
+                if (prefix.empty() && key == "name") {
+                    name = value;
+                }
+            } else if (cursor < end && (*cursor == '-' || (*cursor >= '0' && *cursor <= '9'))) {
+                char* next = nullptr;
+                fields[prefix + key] = std::strtod(cursor, &next);
+                cursor = next;
+            } else {
+                skip();
+            }
+            consume(',');
+        }
+    }
+
+    // Skips one value of any kind
+    void skip() {
+        whitespace();
+        if (cursor >= end) {
+            fail();
+        }
+        if (*cursor == '"') {
+            string();
+        } else if (*cursor == '{' || *cursor == '[') {
+            char open = *cursor;
+            char close = open == '{' ? '}' : ']';
+            ++cursor;
+            while (!consume(close)) {
+                if (open == '{') {
+                    string();
+                    expect(':');
+                }
+                skip();
+                consume(',');
+            }
+        } else {
+            while (cursor < end && *cursor != ',' && *cursor != '}' && *cursor != ']') {
+                ++cursor;
+            }
+        }
+    }
+};
+
+std::map<std::string, std::map<std::string, double>> readBenchmarks(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    std::string text;
+    char block[4096];
+    std::size_t read;
+    while ((read = std::fread(block, 1, sizeof(block), file)) > 0) {
+        text.append(block, read);
+    }
+    std::fclose(file);
+    try {
+        return JsonReader(text).benchmarks();
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+// Median latency is compared rather than the mean, as it shrugs off stray interruptions
+int compare(const std::string& baselinePath, const std::string& currentPath, double threshold) {
+    auto baseline = readBenchmarks(baselinePath);
+    auto current = readBenchmarks(currentPath);
+    int regressions = 0;
+    std::printf("%-40s %12s %12s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+    for (const auto& entry : current) {
+        auto before = baseline.find(entry.first);
+        if (before == baseline.end()) {
+            std::printf("%-40s %12s %12.1f %9s  new\n", entry.first.c_str(), "-",
+                        entry.second.at("latency_ns.p50"), "");
+            continue;
+        }
+        double old = before->second.at("latency_ns.p50");
+        double now = entry.second.at("latency_ns.p50");
+        double change = now / old - 1.0;
+        const char* verdict = "";
+        if (change > threshold) {
+            verdict = "  REGRESSION";
+            ++regressions;
+        } else if (change < -threshold) {
+            verdict = "  improved";
+        }
+        std::printf("%-40s %12.1f %12.1f %+8.1f%%%s\n", entry.first.c_str(), old, now, change * 100.0, verdict);
+    }
+    for (const auto& entry : baseline) {
+        if (!current.count(entry.first)) {
+            std::printf("%-40s %12.1f %12s %9s  missing\n", entry.first.c_str(),
+                        entry.second.at("latency_ns.p50"), "-", "");
+        }
+    }
+    std::printf("%d regression%s beyond %.0f%%\n", regressions, regressions == 1 ? "" : "s", threshold * 100.0);
+    return regressions ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string output;
+    std::vector<std::string> comparePaths;
+    double minTime = 0.25;
+    double threshold = 0.10;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string argument = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error(argument + " expects a value");
+                }
+                return argv[++i];
+            };
+            if (argument == "--filter") {
+                filter = value();
+            } else if (argument == "--min-time") {
+                minTime = std::atof(value().c_str());
+            } else if (argument == "--output" || argument == "-o") {
+                output = value();
+            } else if (argument == "--compare") {
+                comparePaths.push_back(value());
+                comparePaths.push_back(value());
+            } else if (argument == "--threshold") {
+                threshold = std::atof(value().c_str());
+            } else {
+                std::fputs(usage, argument == "--help" || argument == "-h" ? stdout : stderr);
+                return argument == "--help" || argument == "-h" ? 0 : 2;
+            }
+        }
+
+        if (!comparePaths.empty()) {
+            return compare(comparePaths[0], comparePaths[1], threshold);
+        }
+
+        Suite suite(filter, minTime);
+        runSuite(suite);
+
+        std::FILE* out = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+        if (!out) {
+            throw std::runtime_error("cannot open " + output);
+        }
+        writeJson(out, suite.measurements());
+        if (out != stdout) {
+            std::fclose(out);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "option_pricing_bench_suite: %s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,1380 @@
+#include "option_pricing.h"
+#include "american_models.h"
+#include "static_pricing.h"
+#include "autodiff.h"
+#include "greek_calculations.h"
+#include "finite_difference.h"
+#include "monte_carlo.h"
+#include "columnar_file.h"
+#include "live_book.h"
+#include "chain_pricing.h"
+#include "strike_ladder.h"
+#include "result_cache.h"
+#include "scenario_grid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+double timeSeconds(F&& body) {
+    auto start = Clock::now();
+    body();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Random European chain in columnar layout
+struct ColumnarChain {
+    std::vector<double> S, K, r, q, sigma, expiry;
+    std::vector<OptionStyle> style;
+
+    explicit ColumnarChain(std::size_t n, unsigned seed = 42) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> moneyness(0.6, 1.4);
+        std::uniform_real_distribution<double> rate(0.0, 0.08);
+        std::uniform_real_distribution<double> yield(0.0, 0.04);
+        std::uniform_real_distribution<double> vol(0.05, 0.8);
+        std::uniform_real_distribution<double> years(0.02, 3.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            S.push_back(100.0);
+            K.push_back(100.0 * moneyness(rng));
+            r.push_back(rate(rng));
+            q.push_back(yield(rng));
+            sigma.push_back(vol(rng));
+            expiry.push_back(years(rng));
+            style.push_back(i % 2 ? OptionStyle::Put : OptionStyle::Call);
+        }
+    }
+
+    std::vector<OptionType> type;
+
+    OptionBatch view() const {
+        return {S.size(), S.data(), K.data(), r.data(), q.data(), sigma.data(), expiry.data(), style.data(),
+                type.empty() ? nullptr : type.data()};
+    }
+
+    OptionParameters row(std::size_t i) const {
+        OptionParameters params;
+        params.S = S[i];
+        params.K = K[i];
+        params.r = r[i];
+        params.q = q[i];
+        params.sigma = sigma[i];
+        params.expiry = expiry[i];
+        params.style = style[i];
+        params.type = type.empty() ? OptionType::European : type[i];
+        return params;
+    }
+};
+
+struct ColumnarResults {
+    std::vector<double> price, delta, gamma, theta, vega, rho;
+
+    explicit ColumnarResults(std::size_t n)
+        : price(n), delta(n), gamma(n), theta(n), vega(n), rho(n) {}
+
+    PricingResultBatch view() {
+        return {price.data(), delta.data(), gamma.data(), theta.data(), vega.data(), rho.data()};
+    }
+};
+
+void benchBlackScholesBatch(std::size_t n, int repeats) {
+    ColumnarChain chain(n);
+    ColumnarResults batchOut(n);
+    std::vector<PricingResult> loopOut(n);
+
+    BlackScholesModel bs;
+    const PricingModelBase& model = bs;
+
+    double loopTime = timeSeconds([&] {
+        for (int rep = 0; rep < repeats; ++rep) {
+            for (std::size_t i = 0; i < n; ++i) {
+                loopOut[i] = model.calculate(chain.row(i));
+            }
+        }
+    });
+
+    double batchTime = timeSeconds([&] {
+        for (int rep = 0; rep < repeats; ++rep) {
+            bs.calculateBatch(chain.view(), batchOut.view());
+        }
+    });
+
+    double maxPriceDiff = 0.0;
+    double maxGreekDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const PricingResult& ref = loopOut[i];
+        maxPriceDiff = std::max(maxPriceDiff, std::abs(batchOut.price[i] - ref.price));
+        for (double diff : {batchOut.delta[i] - ref.greeks.delta, batchOut.gamma[i] - ref.greeks.gamma,
+                            batchOut.theta[i] - ref.greeks.theta, batchOut.vega[i] - ref.greeks.vega,
+                            batchOut.rho[i] - ref.greeks.rho}) {
+            maxGreekDiff = std::max(maxGreekDiff, std::abs(diff));
+        }
+    }
+
+    double total = double(n) * repeats;
+    std::printf("Black-Scholes, %zu options x %d\n", n, repeats);
+    std::printf("  per-option loop : %10.2f Mopt/s\n", total / loopTime / 1e6);
+    std::printf("  columnar batch  : %10.2f Mopt/s  (%.1fx)\n", total / batchTime / 1e6, loopTime / batchTime);
+    std::printf("  max |diff| price %.3g, greeks %.3g\n", maxPriceDiff, maxGreekDiff);
+}
+
+// Prices the same American book from many threads through one shared model
+// and checks every thread reproduces the single-threaded results exactly.
+void benchSharedBinomialModel(std::size_t n, int threads) {
+    ColumnarChain chain(n, 7);
+    BinomialModel model(200);
+
+    std::vector<PricingResult> reference(n);
+    double serialTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            OptionParameters params = chain.row(i);
+            params.type = OptionType::American;
+            reference[i] = model.calculate(params);
+        }
+    });
+
+    std::vector<std::vector<PricingResult>> perThread(threads, std::vector<PricingResult>(n));
+    double parallelTime = timeSeconds([&] {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                // Each thread walks the book from a different offset to interleave calls
+                for (std::size_t k = 0; k < n; ++k) {
+                    std::size_t i = (k + t * 17) % n;
+                    OptionParameters params = chain.row(i);
+                    params.type = OptionType::American;
+                    perThread[t][i] = model.calculate(params);
+                }
+            });
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+    });
+
+    std::size_t mismatches = 0;
+    for (const auto& results : perThread) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (results[i].price != reference[i].price || results[i].greeks.delta != reference[i].greeks.delta ||
+                results[i].greeks.gamma != reference[i].greeks.gamma ||
+                results[i].greeks.theta != reference[i].greeks.theta ||
+                results[i].greeks.vega != reference[i].greeks.vega ||
+                results[i].greeks.rho != reference[i].greeks.rho) {
+                ++mismatches;
+            }
+        }
+    }
+
+    std::printf("Shared BinomialModel(200), %zu American options on %d threads\n", n, threads);
+    std::printf("  serial   : %10.0f opt/s\n", n / serialTime);
+    std::printf("  threaded : %10.0f opt/s\n", double(n) * threads / parallelTime);
+    std::printf("  mismatches vs serial: %zu\n", mismatches);
+}
+
+// Bump-and-reprice Greeks with six full trees, as BinomialModelT used to compute them
+PricingResult bumpAndRepriceGreeks(const BinomialModel& model, const OptionParameters& params) {
+    const double h = params.S * 0.0001;
+    const double dt = 1.0 / 365.0;
+    const double dvol = 0.0001;
+    const double dr = 0.0001;
+
+    PricingResult result;
+    result.price = model.calculatePrice(params);
+
+    OptionParameters up = params, down = params, theta = params, vega = params, rho = params;
+    up.S += h;
+    down.S -= h;
+    theta.expiry -= dt;
+    vega.sigma += dvol;
+    rho.r += dr;
+
+    double priceUp = model.calculatePrice(up);
+    double priceDown = model.calculatePrice(down);
+    result.greeks.delta = (priceUp - priceDown) / (2.0 * h);
+    result.greeks.gamma = (priceUp - 2.0 * result.price + priceDown) / (h * h);
+    result.greeks.theta = -(model.calculatePrice(theta) - result.price) / dt;
+    result.greeks.vega = (model.calculatePrice(vega) - result.price) / dvol;
+    result.greeks.rho = (model.calculatePrice(rho) - result.price) / dr;
+    return result;
+}
+
+void benchBinomialGreeks(std::size_t n, int steps) {
+    ColumnarChain chain(n, 11);
+    BinomialModel model(steps);
+    std::vector<OptionParameters> book(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        book[i] = chain.row(i);
+        book[i].type = OptionType::American;
+    }
+
+    double sink = 0.0;
+    double priceTime = timeSeconds([&] {
+        for (const auto& params : book) {
+            sink += model.calculatePrice(params);
+        }
+    });
+    // Vega and rho each need a full bumped lattice, so tree Greeks cost about 3x the price
+    double treeTime = timeSeconds([&] {
+        for (const auto& params : book) {
+            sink += model.calculate(params).price;
+        }
+    });
+    double bumpTime = timeSeconds([&] {
+        for (const auto& params : book) {
+            sink += bumpAndRepriceGreeks(model, params).price;
+        }
+    });
+
+    // European options have closed-form Greeks to compare the tree estimates against
+    BlackScholesModel bs;
+    double maxDelta = 0.0, maxGamma = 0.0, maxTheta = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        OptionParameters params = chain.row(i);
+        PricingResult tree = model.calculate(params);
+        PricingResult exact = bs.calculate(params);
+        maxDelta = std::max(maxDelta, std::abs(tree.greeks.delta - exact.greeks.delta));
+        maxGamma = std::max(maxGamma, std::abs(tree.greeks.gamma - exact.greeks.gamma));
+        maxTheta = std::max(maxTheta, std::abs(tree.greeks.theta - exact.greeks.theta));
+    }
+
+    std::printf("BinomialModel(%d) American Greeks, %zu options (checksum %.6g)\n", steps, n, sink);
+    std::printf("  price only        : %8.3f ms/opt\n", priceTime / n * 1e3);
+    std::printf("  tree Greeks       : %8.3f ms/opt  (%.2fx price)\n", treeTime / n * 1e3, treeTime / priceTime);
+    std::printf("  bump-and-reprice  : %8.3f ms/opt  (%.2fx price)\n", bumpTime / n * 1e3, bumpTime / priceTime);
+    std::printf("  European max |err| vs closed form: delta %.2g, gamma %.2g, theta %.2g\n",
+                maxDelta, maxGamma, maxTheta);
+}
+
+// The original lattice kernel, with std::pow for every node at every step
+double legacyBinomialPrice(const OptionParameters& params, int steps) {
+    std::vector<double> priceTree(steps + 1);
+    double dt = params.expiry / steps;
+    double u = std::exp(params.sigma * std::sqrt(dt));
+    double d = 1.0 / u;
+    double p = (std::exp((params.r - params.q) * dt) - d) / (u - d);
+    double discount = std::exp(-params.r * dt);
+    bool american = params.type == OptionType::American &&
+                    !(params.style == OptionStyle::Call && params.q == 0.0);
+
+    for (int i = 0; i <= steps; ++i) {
+        double St = params.S * std::pow(u, double(steps - i)) * std::pow(d, double(i));
+        priceTree[i] = params.style == OptionStyle::Call ? std::max(0.0, St - params.K)
+                                                         : std::max(0.0, params.K - St);
+    }
+    for (int step = steps - 1; step >= 0; --step) {
+        for (int i = 0; i <= step; ++i) {
+            double St = params.S * std::pow(u, double(step - i)) * std::pow(d, double(i));
+            double continuation = discount * (p * priceTree[i] + (1.0 - p) * priceTree[i + 1]);
+            if (american) {
+                double intrinsic = params.style == OptionStyle::Call ? std::max(0.0, St - params.K)
+                                                                     : std::max(0.0, params.K - St);
+                priceTree[i] = std::max(continuation, intrinsic);
+            } else {
+                priceTree[i] = continuation;
+            }
+        }
+    }
+    return priceTree[0];
+}
+
+// Runs body repeatedly until at least minSeconds have elapsed and returns seconds per call
+template<typename F>
+double secondsPerCall(F&& body, double minSeconds = 0.2) {
+    int calls = 0;
+    double elapsed = 0.0;
+    auto start = Clock::now();
+    do {
+        body();
+        ++calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed / calls;
+}
+
+void benchLatticeKernel() {
+    OptionParameters params;
+    params.S = 100.0;
+    params.K = 105.0;
+    params.r = 0.05;
+    params.q = 0.02;
+    params.sigma = 0.25;
+    params.expiry = 1.0;
+    params.type = OptionType::American;
+    params.style = OptionStyle::Put;
+
+    std::printf("Lattice kernel, American put, price only\n");
+    std::printf("  %6s %12s %12s %8s %10s\n", "steps", "pow (ms)", "table (ms)", "speedup", "|diff|");
+    for (int steps : {100, 500, 1000, 2000, 5000, 10000}) {
+        BinomialModel model(steps);
+        double legacy = 0.0;
+        double current = 0.0;
+        double legacyTime = secondsPerCall([&] { legacy = legacyBinomialPrice(params, steps); });
+        double currentTime = secondsPerCall([&] { current = model.calculatePrice(params); });
+        std::printf("  %6d %12.3f %12.3f %7.1fx %10.2g\n", steps, legacyTime * 1e3, currentTime * 1e3,
+                    legacyTime / currentTime, std::abs(legacy - current));
+    }
+}
+
+void benchBinomialBatch(std::size_t n, int steps) {
+    ColumnarChain chain(n, 23);
+    chain.type.assign(n, OptionType::American);
+    BinomialModel model(steps);
+
+    std::vector<PricingResult> scalar(n);
+    std::vector<double> scalarPrice(n);
+    ColumnarResults priced(n);
+    ColumnarResults greeks(n);
+
+    double scalarPriceTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            scalarPrice[i] = model.calculatePrice(chain.row(i));
+        }
+    });
+    double batchPriceTime = timeSeconds([&] {
+        PricingResultBatch out{priced.price.data()};
+        model.calculateBatch(chain.view(), out);
+    });
+    double scalarGreeksTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            scalar[i] = model.calculate(chain.row(i));
+        }
+    });
+    double batchGreeksTime = timeSeconds([&] {
+        model.calculateBatch(chain.view(), greeks.view());
+    });
+
+    // A partial set of Greek columns, which get the same values as a full set
+    ColumnarResults deltaOnly(n);
+    model.calculateBatch(chain.view(), PricingResultBatch{deltaOnly.price.data(), deltaOnly.delta.data()});
+
+    double maxDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        maxDiff = std::max({maxDiff, std::abs(priced.price[i] - scalarPrice[i]),
+                            std::abs(deltaOnly.delta[i] - scalar[i].greeks.delta),
+                            std::abs(greeks.price[i] - scalar[i].price),
+                            std::abs(greeks.delta[i] - scalar[i].greeks.delta),
+                            std::abs(greeks.vega[i] - scalar[i].greeks.vega)});
+    }
+
+    // calculateBatch runs the single-option tree row by row, so this measures only the
+    // per-call overhead it saves
+    std::printf("BinomialModel(%d) calculateBatch row loop, %zu American options\n", steps, n);
+    std::printf("  price  per call      : %10.0f opt/s\n", n / scalarPriceTime);
+    std::printf("  price  calculateBatch: %10.0f opt/s  (%.2fx)\n", n / batchPriceTime,
+                scalarPriceTime / batchPriceTime);
+    std::printf("  greeks per call      : %10.0f opt/s\n", n / scalarGreeksTime);
+    std::printf("  greeks calculateBatch: %10.0f opt/s  (%.2fx)\n", n / batchGreeksTime,
+                scalarGreeksTime / batchGreeksTime);
+    std::printf("  max |diff| vs scalar: %.3g\n", maxDiff);
+}
+
+void benchAmericanApproximations(std::size_t n) {
+    ColumnarChain chain(n, 31);
+    BinomialModel reference(10000);
+    std::vector<double> exact(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        OptionParameters params = chain.row(i);
+        params.type = OptionType::American;
+        exact[i] = reference.calculatePrice(params);
+    }
+
+    auto report = [&](const char* name, auto&& price) {
+        std::vector<double> values(n);
+        double seconds = timeSeconds([&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                OptionParameters params = chain.row(i);
+                params.type = OptionType::American;
+                values[i] = price(params);
+            }
+        });
+        double maxError = 0.0;
+        double sumError = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double error = std::abs(values[i] - exact[i]);
+            maxError = std::max(maxError, error);
+            sumError += error;
+        }
+        std::printf("  %-22s %12.0f opt/s  mean |err| %9.2e  max |err| %9.2e\n",
+                    name, n / seconds, sumError / n, maxError);
+    };
+
+    BaroneAdesiWhaleyModel baw;
+    BjerksundStenslandModel bs2002;
+    AndersenLakeOffengeltModel aloFast(AloAccuracy::Fast);
+    AndersenLakeOffengeltModel aloAccurate(AloAccuracy::Accurate);
+    AndersenLakeOffengeltModel aloHigh(AloAccuracy::HighPrecision);
+    BinomialModel tree(500);
+
+    std::printf("American approximations, %zu options, error vs BinomialModel(10000)\n", n);
+    report("Barone-Adesi-Whaley", [&](const OptionParameters& p) { return baw.calculatePrice(p); });
+    report("Bjerksund-Stensland", [&](const OptionParameters& p) { return bs2002.calculatePrice(p); });
+    report("ALO fast", [&](const OptionParameters& p) { return aloFast.calculatePrice(p); });
+    report("ALO accurate", [&](const OptionParameters& p) { return aloAccurate.calculatePrice(p); });
+    report("ALO high precision", [&](const OptionParameters& p) { return aloHigh.calculatePrice(p); });
+    report("BinomialModel(500)", [&](const OptionParameters& p) { return tree.calculatePrice(p); });
+}
+
+// Mixed book: mostly Black-Scholes Europeans with a minority of 500-step American trees,
+// so nearly all of the work sits in a few percent of the options
+void benchPortfolioScaling(std::size_t n) {
+    ColumnarChain chain(n, 57);
+    std::vector<OptionParameters> book(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        book[i] = chain.row(i);
+        book[i].type = i % 10 == 3 ? OptionType::American : OptionType::European;
+    }
+
+    PricingEngine engine(AmericanModel::Binomial, 500);
+    std::vector<PricingResult> serial(n);
+    double serialTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            serial[i] = engine.price(book[i]);
+        }
+    });
+
+    std::printf("PricingEngine::priceBatch, %zu options (10%% American, 500 steps), %u hardware threads\n",
+                n, std::thread::hardware_concurrency());
+    std::printf("  %7s %12s %9s %11s\n", "workers", "opt/s", "speedup", "mismatches");
+    std::printf("  %7s %12.0f %8.2fx %11s\n", "serial", n / serialTime, 1.0, "-");
+    std::vector<PricingResult> results(n);
+    for (std::size_t workers : {1, 2, 4, 8, 16, 32, 64}) {
+        engine.setWorkerCount(workers);
+        double seconds = timeSeconds([&] { engine.priceBatch(book, results.data()); });
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (results[i].price != serial[i].price || results[i].greeks.delta != serial[i].greeks.delta) {
+                ++mismatches;
+            }
+        }
+        std::printf("  %7zu %12.0f %8.2fx %11zu\n", workers, n / seconds, serialTime / seconds, mismatches);
+    }
+}
+
+// Per-call cost of the virtual PricingEngine against StaticPricingEngine on the same book
+void benchStaticDispatch(std::size_t n, int repeats) {
+    ColumnarChain chain(n, 61);
+    std::vector<OptionParameters> book(n);
+    std::vector<OptionParameters> puts;
+    for (std::size_t i = 0; i < n; ++i) {
+        book[i] = chain.row(i);
+        if (book[i].style == OptionStyle::Put) {
+            puts.push_back(book[i]);
+        }
+    }
+    std::vector<PricingResult> results(n);
+    double sink = 0.0;
+
+    // Best of several runs, since the differences are a few ns against ~80 ns of valuation.
+    // Each line after the first of a section is also given relative to that first line.
+    double baseline = 0.0;
+    auto report = [&](const char* name, std::size_t count, int times, auto&& body) {
+        double best = 0.0;
+        for (int run = 0; run < 5; ++run) {
+            double seconds = timeSeconds([&] {
+                for (int k = 0; k < times; ++k) {
+                    body();
+                }
+            });
+            best = run == 0 ? seconds : std::min(best, seconds);
+        }
+        double perOption = best * 1e9 / (double(count) * times);
+        if (baseline == 0.0) {
+            baseline = perOption;
+            std::printf("  %-34s %8.1f ns/option\n", name, perOption);
+        } else {
+            std::printf("  %-34s %8.1f ns/option  (%.2fx)\n", name, perOption, perOption / baseline);
+        }
+    };
+
+    std::printf("Static dispatch, Black-Scholes, %zu options x %d\n", n, repeats);
+    PricingEngine virtualEngine(std::make_shared<BlackScholesModel>());
+    StaticPricingEngine<BlackScholesKernel> staticEngine;
+    report("virtual PricingEngine::price", n, repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            results[i] = virtualEngine.price(book[i]);
+        }
+    });
+    report("static price (runtime kind)", n, repeats, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            results[i] = staticEngine.price(book[i]);
+        }
+    });
+    report("static priceBatch (mixed book)", n, repeats, [&] {
+        staticEngine.priceBatch(book.data(), n, results.data());
+    });
+    report("static priceBatch<Put, European>", puts.size(), repeats, [&] {
+        staticEngine.priceBatch<OptionStyle::Put, OptionType::European>(puts.data(), puts.size(), results.data());
+    });
+    sink += results[0].price;
+
+    const int steps = 100;
+    std::size_t treeCount = std::min<std::size_t>(n, 2000);
+    std::printf("Static dispatch, binomial(%d), %zu options\n", steps, treeCount);
+    PricingEngine virtualTree(std::make_shared<BinomialModel>(steps));
+    StaticPricingEngine<BinomialKernel> staticTree(BinomialKernel{steps});
+    for (OptionType type : {OptionType::European, OptionType::American}) {
+        std::vector<OptionParameters> trees(book.begin(), book.begin() + treeCount);
+        for (auto& params : trees) {
+            params.type = type;
+        }
+        bool european = type == OptionType::European;
+        double maxDiff = 0.0;
+        std::vector<PricingResult> reference(treeCount);
+        baseline = 0.0;
+        report(european ? "virtual, European" : "virtual, American", treeCount, 1, [&] {
+            for (std::size_t i = 0; i < treeCount; ++i) {
+                reference[i] = virtualTree.price(trees[i]);
+            }
+        });
+        report(european ? "static priceBatch, European" : "static priceBatch, American", treeCount, 1, [&] {
+            staticTree.priceBatch(trees.data(), treeCount, results.data());
+        });
+        for (std::size_t i = 0; i < treeCount; ++i) {
+            maxDiff = std::max(maxDiff, std::abs(results[i].price - reference[i].price));
+        }
+        std::printf("  max |diff| %.3g\n", maxDiff);
+    }
+    if (sink == 0.0) {
+        std::printf("\n");
+    }
+}
+
+// Inverts model prices back to volatility. Rows with vega below 1e-6 are left out of the
+// error figures: their volatility is not identifiable in double precision.
+void benchImpliedVolatility(std::size_t n, std::size_t americanCount) {
+    ColumnarChain chain(n, 67);
+    ColumnarResults quotes(n);
+    BlackScholesModel model;
+    model.calculateBatch(chain.view(), quotes.view());
+
+    std::vector<double> scalarVols(n);
+    std::vector<double> batchVols(n);
+    double scalarTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                scalarVols[i] = model.impliedVolatility(chain.row(i), quotes.price[i]);
+            } catch (const OptionPricingError&) {
+                scalarVols[i] = std::nan("");
+            }
+        }
+    });
+    double batchTime = timeSeconds([&] {
+        model.impliedVolatilityBatch(chain.view(), quotes.price.data(), batchVols.data());
+    });
+
+    std::size_t rejected = 0;
+    double maxScalarError = 0.0;
+    double maxBatchError = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::isnan(batchVols[i])) {
+            ++rejected;
+        }
+        if (quotes.vega[i] < 1e-6) {
+            continue;
+        }
+        maxScalarError = std::max(maxScalarError, std::abs(scalarVols[i] - chain.sigma[i]));
+        maxBatchError = std::max(maxBatchError, std::abs(batchVols[i] - chain.sigma[i]));
+    }
+
+    std::printf("Implied volatility, %zu European quotes\n", n);
+    std::printf("  scalar : %10.2f Mopt/s  max |vol err| %.3g\n", n / scalarTime / 1e6, maxScalarError);
+    std::printf("  batch  : %10.2f Mopt/s  max |vol err| %.3g  (%.1fx)\n", n / batchTime / 1e6, maxBatchError,
+                scalarTime / batchTime);
+    std::printf("  quotes outside no-arbitrage bounds: %zu\n", rejected);
+
+    BinomialModel tree(500);
+    double maxAmericanError = 0.0;
+    std::size_t identifiable = 0;
+    double americanTime = 0.0;
+    for (std::size_t i = 0; i < americanCount; ++i) {
+        OptionParameters params = chain.row(i);
+        params.type = OptionType::American;
+        PricingResult quote = tree.calculate(params);
+        if (quote.greeks.vega < 1e-6) {
+            continue;
+        }
+        double vol = 0.0;
+        americanTime += timeSeconds([&] { vol = tree.impliedVolatility(params, quote.price); });
+        maxAmericanError = std::max(maxAmericanError, std::abs(vol - params.sigma));
+        ++identifiable;
+    }
+    std::printf("  American, BinomialModel(500): %8.0f opt/s  max |vol err| %.3g\n",
+                identifiable / americanTime, maxAmericanError);
+}
+
+// Greeks from one forward-mode or adjoint valuation against the existing schemes
+void benchAutodiffGreeks(std::size_t n, int steps) {
+    ColumnarChain chain(n, 71);
+    std::vector<OptionParameters> book(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        book[i] = chain.row(i);
+    }
+
+    auto run = [&](const char* name, auto&& greeks, std::vector<PricingResult>& out) {
+        double seconds = timeSeconds([&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = greeks(book[i]);
+            }
+        });
+        std::printf("  %-22s %10.2f us/opt\n", name, seconds * 1e6 / n);
+    };
+    auto maxDiff = [&](const std::vector<PricingResult>& a, const std::vector<PricingResult>& b) {
+        double diff = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            diff = std::max({diff, std::abs(a[i].greeks.delta - b[i].greeks.delta),
+                             std::abs(a[i].greeks.vega - b[i].greeks.vega) / 100.0,
+                             std::abs(a[i].greeks.rho - b[i].greeks.rho) / 100.0});
+        }
+        return diff;
+    };
+
+    std::vector<PricingResult> reference(n), forward(n), adjoint(n), bumped(n);
+
+    std::printf("Automatic differentiation Greeks, Black-Scholes, %zu options\n", n);
+    BlackScholesModel blackScholes;
+    run("analytic", [&](const OptionParameters& p) { return blackScholes.calculate(p); }, reference);
+    run("forward (HyperDual)", [&](const OptionParameters& p) { return forwardModeGreeks<BlackScholesModelT>(p); },
+        forward);
+    run("adjoint (tape)", [&](const OptionParameters& p) { return adjointModeGreeks<BlackScholesModelT>(p); },
+        adjoint);
+    std::printf("  max |diff| vs analytic: forward %.3g, adjoint %.3g (delta; vega, rho per 1%%)\n",
+                maxDiff(forward, reference), maxDiff(adjoint, reference));
+
+    for (auto& params : book) {
+        params.type = OptionType::American;
+    }
+    std::printf("Automatic differentiation Greeks, BinomialModel(%d) American, %zu options\n", steps, n);
+    BinomialModel tree(steps);
+    run("lattice nodes", [&](const OptionParameters& p) { return tree.calculate(p); }, reference);
+    run("bump-and-reprice", [&](const OptionParameters& p) { return bumpAndRepriceGreeks(tree, p); }, bumped);
+    run("forward (HyperDual)", [&](const OptionParameters& p) { return forwardModeGreeks<BinomialModelT>(p, steps); },
+        forward);
+    run("adjoint (tape)", [&](const OptionParameters& p) { return adjointModeGreeks<BinomialModelT>(p, steps); },
+        adjoint);
+    std::printf("  max |diff| vs bump-and-reprice: forward %.3g, adjoint %.3g, lattice %.3g\n",
+                maxDiff(forward, bumped), maxDiff(adjoint, bumped), maxDiff(reference, bumped));
+    double gammaDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        gammaDiff = std::max({gammaDiff, std::abs(forward[i].greeks.gamma - reference[i].greeks.gamma),
+                              std::abs(adjoint[i].greeks.gamma - reference[i].greeks.gamma)});
+    }
+    std::printf("  max |gamma diff| vs lattice nodes: %.3g\n", gammaDiff);
+}
+
+// calculateGreeksFD as it was, repricing the base scenario inside every difference
+Greeks legacyGreeksFD(const OptionParameters& params,
+                      const std::function<double(const OptionParameters&)>& pricingFunction) {
+    Greeks greeks;
+    const double h = params.S * 0.0001;
+    const double dt = 1.0 / 365.0;
+    const double dvol = 0.0001;
+    const double dr = 0.0001;
+
+    auto forward = [&](double step, auto modify) {
+        OptionParameters up = params;
+        modify(up, step);
+        return (pricingFunction(up) - pricingFunction(params)) / step;
+    };
+    auto central = [&](double step, auto modify) {
+        OptionParameters up = params, down = params;
+        modify(up, step);
+        modify(down, -step);
+        return (pricingFunction(up) - pricingFunction(down)) / (2.0 * step);
+    };
+    auto spot = [](OptionParameters& p, double step) { p.S += step; };
+
+    pricingFunction(params);
+    greeks.delta = central(h, spot);
+    greeks.gamma = (forward(h, spot) - forward(-h, spot)) / (2.0 * h);
+    greeks.theta = -forward(-dt, [](OptionParameters& p, double step) { p.expiry += step; });
+    greeks.vega = forward(dvol, [](OptionParameters& p, double step) { p.sigma += step; });
+    greeks.rho = forward(dr, [](OptionParameters& p, double step) { p.r += step; });
+    return greeks;
+}
+
+void benchFiniteDiffGreeks(std::size_t n, int steps) {
+    ColumnarChain chain(n, 73);
+    chain.type.assign(n, OptionType::American);
+    std::vector<OptionParameters> book(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        book[i] = chain.row(i);
+    }
+    BinomialModel model(steps);
+
+    std::size_t calls = 0;
+    std::function<double(const OptionParameters&)> counted = [&](const OptionParameters& p) {
+        ++calls;
+        return model.calculatePrice(p);
+    };
+
+    std::vector<Greeks> legacy(n), scalar(n), batched(n);
+    double legacyTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            legacy[i] = legacyGreeksFD(book[i], counted);
+        }
+    });
+    std::size_t legacyCalls = calls;
+
+    calls = 0;
+    double scalarTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            scalar[i] = calculateGreeksFD(book[i], counted);
+        }
+    });
+    std::size_t scalarCalls = calls;
+
+    std::size_t batchCalls = 0;
+    std::size_t batchRows = 0;
+    double batchTime = timeSeconds([&] {
+        calculateGreeksFDBatch(book.data(), n, batched.data(), [&](const OptionBatch& scenarios, double* prices) {
+            ++batchCalls;
+            batchRows += scenarios.size;
+            PricingResultBatch out{prices};
+            model.calculateBatch(scenarios, out);
+        });
+    });
+
+    double maxDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        maxDiff = std::max({maxDiff, std::abs(batched[i].delta - scalar[i].delta),
+                            std::abs(batched[i].vega - scalar[i].vega), std::abs(batched[i].rho - scalar[i].rho),
+                            std::abs(legacy[i].delta - scalar[i].delta), std::abs(legacy[i].vega - scalar[i].vega)});
+    }
+
+    std::printf("Finite-difference Greeks around BinomialModel(%d), %zu American options\n", steps, n);
+    std::printf("  legacy   : %8.3f ms/opt  %5.1f pricings/opt\n", legacyTime * 1e3 / n, double(legacyCalls) / n);
+    std::printf("  scenarios: %8.3f ms/opt  %5.1f pricings/opt\n", scalarTime * 1e3 / n, double(scalarCalls) / n);
+    std::printf("  batch    : %8.3f ms/opt  %5.1f scenarios/opt in %zu callback\n", batchTime * 1e3 / n,
+                double(batchRows) / n, batchCalls);
+    std::printf("  max |diff| delta/vega/rho: %.3g\n", maxDiff);
+}
+
+// Accuracy against time for the Crank-Nicolson grid and the tree on American options, then
+// a strike ladder priced from one grid solve versus one valuation per strike
+void benchFiniteDifference(std::size_t n, std::size_t strikes) {
+    ColumnarChain chain(n, 89);
+    chain.type.assign(n, OptionType::American);
+    BinomialModel reference(10000);
+    std::vector<double> exact(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        exact[i] = reference.calculatePrice(chain.row(i));
+    }
+
+    auto report = [&](const char* name, int a, int b, auto&& price) {
+        std::vector<double> values(n);
+        double seconds = timeSeconds([&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                values[i] = price(chain.row(i));
+            }
+        });
+        double maxError = 0.0;
+        double sumError = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double error = std::abs(values[i] - exact[i]);
+            maxError = std::max(maxError, error);
+            sumError += error;
+        }
+        char label[64];
+        std::snprintf(label, sizeof label, name, a, b);
+        std::printf("  %-26s %9.1f us/opt  mean |err| %9.2e  max |err| %9.2e\n",
+                    label, seconds * 1e6 / n, sumError / n, maxError);
+    };
+
+    std::printf("American prices, %zu options, error vs BinomialModel(10000)\n", n);
+    for (int steps : {100, 250, 500, 1000}) {
+        BinomialModel tree(steps);
+        report("BinomialModel(%d)", steps, 0, [&](const OptionParameters& p) { return tree.calculatePrice(p); });
+    }
+    for (int space : {100, 200, 400, 800}) {
+        CrankNicolsonModel grid(space, space / 2);
+        report("CrankNicolsonModel(%d, %d)", space, space / 2,
+               [&](const OptionParameters& p) { return grid.calculatePrice(p); });
+    }
+
+    OptionParameters params = chain.row(0);
+    params.style = OptionStyle::Put;
+    std::vector<double> ladder(strikes);
+    for (std::size_t j = 0; j < strikes; ++j) {
+        ladder[j] = 70.0 + 60.0 * double(j) / double(strikes - 1);
+    }
+
+    CrankNicolsonModel grid(400, 200);
+    BinomialModel tree(500);
+    std::vector<PricingResult> fromLadder(strikes), perStrike(strikes), fromTree(strikes);
+    double ladderTime = timeSeconds([&] { grid.calculateStrikes(params, ladder.data(), strikes, fromLadder.data()); });
+    double perStrikeTime = timeSeconds([&] {
+        for (std::size_t j = 0; j < strikes; ++j) {
+            OptionParameters p = params;
+            p.K = ladder[j];
+            perStrike[j] = grid.calculate(p);
+        }
+    });
+    double treeTime = timeSeconds([&] {
+        for (std::size_t j = 0; j < strikes; ++j) {
+            OptionParameters p = params;
+            p.K = ladder[j];
+            fromTree[j] = tree.calculate(p);
+        }
+    });
+
+    double priceDiff = 0.0, deltaDiff = 0.0, gammaDiff = 0.0, vegaDiff = 0.0;
+    for (std::size_t j = 0; j < strikes; ++j) {
+        priceDiff = std::max(priceDiff, std::abs(fromLadder[j].price - fromTree[j].price));
+        deltaDiff = std::max(deltaDiff, std::abs(fromLadder[j].greeks.delta - fromTree[j].greeks.delta));
+        gammaDiff = std::max(gammaDiff, std::abs(fromLadder[j].greeks.gamma - fromTree[j].greeks.gamma));
+        vegaDiff = std::max(vegaDiff, std::abs(fromLadder[j].greeks.vega - fromTree[j].greeks.vega));
+    }
+
+    std::printf("American put ladder, %zu strikes, price and Greeks\n", strikes);
+    std::printf("  CrankNicolsonModel(400, 200) ladder    : %8.2f ms\n", ladderTime * 1e3);
+    std::printf("  CrankNicolsonModel(400, 200) per strike: %8.2f ms\n", perStrikeTime * 1e3);
+    std::printf("  BinomialModel(500) per strike          : %8.2f ms\n", treeTime * 1e3);
+    std::printf("  max |ladder - tree| price %.2e delta %.2e gamma %.2e vega %.2e\n",
+                priceDiff, deltaDiff, gammaDiff, vegaDiff);
+}
+
+// Variance reduction, cost and reproducibility of the Monte Carlo engine, checked against
+// Black-Scholes for European options and a 10000-step tree for American ones
+void benchMonteCarlo() {
+    OptionParameters params;
+    params.S = 100.0;
+    params.K = 105.0;
+    params.r = 0.05;
+    params.q = 0.01;
+    params.sigma = 0.3;
+    params.expiry = 1.0;
+    params.style = OptionStyle::Put;
+
+    std::printf("Monte Carlo, 1y put S=100 K=105, %zu paths\n", MonteCarloSettings().paths);
+    for (OptionType type : {OptionType::European, OptionType::American}) {
+        params.type = type;
+        double exact = type == OptionType::European ? BlackScholesModel().calculate(params).price
+                                                    : BinomialModel(10000).calculatePrice(params);
+        std::printf("  %s, reference %.4f\n", type == OptionType::European ? "European" : "American", exact);
+        for (int variant = 0; variant < 4; ++variant) {
+            MonteCarloSettings settings;
+            settings.antithetic = variant & 1;
+            settings.controlVariate = variant & 2;
+            MonteCarloModel model(settings);
+            MonteCarloResult estimate;
+            double seconds = timeSeconds([&] { estimate = model.simulate(params); });
+            std::printf("    antithetic %d control %d: %8.4f  se %.4f  error %+.4f  %7.1f ms\n",
+                        int(settings.antithetic), int(settings.controlVariate), estimate.result.price,
+                        estimate.standardError, estimate.result.price - exact, seconds * 1e3);
+        }
+    }
+
+    MonteCarloModel model;
+    double first = 0.0;
+    bool identical = true;
+    for (unsigned workers : {1u, 2u, 4u}) {
+        model.setWorkerCount(workers);
+        MonteCarloResult estimate;
+        double seconds = timeSeconds([&] { estimate = model.simulate(params); });
+        if (workers == 1) {
+            first = estimate.result.price;
+        }
+        identical = identical && estimate.result.price == first;
+        std::printf("  American, %2u workers: %.12f  %7.1f ms\n", workers, estimate.result.price, seconds * 1e3);
+    }
+    std::printf("  bitwise identical across worker counts: %s\n", identical ? "yes" : "no");
+}
+
+// Load-plus-price time of a European chain read from CSV text against the same chain
+// mapped from a columnar positions file
+void benchColumnarFile(std::size_t n) {
+    ColumnarChain chain(n);
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string textPath = (directory / "option_pricing_bench.csv").string();
+    std::string columnarPath = (directory / "option_pricing_bench.opc").string();
+
+    std::FILE* text = std::fopen(textPath.c_str(), "w");
+    for (std::size_t i = 0; i < n; ++i) {
+        std::fprintf(text, "%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,European,%s\n", chain.S[i], chain.K[i], chain.r[i],
+                     chain.sigma[i], chain.expiry[i], chain.q[i], chain.style[i] == OptionStyle::Put ? "Put" : "Call");
+    }
+    std::fclose(text);
+    writePositionsFile(columnarPath, chain.view());
+
+    ColumnarResults textOut(n);
+    ColumnarResults columnarOut(n);
+
+    ColumnarChain parsed(0);
+    double textLoad = timeSeconds([&] {
+        std::FILE* file = std::fopen(textPath.c_str(), "rb");
+        std::fseek(file, 0, SEEK_END);
+        std::string contents(std::size_t(std::ftell(file)), '\0');
+        std::fseek(file, 0, SEEK_SET);
+        contents.resize(std::fread(&contents[0], 1, contents.size(), file));
+        std::fclose(file);
+
+        const char* cursor = contents.c_str();
+        for (std::size_t i = 0; i < n; ++i) {
+            char* end = nullptr;
+            for (std::vector<double>* column : {&parsed.S, &parsed.K, &parsed.r, &parsed.sigma, &parsed.expiry,
+                                                &parsed.q}) {
+                column->push_back(std::strtod(cursor, &end));
+                cursor = end + 1;
+            }
+            parsed.type.push_back(*cursor == 'A' ? OptionType::American : OptionType::European);
+            cursor = std::strchr(cursor, ',') + 1;
+            parsed.style.push_back(*cursor == 'P' ? OptionStyle::Put : OptionStyle::Call);
+            cursor = std::strchr(cursor, '\n') + 1;
+        }
+    });
+    double textPrice = timeSeconds([&] { priceBatch(parsed.view(), textOut.view()); });
+
+    // Pages are faulted in lazily, so part of the columnar load shows up as pricing time
+    std::unique_ptr<PositionsFileReader> positions;
+    double columnarLoad = timeSeconds([&] { positions = std::make_unique<PositionsFileReader>(columnarPath); });
+    double columnarPrice = timeSeconds([&] { priceBatch(positions->batch(), columnarOut.view()); });
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        mismatches += textOut.price[i] != columnarOut.price[i];
+    }
+
+    std::printf("Load and price %zu European options\n", n);
+    std::printf("  CSV text (%5.1f MB) : load %7.1f ms  price %7.1f ms  total %7.1f ms\n",
+                std::filesystem::file_size(textPath) / 1e6, textLoad * 1e3, textPrice * 1e3,
+                (textLoad + textPrice) * 1e3);
+    std::printf("  columnar (%5.1f MB) : load %7.1f ms  price %7.1f ms  total %7.1f ms  (%.1fx)\n",
+                std::filesystem::file_size(columnarPath) / 1e6, columnarLoad * 1e3, columnarPrice * 1e3,
+                (columnarLoad + columnarPrice) * 1e3, (textLoad + textPrice) / (columnarLoad + columnarPrice));
+    std::printf("  price mismatches: %zu\n", mismatches);
+
+    std::filesystem::remove(textPath);
+    std::filesystem::remove(columnarPath);
+}
+
+void benchValidation(std::size_t n) {
+    // One row in a hundred is invalid, in a rotating way
+    ColumnarChain chain(n);
+    for (std::size_t i = 0; i < n; i += 100) {
+        switch (i / 100 % 3) {
+        case 0: chain.sigma[i] = -0.2; break;
+        case 1: chain.K[i] = std::numeric_limits<double>::quiet_NaN(); break;
+        default: chain.expiry[i] = 0.0; break;
+        }
+    }
+
+    std::vector<std::string> thrown(n);
+    std::size_t thrownCount = 0;
+    double perRow = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                validateOptionParameters(chain.row(i));
+            } catch (const OptionPricingError& e) {
+                thrown[i] = e.what();
+                ++thrownCount;
+            }
+        }
+    });
+
+    std::vector<ValidationStatus> status(n);
+    std::size_t invalid = 0;
+    double batch = timeSeconds([&] { invalid = validateOptionBatchT(chain.view(), status.data()); });
+
+    std::size_t messageMismatches = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        messageMismatches += (status[i] != 0 ? validationMessage(status[i]) : std::string()) != thrown[i];
+    }
+
+    ColumnarResults out(n);
+    double price = timeSeconds([&] { priceBatch(chain.view(), out.view(), 500, status.data()); });
+    BlackScholesModel bs;
+    std::size_t nanRows = 0;
+    double maxDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (status[i] != 0) {
+            nanRows += std::isnan(out.price[i]) && std::isnan(out.rho[i]);
+        } else if (i % 97 == 0) {
+            maxDiff = std::max(maxDiff, std::abs(out.price[i] - bs.calculate(chain.row(i)).price));
+        }
+    }
+
+    std::printf("Validation, %zu European options, %zu invalid\n", n, invalid);
+    std::printf("  per row, throwing :  %7.2f ns/opt  (%zu thrown)\n", perRow * 1e9 / n, thrownCount);
+    std::printf("  batch status      :  %7.2f ns/opt  (%.0fx)  message mismatches %zu\n", batch * 1e9 / n,
+                perRow / batch, messageMismatches);
+    std::printf("  priceBatch with status: %.1f ms, invalid rows NaN %zu/%zu, max |diff| valid rows %.3g\n",
+                price * 1e3, nanRows, invalid, maxDiff);
+}
+
+void benchLiveBook(std::size_t n) {
+    ColumnarChain chain(n);
+    std::fill(chain.r.begin(), chain.r.end(), 0.03);
+    std::fill(chain.q.begin(), chain.q.end(), 0.01);
+
+    // The same options on one underlying, and spread over a hundred
+    std::size_t underlyingCounts[] = {1, 100};
+    std::printf("Live book, %zu European options, spot ticks\n", n);
+    for (std::size_t underlyingCount : underlyingCounts) {
+        LiveBook book;
+        for (std::size_t u = 0; u < underlyingCount; ++u) {
+            book.addUnderlying(100.0, 0.03, 0.01);
+        }
+        double build = timeSeconds([&] {
+            for (std::size_t i = 0; i < n; ++i) {
+                book.addPosition(i % underlyingCount, chain.K[i], chain.expiry[i], chain.sigma[i], chain.style[i]);
+            }
+        });
+
+        std::mt19937_64 rng(3);
+        std::normal_distribution<double> move(0.0, 0.001);
+        std::vector<double> spots(underlyingCount, 100.0);
+        std::vector<double> latency;
+        for (int tick = 0; tick < 400; ++tick) {
+            std::size_t u = tick % underlyingCount;
+            spots[u] *= std::exp(move(rng));
+            latency.push_back(timeSeconds([&] { book.updateSpot(u, spots[u]); }));
+        }
+        std::sort(latency.begin(), latency.end());
+
+        // Market data moves that refresh cached terms, then a check against the model
+        double refresh = timeSeconds([&] {
+            book.updateVolatility(0, 0.3);
+            book.updateRate(0, 0.04);
+            book.updateDividendYield(0, 0.02);
+        });
+        BlackScholesModel model;
+        double worst = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t u = i % underlyingCount;
+            OptionParameters params = chain.row(i);
+            params.S = spots[u];
+            if (u == 0) {
+                params.sigma = 0.3;
+                params.r = 0.04;
+                params.q = 0.02;
+            }
+            PricingResult reference = model.calculate(params);
+            PricingResult live = book.result(i);
+            double pairs[][2] = {{reference.price, live.price}, {reference.greeks.delta, live.greeks.delta},
+                                 {reference.greeks.gamma, live.greeks.gamma}, {reference.greeks.theta, live.greeks.theta},
+                                 {reference.greeks.vega, live.greeks.vega}, {reference.greeks.rho, live.greeks.rho}};
+            // Relative above one, absolute below: deep out-of-the-money prices cancel in both
+            for (auto& pair : pairs) {
+                worst = std::max(worst, std::abs(pair[0] - pair[1]) / std::max(1.0, std::abs(pair[0])));
+            }
+        }
+
+        std::printf("  %3zu underlyings: build %6.1f ms, tick median %7.1f us, p99 %7.1f us, "
+                    "vol+rate+yield %6.1f ms, max diff %.2g\n",
+                    underlyingCount, build * 1e3, latency[latency.size() / 2] * 1e6,
+                    latency[latency.size() * 99 / 100] * 1e6, refresh * 1e3, worst);
+    }
+
+    // Without the book a tick means repricing every option on the underlying from scratch
+    ColumnarResults out(n);
+    BlackScholesModel model;
+    std::vector<double> full;
+    for (int tick = 0; tick < 20; ++tick) {
+        std::fill(chain.S.begin(), chain.S.end(), 100.0 + 0.01 * tick);
+        full.push_back(timeSeconds([&] { model.calculateBatch(chain.view(), out.view()); }));
+    }
+    std::sort(full.begin(), full.end());
+    std::printf("  full batch reprice of all %zu: median %.1f us\n", n, full[full.size() / 2] * 1e6);
+}
+
+// Strike x expiry grids with a volatility smile, stored both as chains and as flat rows
+struct ChainGrid {
+    std::vector<double> S, r, q, expiry, K, sigma;
+    std::vector<OptionStyle> style;
+    std::vector<OptionType> type;
+    std::vector<std::size_t> expiryBegin{0}, strikeBegin{0};
+    ColumnarChain rows{0};
+
+    ChainGrid(std::size_t underlyings, std::size_t expiries, std::size_t strikes, OptionType kind, bool smile) {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> spot(20.0, 500.0);
+        std::uniform_real_distribution<double> rate(0.0, 0.08);
+        std::uniform_real_distribution<double> yield(0.0, 0.04);
+        for (std::size_t u = 0; u < underlyings; ++u) {
+            S.push_back(spot(rng));
+            r.push_back(rate(rng));
+            q.push_back(yield(rng));
+            for (std::size_t e = 0; e < expiries; ++e) {
+                expiry.push_back(0.05 + 3.0 * double(e) / double(expiries));
+                type.push_back(kind);
+                for (std::size_t k = 0; k < strikes; ++k) {
+                    double moneyness = 0.6 + 0.8 * double(k) / double(strikes);
+                    K.push_back(S[u] * moneyness);
+                    sigma.push_back(smile ? 0.2 + 0.5 * (moneyness - 1.0) * (moneyness - 1.0) : 0.25);
+                    style.push_back(k % 2 ? OptionStyle::Put : OptionStyle::Call);
+
+                    rows.S.push_back(S[u]);
+                    rows.K.push_back(K.back());
+                    rows.r.push_back(r[u]);
+                    rows.q.push_back(q[u]);
+                    rows.sigma.push_back(sigma.back());
+                    rows.expiry.push_back(expiry.back());
+                    rows.style.push_back(style.back());
+                    rows.type.push_back(kind);
+                }
+                strikeBegin.push_back(K.size());
+            }
+            expiryBegin.push_back(expiry.size());
+        }
+    }
+
+    OptionChain view() const {
+        return {S.size(), S.data(), r.data(), q.data(), expiryBegin.data(), expiry.data(), type.data(),
+                strikeBegin.data(), K.data(), sigma.data(), style.data()};
+    }
+};
+
+void benchChainPricing() {
+    std::printf("Chain pricing, per option (row by row / flat batch / chain)\n");
+
+    ChainGrid european(300, 8, 40, OptionType::European, true);
+    std::size_t n = european.K.size();
+    ColumnarResults flat(n), chained(n);
+    BlackScholesModel bs;
+    std::vector<PricingResult> single(n);
+    double rowTime = timeSeconds([&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            single[i] = bs.calculate(european.rows.row(i));
+        }
+    });
+    double batchTime = timeSeconds([&] { bs.calculateBatch(european.rows.view(), flat.view()); });
+    double chainTime = timeSeconds([&] { priceChain(european.view(), chained.view()); });
+    double maxDiff = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        maxDiff = std::max({maxDiff, std::abs(chained.price[i] - single[i].price),
+                            std::abs(chained.delta[i] - single[i].greeks.delta),
+                            std::abs(chained.vega[i] - single[i].greeks.vega)});
+    }
+    std::printf("  European 300 x 8 x 40 smile:  %7.1f / %6.1f / %6.1f ns  (%.1fx / %.1fx)  max |diff| %.2g\n",
+                rowTime * 1e9 / n, batchTime * 1e9 / n, chainTime * 1e9 / n, rowTime / chainTime,
+                batchTime / chainTime, maxDiff);
+
+    // American expiries with one volatility each share a lattice setup across strikes
+    const int steps = 500;
+    ChainGrid american(4, 4, 16, OptionType::American, false);
+    std::size_t m = american.K.size();
+    BinomialModel binomial(steps);
+    for (bool greeks : {false, true}) {
+        ColumnarResults flatAmerican(m), chainedAmerican(m);
+        PricingResultBatch flatOut = flatAmerican.view(), chainOut = chainedAmerican.view();
+        if (!greeks) {
+            flatOut = {flatAmerican.price.data()};
+            chainOut = {chainedAmerican.price.data()};
+        }
+        double rows = timeSeconds([&] {
+            for (std::size_t i = 0; i < m; ++i) {
+                flatAmerican.price[i] = greeks ? binomial.calculate(american.rows.row(i)).price
+                                               : binomial.calculatePrice(american.rows.row(i));
+            }
+        });
+        double batch = timeSeconds([&] { binomial.calculateBatch(american.rows.view(), flatOut); });
+        double chain = timeSeconds([&] { priceChain(american.view(), chainOut, steps); });
+        double diff = 0.0;
+        for (std::size_t i = 0; i < m; ++i) {
+            diff = std::max(diff, std::abs(chainedAmerican.price[i] - flatAmerican.price[i]));
+            if (greeks) {
+                diff = std::max({diff, std::abs(chainedAmerican.delta[i] - flatAmerican.delta[i]),
+                                 std::abs(chainedAmerican.vega[i] - flatAmerican.vega[i])});
+            }
+        }
+        std::printf("  American 4 x 4 x 16, %s: %7.1f / %6.1f / %6.1f us  (%.1fx / %.1fx)  max |diff| %.2g\n",
+                    greeks ? "Greeks" : "prices", rows * 1e6 / m, batch * 1e6 / m, chain * 1e6 / m, rows / chain,
+                    batch / chain, diff);
+    }
+}
+
+void benchStrikeLadder(std::size_t strikes) {
+    const int steps = 500;
+    std::printf("American strike ladder, %zu strikes, %d steps (per-strike trees / shared setup / ladder)\n",
+                strikes, steps);
+    BinomialModel binomial(steps);
+    AndersenLakeOffengeltModel reference;
+
+    struct Case { const char* name; double r, q, sigma, expiry; OptionStyle style; };
+    const Case cases[] = {{"put  r 5% q 2% vol 30% 1y  ", 0.05, 0.02, 0.30, 1.0, OptionStyle::Put},
+                          {"call r 3% q 6% vol 20% 3m  ", 0.03, 0.06, 0.20, 0.25, OptionStyle::Call},
+                          {"put  r 8% q 0% vol 12% 2y  ", 0.08, 0.00, 0.12, 2.0, OptionStyle::Put}};
+    for (const Case& c : cases) {
+        OptionParameters params;
+        params.S = 100.0;
+        params.r = c.r;
+        params.q = c.q;
+        params.sigma = c.sigma;
+        params.expiry = c.expiry;
+        params.style = c.style;
+        params.type = OptionType::American;
+
+        std::vector<double> K(strikes);
+        for (std::size_t i = 0; i < strikes; ++i) {
+            K[i] = 60.0 + 80.0 * double(i) / double(strikes - 1);
+        }
+        std::vector<OptionStyle> style(strikes, c.style);
+
+        std::vector<double> tree(strikes), shared(strikes), ladder(strikes);
+        double treeTime = timeSeconds([&] {
+            for (std::size_t i = 0; i < strikes; ++i) {
+                OptionParameters row = params;
+                row.K = K[i];
+                tree[i] = binomial.calculatePrice(row);
+            }
+        });
+        double sharedTime = timeSeconds([&] {
+            binomial.calculateStrikes(params, strikes, K.data(), style.data(), PricingResultBatch{shared.data()});
+        });
+        StrikeLadderPricer pricer(steps);
+        double coldTime = timeSeconds([&] { pricer.price(params, strikes, K.data(), ladder.data()); });
+        double cachedTime = timeSeconds([&] {
+            for (int rep = 0; rep < 100; ++rep) {
+                pricer.price(params, strikes, K.data(), ladder.data());
+            }
+        }) / 100;
+
+        // Distance from the per-strike trees, and of both from the ALO solution
+        double ladderVsTree = 0.0, treeError = 0.0, ladderError = 0.0;
+        for (std::size_t i = 0; i < strikes; ++i) {
+            OptionParameters row = params;
+            row.K = K[i];
+            double exact = reference.calculatePrice(row);
+            ladderVsTree = std::max(ladderVsTree, std::abs(ladder[i] - tree[i]));
+            treeError = std::max(treeError, std::abs(tree[i] - exact));
+            ladderError = std::max(ladderError, std::abs(ladder[i] - exact));
+        }
+        std::printf("  %s %7.2f / %6.2f / %6.3f ms, cached %6.1f us (%.0fx cold)\n", c.name, treeTime * 1e3,
+                    sharedTime * 1e3, coldTime * 1e3, cachedTime * 1e6, treeTime / coldTime);
+        std::printf("  %*s max |ladder - tree| %.2g, max error vs ALO: tree %.2g, ladder %.2g\n", 28, "",
+                    ladderVsTree, treeError, ladderError);
+    }
+}
+
+void benchResultCache(std::size_t requests, std::size_t contracts) {
+    // Requests for a few popular American contracts, with quotes jittered below the quantization
+    ColumnarChain chain(contracts, 5);
+    std::mt19937_64 rng(17);
+    std::uniform_int_distribution<std::size_t> pick(0, contracts - 1);
+    std::uniform_real_distribution<double> jitter(-0.004, 0.004);
+    std::vector<OptionParameters> stream(requests);
+    for (OptionParameters& params : stream) {
+        params = chain.row(pick(rng));
+        params.S = std::round(params.S * 100.0) / 100.0 + jitter(rng);
+        params.type = OptionType::American;
+    }
+
+    PricingEngine uncached(AmericanModel::Binomial, 500);
+    PricingEngine cached(AmericanModel::Binomial, 500);
+    ResultCacheConfig config;
+    config.spotStep = 0.01;
+    cached.enableResultCache(config);
+
+    std::size_t sample = std::min<std::size_t>(requests, 200);
+    double miss = timeSeconds([&] {
+        for (std::size_t i = 0; i < sample; ++i) {
+            uncached.price(stream[i]);
+        }
+    }) / double(sample);
+    double maxDiff = 0.0;
+    double all = timeSeconds([&] {
+        for (const OptionParameters& params : stream) {
+            cached.price(params);
+        }
+    });
+    for (std::size_t i = 0; i < sample; ++i) {
+        OptionParameters rounded = cached.resultCache()->quantize(stream[i]);
+        maxDiff = std::max(maxDiff, std::abs(cached.price(stream[i]).price - uncached.price(rounded).price));
+    }
+    double hit = timeSeconds([&] {
+        for (const OptionParameters& params : stream) {
+            cached.price(params);
+        }
+    }) / double(requests);
+
+    ResultCacheStats stats = cached.resultCache()->stats();
+    std::printf("Result cache, %zu American requests over %zu contracts, 500-step trees\n", requests, contracts);
+    std::printf("  uncached %8.1f us/request, cached hit %6.0f ns (%.0fx), whole stream %6.1f ms\n", miss * 1e6,
+                hit * 1e9, miss / hit, all * 1e3);
+    std::printf("  %s, max |diff| vs rounded %.2g\n", formatResultCacheStats(stats).c_str(), maxDiff);
+}
+
+void benchScenarioGrid() {
+    std::printf("Scenario grid, spot x volatility (cell by cell / grid / after a spot shift of 5%%)\n");
+    for (OptionType type : {OptionType::European, OptionType::American}) {
+        const int steps = 200;
+        OptionParameters contract;
+        contract.K = 100.0;
+        contract.r = 0.05;
+        contract.q = 0.02;
+        contract.expiry = 1.0;
+        contract.type = type;
+        contract.style = OptionStyle::Put;
+
+        std::vector<double> spots = scenarioAxis(50.0, 150.0, 100);
+        std::vector<double> vols = scenarioAxis(0.0, 1.0, 100);
+
+        ScenarioGrid grid;
+        grid.setScenarios(contract, ScenarioAxis::Volatility, spots, vols, steps);
+        std::size_t tiles = 0;
+        double gridTime = timeSeconds([&] { grid.priceMissing([&](const ScenarioTile&) { ++tiles; }); });
+
+        BlackScholesModel bs;
+        BinomialModel binomial(steps);
+        double maxDiff = 0.0;
+        double cellTime = timeSeconds([&] {
+            for (std::size_t row = 0; row < grid.rows(); ++row) {
+                for (std::size_t column = 0; column < grid.columns(); ++column) {
+                    OptionParameters params = grid.scenario(row, column);
+                    PricingResult result =
+                        type == OptionType::European ? bs.calculate(params) : binomial.calculate(params);
+                    maxDiff = std::max({maxDiff, std::abs(result.price - grid.cell(row, column).price),
+                                        std::abs(result.greeks.delta - grid.cell(row, column).greeks.delta)});
+                }
+            }
+        });
+
+        std::size_t repriced =
+            grid.setScenarios(contract, ScenarioAxis::Volatility, scenarioAxis(55.0, 155.0, 100), vols, steps);
+        double shiftTime = timeSeconds([&] { grid.priceMissing(); });
+        std::printf("  %s put, %zu x %zu, %zu tiles: %8.2f / %7.2f / %6.2f ms (%zu cells)  max |diff| %.2g\n",
+                    type == OptionType::European ? "European" : "American", grid.rows(), grid.columns(), tiles,
+                    cellTime * 1e3, gridTime * 1e3, shiftTime * 1e3, repriced, maxDiff);
+    }
+}
+
+} // namespace
+
+int main() {
+    benchBlackScholesBatch(50000, 20);
+    benchSharedBinomialModel(400, 8);
+    benchBinomialGreeks(200, 500);
+    benchLatticeKernel();
+    benchBinomialBatch(1000, 500);
+    benchAmericanApproximations(200);
+    benchPortfolioScaling(20000);
+    benchStaticDispatch(20000, 20);
+    benchImpliedVolatility(100000, 50);
+    benchAutodiffGreeks(100, 500);
+    benchFiniteDiffGreeks(200, 500);
+    benchFiniteDifference(200, 41);
+    benchMonteCarlo();
+    benchColumnarFile(1000000);
+    benchValidation(1000000);
+    benchLiveBook(100000);
+    benchChainPricing();
+    benchStrikeLadder(200);
+    benchResultCache(200000, 1000);
+    benchScenarioGrid();
+    return 0;
+}
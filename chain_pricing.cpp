@@ -0,0 +1,271 @@
+#include "chain_pricing.h"
+#include "option_pricing.h"
+#include "math_utils.h"
+#include "vector_math.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+#if OPTION_PRICING_HAS_SIMD
+constexpr std::size_t laneWidth = PackedDouble::width;
+#else
+constexpr std::size_t laneWidth = 1;
+#endif
+
+// Market data of one expiry, shared by all of its strikes
+template<typename T>
+struct ExpiryTermsT {
+    T S{};
+    T logS{};
+    T inverseSquareS{};
+    T r{};
+    T q{};
+    T expiry{};
+    T sqrtT{};
+    T carry{};      // exp(-qT)
+    T discount{};   // exp(-rT)
+    T drift{};      // (r - q) T
+};
+
+template<typename T>
+ExpiryTermsT<T> expiryTerms(const OptionChainT<T>& chain, std::size_t underlying, std::size_t e) {
+    using std::exp;
+    using std::log;
+    using std::sqrt;
+    ExpiryTermsT<T> terms;
+    terms.S = chain.S[underlying];
+    terms.logS = log(terms.S);
+    terms.inverseSquareS = T(1) / (terms.S * terms.S);
+    terms.r = chain.r[underlying];
+    terms.q = chain.q[underlying];
+    terms.expiry = chain.expiry[e];
+    terms.sqrtT = sqrt(terms.expiry);
+    terms.carry = exp(-terms.q * terms.expiry);
+    terms.discount = exp(-terms.r * terms.expiry);
+    terms.drift = (terms.r - terms.q) * terms.expiry;
+    return terms;
+}
+
+// Price and Greeks of one lane group of strikes, written to out[c] for the columns c in
+// the order of PricingResultBatchT. The formulas are those of blackScholesPacked in
+// option_pricing.cpp with the expiry terms substituted; sign is -1 for puts.
+template<typename T>
+void europeanGroup(const ExpiryTermsT<T>& t, const T* K, const T* sigma, const T* sign, T* const* out) {
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same_v<T, double>) {
+        PackedDouble strike = packedLoad(K);
+        PackedDouble vol = packedLoad(sigma);
+        PackedDouble s = packedLoad(sign);
+        PackedDouble sqrtT = packedSet(t.sqrtT);
+        PackedDouble sigmaSqrtT = vol * sqrtT;
+        PackedDouble inverseSigmaSqrtT = packedSet(1.0) / sigmaSqrtT;
+
+        PackedDouble d1 = (packedSet(t.logS + t.drift) - packedLog(strike) +
+                           packedSet(0.5) * sigmaSqrtT * sigmaSqrtT) * inverseSigmaSqrtT;
+        PackedDouble d2 = d1 - sigmaSqrtT;
+
+        PackedDouble pd1;
+        PackedDouble nd1 = packedNormalCDF(s * d1, pd1);
+        PackedDouble nd2 = packedNormalCDF(s * d2);
+
+        PackedDouble carry = packedSet(t.carry);
+        PackedDouble spotCarry = packedSet(t.S * t.carry);
+        PackedDouble spotLeg = spotCarry * nd1;
+        PackedDouble strikeLeg = strike * packedSet(t.discount) * nd2;
+        PackedDouble scaledDensity = spotCarry * pd1;
+
+        packedStore(out[0], s * (spotLeg - strikeLeg));
+        packedStore(out[1], s * carry * nd1);
+        packedStore(out[2], scaledDensity * inverseSigmaSqrtT * packedSet(t.inverseSquareS));
+        packedStore(out[3], scaledDensity * vol / (packedSet(2.0) * sqrtT) +
+                                s * (packedSet(t.r) * strikeLeg - packedSet(t.q) * spotLeg));
+        packedStore(out[4], scaledDensity * sqrtT);
+        packedStore(out[5], s * packedSet(t.expiry) * strikeLeg);
+        return;
+    }
+#endif
+
+    using std::log;
+    for (std::size_t l = 0; l < laneWidth; ++l) {
+        T sigmaSqrtT = sigma[l] * t.sqrtT;
+        T d1 = (t.logS + t.drift - log(K[l]) + T(0.5) * sigmaSqrtT * sigmaSqrtT) / sigmaSqrtT;
+        T d2 = d1 - sigmaSqrtT;
+
+        T pd1;
+        T nd1 = normalCDF(sign[l] * d1, pd1);
+        T nd2 = normalCDF(sign[l] * d2);
+
+        T spotCarry = t.S * t.carry;
+        T spotLeg = spotCarry * nd1;
+        T strikeLeg = K[l] * t.discount * nd2;
+        T scaledDensity = spotCarry * pd1;
+
+        out[0][l] = sign[l] * (spotLeg - strikeLeg);
+        out[1][l] = sign[l] * t.carry * nd1;
+        out[2][l] = scaledDensity * t.inverseSquareS / sigmaSqrtT;
+        out[3][l] = scaledDensity * sigma[l] / (T(2) * t.sqrtT) + sign[l] * (t.r * strikeLeg - t.q * spotLeg);
+        out[4][l] = scaledDensity * t.sqrtT;
+        out[5][l] = sign[l] * t.expiry * strikeLeg;
+    }
+}
+
+// Strikes [first, last) of a European expiry. Full lane groups are read from the chain and
+// written to results in place; the final partial group goes through local buffers.
+template<typename T>
+void priceEuropeanExpiry(const OptionChainT<T>& chain, const ExpiryTermsT<T>& terms, std::size_t first,
+                         std::size_t last, const PricingResultBatchT<T>& results) {
+    alignas(64) T sign[laneWidth];
+    alignas(64) T scratch[6][laneWidth];
+    T* columns[6] = {results.price, results.delta, results.gamma, results.theta, results.vega, results.rho};
+    T* out[6];
+    std::size_t i = first;
+    for (; i + laneWidth <= last; i += laneWidth) {
+        for (std::size_t l = 0; l < laneWidth; ++l) {
+            sign[l] = chain.style[i + l] == OptionStyle::Put ? T(-1) : T(1);
+        }
+        for (int c = 0; c < 6; ++c) {
+            out[c] = columns[c] ? columns[c] + i : scratch[c];
+        }
+        europeanGroup(terms, chain.K + i, chain.sigma + i, sign, out);
+    }
+
+    std::size_t live = last - i;
+    if (live == 0) {
+        return;
+    }
+    // Padded with copies of the last strike
+    alignas(64) T K[laneWidth];
+    alignas(64) T sigma[laneWidth];
+    for (std::size_t l = 0; l < laneWidth; ++l) {
+        std::size_t row = i + std::min(l, live - 1);
+        K[l] = chain.K[row];
+        sigma[l] = chain.sigma[row];
+        sign[l] = chain.style[row] == OptionStyle::Put ? T(-1) : T(1);
+    }
+    for (int c = 0; c < 6; ++c) {
+        out[c] = scratch[c];
+    }
+    europeanGroup(terms, K, sigma, sign, out);
+    for (int c = 0; c < 6; ++c) {
+        if (columns[c]) {
+            std::copy(scratch[c], scratch[c] + live, columns[c] + i);
+        }
+    }
+}
+
+template<typename T>
+PricingResultBatchT<T> offsetResults(const PricingResultBatchT<T>& results, std::size_t first) {
+    PricingResultBatchT<T> out;
+    out.price = results.price + first;
+    out.delta = results.delta ? results.delta + first : nullptr;
+    out.gamma = results.gamma ? results.gamma + first : nullptr;
+    out.theta = results.theta ? results.theta + first : nullptr;
+    out.vega = results.vega ? results.vega + first : nullptr;
+    out.rho = results.rho ? results.rho + first : nullptr;
+    return out;
+}
+
+// Strikes [first, last) of an American expiry. With one volatility they differ only in
+// the payoff and share a lattice; a volatility smile needs a lattice per strike.
+template<typename T>
+void priceAmericanExpiry(const OptionChainT<T>& chain, const ExpiryTermsT<T>& terms, std::size_t first,
+                         std::size_t last, const PricingResultBatchT<T>& results, int steps) {
+    BinomialModelT<T> binomial(steps);
+    std::size_t count = last - first;
+    PricingResultBatchT<T> out = offsetResults(results, first);
+
+    const T* sigma = chain.sigma + first;
+    if (std::all_of(sigma, sigma + count, [&](const T& v) { return v == sigma[0]; })) {
+        OptionParametersT<T> params;
+        params.S = terms.S;
+        params.r = terms.r;
+        params.q = terms.q;
+        params.sigma = sigma[0];
+        params.expiry = terms.expiry;
+        params.type = OptionType::American;
+        binomial.calculateStrikes(params, count, chain.K + first, chain.style + first, out);
+        return;
+    }
+
+    std::vector<T> S(count, terms.S), r(count, terms.r), q(count, terms.q), expiry(count, terms.expiry);
+    std::vector<OptionType> type(count, OptionType::American);
+    OptionBatchT<T> batch{count, S.data(), chain.K + first, r.data(), q.data(), sigma, expiry.data(),
+                          chain.style + first, type.data()};
+    binomial.calculateBatch(batch, out);
+}
+
+// Rejects the chain on its first invalid row with the message of validateOptionParametersT.
+// The strikes of an expiry are checked with a branch-free pass first; only an expiry that
+// fails it is searched row by row for the message.
+template<typename T>
+void validateChain(const OptionChainT<T>& chain) {
+    const T largest = T(std::numeric_limits<double>::max());
+    OptionParametersT<T> params;
+    for (std::size_t u = 0; u < chain.underlyingCount; ++u) {
+        params.S = chain.S[u];
+        params.r = chain.r[u];
+        params.q = chain.q[u];
+        for (std::size_t e = chain.expiryBegin[u]; e < chain.expiryBegin[u + 1]; ++e) {
+            params.expiry = chain.expiry[e];
+            std::size_t first = chain.strikeBegin[e];
+            std::size_t last = chain.strikeBegin[e + 1];
+            if (first == last) {
+                continue;
+            }
+            params.K = chain.K[first];
+            params.sigma = chain.sigma[first];
+            bool valid = validationStatusT(params) == 0;
+            for (std::size_t i = first; i < last; ++i) {
+                valid &= chain.K[i] > T(0) && chain.K[i] <= largest && chain.sigma[i] > T(0) &&
+                         chain.sigma[i] <= largest;
+            }
+            if (valid) {
+                continue;
+            }
+            for (std::size_t i = first; i < last; ++i) {
+                params.K = chain.K[i];
+                params.sigma = chain.sigma[i];
+                ValidationStatus status = validationStatusT(params);
+                if (status != 0) {
+                    throw OptionPricingError("Row " + std::to_string(i) + ": " + validationMessage(status));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+template<typename T>
+void priceChainT(const OptionChainT<T>& chain, const PricingResultBatchT<T>& results, int steps) {
+    validateChain(chain);
+
+    std::size_t expiries = chain.expiryCount();
+    std::vector<std::size_t> underlyingOf(expiries);
+    for (std::size_t u = 0; u < chain.underlyingCount; ++u) {
+        std::fill(underlyingOf.begin() + chain.expiryBegin[u], underlyingOf.begin() + chain.expiryBegin[u + 1], u);
+    }
+
+    WorkStealingPool::shared().run(expiries, [&](std::size_t e) {
+        ExpiryTermsT<T> terms = expiryTerms(chain, underlyingOf[e], e);
+        std::size_t first = chain.strikeBegin[e];
+        std::size_t last = chain.strikeBegin[e + 1];
+        if (first == last) {
+            return;
+        }
+        if (chain.type && chain.type[e] == OptionType::American) {
+            priceAmericanExpiry(chain, terms, first, last, results, steps);
+        } else {
+            priceEuropeanExpiry(chain, terms, first, last, results);
+        }
+    });
+}
+
+// Explicit instantiations
+template void priceChainT<double>(const OptionChain&, const PricingResultBatch&, int);
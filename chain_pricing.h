@@ -0,0 +1,47 @@
+#ifndef CHAIN_PRICING_H
+#define CHAIN_PRICING_H
+
+#include "types.h"
+#include <cstddef>
+
+// Columnar view over option chains grouped by underlying, then expiry, then strike. The
+// groups are given by offsets: the expiries of underlying u are [expiryBegin[u],
+// expiryBegin[u + 1]) and the strikes of expiry e are [strikeBegin[e], strikeBegin[e + 1]),
+// both starting at 0. Options, and their results, are numbered in strike order.
+template<typename T = double>
+struct OptionChainT {
+    std::size_t underlyingCount{};
+    const T* S{};
+    const T* r{};
+    const T* q{};
+    const std::size_t* expiryBegin{};   // underlyingCount + 1 entries
+    const T* expiry{};
+    const OptionType* type{};           // Per expiry; optional, when null every expiry is European
+    const std::size_t* strikeBegin{};   // One entry more than there are expiries
+    const T* K{};
+    const T* sigma{};
+    const OptionStyle* style{};
+
+    std::size_t expiryCount() const { return expiryBegin[underlyingCount]; }
+    std::size_t optionCount() const { return strikeBegin[expiryCount()]; }
+};
+
+// Prices every option of the chains into results, indexed like the strikes. Terms shared
+// by an underlying (log S) or an expiry (sqrt T and the discount factors) are computed once,
+// and European strikes go through a SIMD kernel that is left with a log and two normal
+// CDFs per option. The strikes of an American expiry share one lattice setup when they
+// share a volatility, and otherwise go through BinomialModelT::calculateBatch. Greek
+// columns may be left null, for American expiries too: any Greek column set computes the
+// lattice Greeks and writes the ones requested. Expiries are spread over
+// WorkStealingPool::shared(). Throws OptionPricingError naming the first invalid row.
+template<typename T>
+void priceChainT(const OptionChainT<T>& chain, const PricingResultBatchT<T>& results, int steps = 500);
+
+// Type aliases for backward compatibility
+using OptionChain = OptionChainT<double>;
+
+inline void priceChain(const OptionChain& chain, const PricingResultBatch& results, int steps = 500) {
+    priceChainT<double>(chain, results, steps);
+}
+
+#endif // CHAIN_PRICING_H
@@ -0,0 +1,356 @@
+#include "columnar_file.h"
+#include "pricing_exceptions.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OPTION_PRICING_HAS_MMAP 1
+#endif
+
+namespace {
+
+const char columnarMagic[8] = "OPTCOLS";
+
+struct ColumnSpec {
+    ColumnId id;
+    std::uint32_t elementSize;
+};
+
+const ColumnSpec positionColumns[] = {
+    {ColumnId::S, 8}, {ColumnId::K, 8}, {ColumnId::r, 8}, {ColumnId::sigma, 8},
+    {ColumnId::expiry, 8}, {ColumnId::q, 8}, {ColumnId::style, 1}, {ColumnId::type, 1},
+};
+
+const ColumnSpec resultColumns[] = {
+    {ColumnId::price, 8}, {ColumnId::delta, 8}, {ColumnId::gamma, 8},
+    {ColumnId::theta, 8}, {ColumnId::vega, 8}, {ColumnId::rho, 8},
+};
+
+constexpr std::size_t positionColumnCount = sizeof(positionColumns) / sizeof(positionColumns[0]);
+constexpr std::size_t resultColumnCount = sizeof(resultColumns) / sizeof(resultColumns[0]);
+
+std::size_t alignUp(std::size_t value) {
+    return (value + columnarAlignment - 1) / columnarAlignment * columnarAlignment;
+}
+
+DataFileError systemError(const std::string& what, const std::string& path) {
+    return DataFileError("Cannot " + what + " " + path + ": " + std::strerror(errno));
+}
+
+// Fills in the header and column table of a new file and returns its total size. With
+// region null only the size is computed.
+std::size_t writeLayout(unsigned char* region, ColumnarFileKind kind, const ColumnSpec* specs,
+                        std::size_t count, std::size_t rows) {
+    std::size_t offset = alignUp(sizeof(ColumnarHeader) + count * sizeof(ColumnDescriptor));
+    for (std::size_t c = 0; c < count; ++c) {
+        if (region) {
+            ColumnDescriptor descriptor{};
+            descriptor.column = std::uint32_t(specs[c].id);
+            descriptor.elementSize = specs[c].elementSize;
+            descriptor.offset = offset;
+            descriptor.bytes = std::uint64_t(rows) * specs[c].elementSize;
+            std::memcpy(region + sizeof(ColumnarHeader) + c * sizeof(ColumnDescriptor), &descriptor,
+                        sizeof(descriptor));
+        }
+        offset = alignUp(offset + rows * specs[c].elementSize);
+    }
+    if (region) {
+        ColumnarHeader header{};
+        std::memcpy(header.magic, columnarMagic, sizeof(header.magic));
+        header.version = columnarFormatVersion;
+        header.kind = std::uint32_t(kind);
+        header.rows = rows;
+        header.columnCount = std::uint32_t(count);
+        header.byteOrder = columnarByteOrderMark;
+        std::memcpy(region, &header, sizeof(header));
+    }
+    return offset;
+}
+
+// Checks the header of a mapped file and returns its row count
+std::size_t readHeader(const FileRegion& region, ColumnarFileKind kind, const std::string& path,
+                       ColumnarHeader& header) {
+    if (region.size() < sizeof(ColumnarHeader)) {
+        throw DataFileError(path + " is too short for a columnar file");
+    }
+    std::memcpy(&header, region.data(), sizeof(header));
+    if (std::memcmp(header.magic, columnarMagic, sizeof(header.magic)) != 0) {
+        throw DataFileError(path + " is not a columnar file");
+    }
+    if (header.byteOrder != columnarByteOrderMark) {
+        throw DataFileError(path + " was written with a different byte order");
+    }
+    if (header.version != columnarFormatVersion) {
+        throw DataFileError(path + " has unsupported format version " + std::to_string(header.version));
+    }
+    if (header.kind != std::uint32_t(kind)) {
+        throw DataFileError(path + (kind == ColumnarFileKind::Positions ? " does not hold positions"
+                                                                        : " does not hold results"));
+    }
+    std::size_t tableEnd = sizeof(ColumnarHeader) + std::size_t(header.columnCount) * sizeof(ColumnDescriptor);
+    if (header.columnCount > region.size() / sizeof(ColumnDescriptor) || tableEnd > region.size()) {
+        throw DataFileError(path + " has a truncated column table");
+    }
+    return std::size_t(header.rows);
+}
+
+// Locates a column and checks that it lies inside the file, suitably aligned
+const unsigned char* findColumn(const FileRegion& region, const ColumnarHeader& header, const ColumnSpec& spec,
+                                const std::string& path) {
+    for (std::uint32_t c = 0; c < header.columnCount; ++c) {
+        ColumnDescriptor descriptor;
+        std::memcpy(&descriptor, region.data() + sizeof(ColumnarHeader) + c * sizeof(ColumnDescriptor),
+                    sizeof(descriptor));
+        if (descriptor.column != std::uint32_t(spec.id)) {
+            continue;
+        }
+        std::string name = path + " column " + std::to_string(descriptor.column);
+        if (descriptor.elementSize != spec.elementSize) {
+            throw DataFileError(name + " has elements of the wrong size");
+        }
+        if (header.rows > region.size() / spec.elementSize || descriptor.bytes != header.rows * spec.elementSize) {
+            throw DataFileError(name + " does not match the row count");
+        }
+        if (descriptor.offset > region.size() || descriptor.bytes > region.size() - descriptor.offset) {
+            throw DataFileError(name + " extends past the end of the file");
+        }
+        if (descriptor.offset % spec.elementSize != 0) {
+            throw DataFileError(name + " is misaligned");
+        }
+        return region.data() + descriptor.offset;
+    }
+    throw DataFileError(path + " lacks column " + std::to_string(std::uint32_t(spec.id)));
+}
+
+} // namespace
+
+FileRegion::~FileRegion() {
+    try {
+        close();
+    } catch (const DataFileError&) {
+        // Destructors must not throw; call close() to see write errors
+    }
+}
+
+void FileRegion::openRead(const std::string& file) {
+    close();
+    path = file;
+    writable = false;
+#ifdef OPTION_PRICING_HAS_MMAP
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("open", file);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw systemError("inspect", file);
+    }
+    length = std::size_t(info.st_size);
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw systemError("map", file);
+        }
+        ::madvise(mapping, length, MADV_SEQUENTIAL);
+        address = mapping;
+        mapped = true;
+    }
+    ::close(fd);
+#else
+    std::FILE* stream = std::fopen(file.c_str(), "rb");
+    if (!stream) {
+        throw systemError("open", file);
+    }
+    std::fseek(stream, 0, SEEK_END);
+    length = std::size_t(std::ftell(stream));
+    std::fseek(stream, 0, SEEK_SET);
+    buffer.resize((length + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    address = buffer.data();
+    bool complete = std::fread(address, 1, length, stream) == length;
+    std::fclose(stream);
+    if (!complete) {
+        throw systemError("read", file);
+    }
+#endif
+}
+
+void FileRegion::create(const std::string& file, std::size_t size) {
+    close();
+    path = file;
+    writable = true;
+    length = size;
+#ifdef OPTION_PRICING_HAS_MMAP
+    int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw systemError("create", file);
+    }
+    if (::ftruncate(fd, off_t(size)) != 0) {
+        ::close(fd);
+        throw systemError("size", file);
+    }
+#ifdef __linux__
+    // Reserve the blocks now: a sparse file that runs out of disk raises SIGBUS in whichever
+    // thread first writes the page, rather than an error here. Filesystems without
+    // preallocation keep the sparse file.
+    if (size > 0) {
+        int error = ::posix_fallocate(fd, 0, off_t(size));
+        if (error != 0 && error != EOPNOTSUPP && error != EINVAL) {
+            ::close(fd);
+            errno = error;
+            throw systemError("allocate", file);
+        }
+    }
+#endif
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw systemError("map", file);
+    }
+    address = mapping;
+    mapped = true;
+#else
+    buffer.assign((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t), 0);
+    address = buffer.data();
+#endif
+}
+
+void FileRegion::close() {
+    if (!address) {
+        return;
+    }
+#ifdef OPTION_PRICING_HAS_MMAP
+    if (mapped) {
+        // Write back before unmapping, since munmap reports no write errors
+        bool complete = !writable || ::msync(address, length, MS_SYNC) == 0;
+        int error = errno;
+        ::munmap(address, length);
+        address = nullptr;
+        length = 0;
+        mapped = false;
+        if (!complete) {
+            errno = error;
+            throw systemError("write", path);
+        }
+    }
+#else
+    if (writable) {
+        std::FILE* stream = std::fopen(path.c_str(), "wb");
+        bool complete = stream && std::fwrite(address, 1, length, stream) == length;
+        complete = stream && std::fclose(stream) == 0 && complete;
+        address = nullptr;
+        if (!complete) {
+            throw systemError("write", path);
+        }
+    }
+#endif
+    address = nullptr;
+    length = 0;
+    mapped = false;
+    buffer.clear();
+}
+
+PositionsFileReader::PositionsFileReader(const std::string& path) {
+    region.openRead(path);
+    ColumnarHeader header;
+    rowCount = readHeader(region, ColumnarFileKind::Positions, path, header);
+    for (std::size_t c = 0; c < 6; ++c) {
+        columns[c] = reinterpret_cast<const double*>(findColumn(region, header, positionColumns[c], path));
+    }
+    const unsigned char* styleBytes = findColumn(region, header, positionColumns[6], path);
+    const unsigned char* typeBytes = findColumn(region, header, positionColumns[7], path);
+
+    // Any byte other than 0 or 1 would be an invalid enum value
+    unsigned char invalid = 0;
+    for (std::size_t i = 0; i < rowCount; ++i) {
+        invalid |= (styleBytes[i] | typeBytes[i]) & 0xfe;
+    }
+    if (invalid) {
+        throw DataFileError(path + " has style or type values out of range");
+    }
+    style = reinterpret_cast<const OptionStyle*>(styleBytes);
+    type = reinterpret_cast<const OptionType*>(typeBytes);
+}
+
+OptionBatch PositionsFileReader::batch(std::size_t first, std::size_t count) const {
+    if (first > rowCount || count > rowCount - first) {
+        throw DataFileError("Row range past the end of the positions file");
+    }
+    OptionBatch view;
+    view.size = count;
+    view.S = columns[0] + first;
+    view.K = columns[1] + first;
+    view.r = columns[2] + first;
+    view.sigma = columns[3] + first;
+    view.expiry = columns[4] + first;
+    view.q = columns[5] + first;
+    view.style = style + first;
+    view.type = type + first;
+    return view;
+}
+
+ResultsFileReader::ResultsFileReader(const std::string& path) {
+    region.openRead(path);
+    ColumnarHeader header;
+    rowCount = readHeader(region, ColumnarFileKind::Results, path, header);
+    for (std::size_t c = 0; c < resultColumnCount; ++c) {
+        columns[c] = reinterpret_cast<const double*>(findColumn(region, header, resultColumns[c], path));
+    }
+}
+
+PricingResult ResultsFileReader::row(std::size_t i) const {
+    PricingResult result;
+    result.price = columns[0][i];
+    result.greeks.delta = columns[1][i];
+    result.greeks.gamma = columns[2][i];
+    result.greeks.theta = columns[3][i];
+    result.greeks.vega = columns[4][i];
+    result.greeks.rho = columns[5][i];
+    return result;
+}
+
+void writePositionsFile(const std::string& path, const OptionBatch& batch) {
+    std::size_t rows = batch.size;
+    FileRegion region;
+    region.create(path, writeLayout(nullptr, ColumnarFileKind::Positions, positionColumns, positionColumnCount, rows));
+    unsigned char* data = region.data();
+    writeLayout(data, ColumnarFileKind::Positions, positionColumns, positionColumnCount, rows);
+
+    const void* sources[] = {batch.S, batch.K, batch.r, batch.sigma, batch.expiry, batch.q, batch.style, batch.type};
+    std::size_t offset = alignUp(sizeof(ColumnarHeader) + positionColumnCount * sizeof(ColumnDescriptor));
+    for (std::size_t c = 0; c < positionColumnCount; ++c) {
+        std::size_t bytes = rows * positionColumns[c].elementSize;
+        if (sources[c]) {
+            std::memcpy(data + offset, sources[c], bytes);
+        } else {
+            std::memset(data + offset, int(OptionType::European), bytes);   // Type column is optional
+        }
+        offset = alignUp(offset + bytes);
+    }
+    region.close();
+}
+
+ResultsFileWriter::ResultsFileWriter(const std::string& path, std::size_t rows) : rowCount(rows) {
+    region.create(path, writeLayout(nullptr, ColumnarFileKind::Results, resultColumns, resultColumnCount, rows));
+    writeLayout(region.data(), ColumnarFileKind::Results, resultColumns, resultColumnCount, rows);
+    std::size_t offset = alignUp(sizeof(ColumnarHeader) + resultColumnCount * sizeof(ColumnDescriptor));
+    for (std::size_t c = 0; c < resultColumnCount; ++c) {
+        columns[c] = reinterpret_cast<double*>(region.data() + offset);
+        offset = alignUp(offset + rows * sizeof(double));
+    }
+}
+
+PricingResultBatch ResultsFileWriter::batch(std::size_t first, std::size_t count) const {
+    if (first > rowCount || count > rowCount - first) {
+        throw DataFileError("Row range past the end of the results file");
+    }
+    return {columns[0] + first, columns[1] + first, columns[2] + first,
+            columns[3] + first, columns[4] + first, columns[5] + first};
+}
@@ -0,0 +1,142 @@
+#ifndef COLUMNAR_FILE_H
+#define COLUMNAR_FILE_H
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versioned columnar file for positions and pricing results. Each column is one contiguous
+// block starting on a 64-byte boundary, so a memory-mapped file is used in place as an
+// OptionBatch or PricingResultBatch with no parsing or copying.
+//
+// Layout, in the byte order of the machine that wrote it:
+//   ColumnarHeader                     64 bytes
+//   ColumnDescriptor[columnCount]      32 bytes each
+//   column blocks                      rows * elementSize bytes each, 64-byte aligned
+//
+// Positions files hold S, K, r, sigma, expiry and q as doubles, and style and type as one
+// byte each holding the OptionStyle and OptionType values. Results files hold price and the
+// five Greeks as doubles. Readers reject other versions and foreign byte orders, and
+// ignore columns they do not know.
+
+enum class ColumnarFileKind : std::uint32_t { Positions = 1, Results = 2 };
+
+enum class ColumnId : std::uint32_t {
+    S, K, r, sigma, expiry, q, style, type,
+    price, delta, gamma, theta, vega, rho
+};
+
+struct ColumnarHeader {
+    char magic[8];                  // "OPTCOLS" and a terminating zero
+    std::uint32_t version;
+    std::uint32_t kind;             // ColumnarFileKind
+    std::uint64_t rows;
+    std::uint32_t columnCount;
+    std::uint32_t byteOrder;        // columnarByteOrderMark as written
+    std::uint8_t reserved[32];
+};
+
+struct ColumnDescriptor {
+    std::uint32_t column;           // ColumnId
+    std::uint32_t elementSize;
+    std::uint64_t offset;           // From the start of the file
+    std::uint64_t bytes;
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(ColumnarHeader) == 64, "ColumnarHeader must be 64 bytes");
+static_assert(sizeof(ColumnDescriptor) == 32, "ColumnDescriptor must be 32 bytes");
+
+constexpr std::uint32_t columnarFormatVersion = 1;
+constexpr std::uint32_t columnarByteOrderMark = 0x01020304;
+constexpr std::size_t columnarAlignment = 64;
+
+// File contents mapped into memory, or read into a buffer where mapping is unavailable
+class FileRegion {
+    void* address = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+    std::vector<std::uint64_t> buffer;   // Fallback storage, also used for empty files
+    std::string path;                    // Fallback writers save the buffer here on close
+    bool writable = false;
+
+public:
+    FileRegion() = default;
+    ~FileRegion();
+    FileRegion(const FileRegion&) = delete;
+    FileRegion& operator=(const FileRegion&) = delete;
+
+    // Maps an existing file read-only
+    void openRead(const std::string& path);
+    // Creates or truncates a file of the given size and maps it read-write. Where the
+    // filesystem allows, its blocks are reserved up front, so a full disk throws here.
+    void create(const std::string& path, std::size_t size);
+    // Writes back and releases the region. Throws DataFileError when writing fails.
+    void close();
+
+    unsigned char* data() { return static_cast<unsigned char*>(address); }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(address); }
+    std::size_t size() const { return length; }
+};
+
+// Read-only view of a positions file
+class PositionsFileReader {
+    FileRegion region;
+    std::size_t rowCount = 0;
+    const double* columns[6] = {};   // S, K, r, sigma, expiry, q
+    const OptionStyle* style = nullptr;
+    const OptionType* type = nullptr;
+
+public:
+    // Maps path and checks its header, column table and enum columns. Throws
+    // DataFileError when the file is not a valid positions file.
+    explicit PositionsFileReader(const std::string& path);
+
+    std::size_t size() const { return rowCount; }
+
+    // Rows [first, first + count) as a batch pointing into the mapping
+    OptionBatch batch(std::size_t first, std::size_t count) const;
+    OptionBatch batch() const { return batch(0, rowCount); }
+};
+
+// Read-only view of a results file
+class ResultsFileReader {
+    FileRegion region;
+    std::size_t rowCount = 0;
+    const double* columns[6] = {};   // price, delta, gamma, theta, vega, rho
+
+public:
+    explicit ResultsFileReader(const std::string& path);
+
+    std::size_t size() const { return rowCount; }
+
+    PricingResult row(std::size_t i) const;
+};
+
+// Writes a positions file holding batch
+void writePositionsFile(const std::string& path, const OptionBatch& batch);
+
+// Results file of a fixed number of rows, created up front and mapped read-write. The
+// columns returned by batch() are the file itself: pricing into them streams results to
+// disk as pages are written back, and close() completes the file.
+class ResultsFileWriter {
+    FileRegion region;
+    std::size_t rowCount = 0;
+    double* columns[6] = {};
+
+public:
+    ResultsFileWriter(const std::string& path, std::size_t rows);
+
+    std::size_t size() const { return rowCount; }
+
+    // Columns for rows [first, first + count)
+    PricingResultBatch batch(std::size_t first, std::size_t count) const;
+    PricingResultBatch batch() const { return batch(0, rowCount); }
+
+    // Writes back the mapping. Called by the destructor, which swallows errors.
+    void close() { region.close(); }
+};
+
+#endif // COLUMNAR_FILE_H
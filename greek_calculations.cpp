@@ -1,6 +1,9 @@
 #include "greek_calculations.h"
 #include "math_utils.h"
+#include "instrumentation.h"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 Greeks calculateGreeksBS(const OptionParameters& params) {
     long double S = params.S;
@@ -16,9 +19,9 @@ Greeks calculateGreeksBS(const OptionParameters& params) {
     long double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * time) / sigmaSqrtT;
     long double d2 = d1 - sigmaSqrtT;
 
-    long double nd1 = normalCDF(d1);
+    long double pd1;
+    long double nd1 = normalCDF(d1, pd1);
     long double nd2 = normalCDF(d2);
-    long double pd1 = normalPDF(d1);
 
     long double expQT = std::exp(-q * time);
     long double expRT = std::exp(-r * time);
@@ -66,59 +69,99 @@ Greeks calculateGreeksBS(const OptionParameters& params) {
     return greeks;
 }
 
+namespace {
+
+// Bump sizes for finite-difference Greeks
+struct FiniteDiffBumps {
+    double h;       // Step for delta/gamma
+    double dt;      // One day for theta, or half the expiry when that is shorter
+    double dvol;    // Step for vega
+    double dr;      // Step for rho
+
+    explicit FiniteDiffBumps(const OptionParameters& params)
+        : h(params.S * 0.0001), dt(std::min(1.0 / 365.0, params.expiry / 2.0)), dvol(0.0001), dr(0.0001) {}
+};
+
+// Order of the scenarios built for one option
+enum FiniteDiffScenario { Base, SpotUp, SpotDown, ExpiryDown, VolUp, RateUp };
+
+void buildScenarios(const OptionParameters& params, OptionParameters* scenarios) {
+    FiniteDiffBumps bumps(params);
+    for (int k = 0; k < finiteDiffScenarioCount; ++k) {
+        scenarios[k] = params;
+    }
+    scenarios[SpotUp].S += bumps.h;
+    scenarios[SpotDown].S -= bumps.h;
+    scenarios[ExpiryDown].expiry -= bumps.dt;
+    scenarios[VolUp].sigma += bumps.dvol;
+    scenarios[RateUp].r += bumps.dr;
+}
+
+Greeks greeksFromScenarios(const OptionParameters& params, const double* prices) {
+    FiniteDiffBumps bumps(params);
+    Greeks greeks;
+
+    // Central differences in spot
+    greeks.delta = (prices[SpotUp] - prices[SpotDown]) / (2.0 * bumps.h);
+    greeks.gamma = (prices[SpotUp] - 2.0 * prices[Base] + prices[SpotDown]) / (bumps.h * bumps.h);
+
+    // Reported positive for decaying value, as by the pricing models
+    greeks.theta = (prices[Base] - prices[ExpiryDown]) / bumps.dt;
+
+    // Forward differences for vega and rho
+    greeks.vega = (prices[VolUp] - prices[Base]) / bumps.dvol;
+    greeks.rho = (prices[RateUp] - prices[Base]) / bumps.dr;
+    return greeks;
+}
+
+} // namespace
+
 Greeks calculateGreeksFD(const OptionParameters& params, 
                         const std::function<double(const OptionParameters&)>& pricingFunction) {
-    Greeks greeks;
-    const double h = params.S * 0.0001;    // Step for delta/gamma
-    const double dt = 1.0 / 365.0;         // One day for theta
-    const double dvol = 0.0001;            // Step for vega
-    const double dr = 0.0001;              // Step for rho
-
-    // Lambda for calculating finite difference
-    auto calculateFiniteDiff = [&](auto& paramMod, double step, auto modifyParam) {
-        OptionParameters upParam = params;
-        modifyParam(upParam, step);
-        return (pricingFunction(upParam) - pricingFunction(params)) / step;
-    };
-
-    // Lambda for central difference
-    auto calculateCentralDiff = [&](auto& paramMod, double step, auto modifyParam) {
-        OptionParameters upParam = params;
-        OptionParameters downParam = params;
-        modifyParam(upParam, step);
-        modifyParam(downParam, -step);
-        return (pricingFunction(upParam) - pricingFunction(downParam)) / (2.0 * step);
-    };
-
-    // Calculate price at current parameters
-    double priceMiddle = pricingFunction(params);
-
-    // Delta calculation using central difference
-    greeks.delta = calculateCentralDiff(params.S, h, 
-        [](OptionParameters& p, double step) { p.S += step; });
-
-    // Gamma calculation
-    auto upDelta = calculateFiniteDiff(params.S, h, 
-        [](OptionParameters& p, double step) { p.S += step; });
-    auto downDelta = calculateFiniteDiff(params.S, -h, 
-        [](OptionParameters& p, double step) { p.S += step; });
-    greeks.gamma = (upDelta - downDelta) / (2.0 * h);
-
-    // Theta calculation
-    if (params.expiry > 0.0) {
-        greeks.theta = -calculateFiniteDiff(params.expiry, -dt,
-            [](OptionParameters& p, double step) { p.expiry += step; });
-    } else {
-        greeks.theta = 0.0;
+    OptionParameters scenarios[finiteDiffScenarioCount];
+    double prices[finiteDiffScenarioCount];
+    buildScenarios(params, scenarios);
+    {
+        OPTION_PRICING_PROBE(Probe::GreeksBump);
+        OPTION_PRICING_RECORD(recordGreeksBumps(finiteDiffScenarioCount - 1));
+        for (int k = 0; k < finiteDiffScenarioCount; ++k) {
+            prices[k] = pricingFunction(scenarios[k]);
+        }
     }
+    return greeksFromScenarios(params, prices);
+}
 
-    // Vega calculation
-    greeks.vega = calculateFiniteDiff(params.sigma, dvol,
-        [](OptionParameters& p, double step) { p.sigma += step; });
+void calculateGreeksFDBatch(const OptionParameters* options, std::size_t count, Greeks* greeks,
+                            const BatchPricingFunction& pricingBatch) {
+    std::size_t rows = count * finiteDiffScenarioCount;
+    std::vector<OptionParameters> scenarios(rows);
+    for (std::size_t i = 0; i < count; ++i) {
+        buildScenarios(options[i], &scenarios[i * finiteDiffScenarioCount]);
+    }
 
-    // Rho calculation
-    greeks.rho = calculateFiniteDiff(params.r, dr,
-        [](OptionParameters& p, double step) { p.r += step; });
+    // Columnar copy of all scenarios for the callback
+    std::vector<double> S(rows), K(rows), r(rows), q(rows), sigma(rows), expiry(rows), prices(rows);
+    std::vector<OptionStyle> style(rows);
+    std::vector<OptionType> type(rows);
+    for (std::size_t j = 0; j < rows; ++j) {
+        S[j] = scenarios[j].S;
+        K[j] = scenarios[j].K;
+        r[j] = scenarios[j].r;
+        q[j] = scenarios[j].q;
+        sigma[j] = scenarios[j].sigma;
+        expiry[j] = scenarios[j].expiry;
+        style[j] = scenarios[j].style;
+        type[j] = scenarios[j].type;
+    }
+    OptionBatch batch{rows, S.data(), K.data(), r.data(), q.data(), sigma.data(), expiry.data(),
+                      style.data(), type.data()};
+    {
+        OPTION_PRICING_PROBE(Probe::GreeksBump);
+        OPTION_PRICING_RECORD(recordGreeksBumps(count * (finiteDiffScenarioCount - 1)));
+        pricingBatch(batch, prices.data());
+    }
 
-    return greeks;
+    for (std::size_t i = 0; i < count; ++i) {
+        greeks[i] = greeksFromScenarios(options[i], &prices[i * finiteDiffScenarioCount]);
+    }
 }
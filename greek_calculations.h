@@ -6,7 +6,19 @@
 
 Greeks calculateGreeksBS(const OptionParameters& params);
 
+// Finite-difference Greeks: base, spot up/down, expiry down one day (half the expiry when
+// that is shorter), volatility up and rate up, each priced exactly once
+constexpr int finiteDiffScenarioCount = 6;
+
 Greeks calculateGreeksFD(const OptionParameters& params, 
                          const std::function<double(const OptionParameters&)>& pricingFunction);
 
+// Prices every row of scenarios into prices[0 .. scenarios.size)
+using BatchPricingFunction = std::function<void(const OptionBatch& scenarios, double* prices)>;
+
+// Builds the finiteDiffScenarioCount scenarios of all count options up front and prices them
+// with one call to pricingBatch, so the bumps can be vectorized or run in parallel
+void calculateGreeksFDBatch(const OptionParameters* options, std::size_t count, Greeks* greeks,
+                            const BatchPricingFunction& pricingBatch);
+
 #endif // GREEK_CALCULATIONS_H
\ No newline at end of file
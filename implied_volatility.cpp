@@ -0,0 +1,367 @@
+#include "option_pricing.h"
+#include "static_pricing.h"
+#include "math_utils.h"
+#include "pricing_exceptions.h"
+#include "vector_math.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+// Volatility used where inputs are validated before sigma is known
+constexpr double placeholderVolatility = 0.2;
+
+// Bounds for the initial guess
+constexpr double minGuess = 1e-3;
+constexpr double maxGuess = 5.0;
+
+constexpr int maxHouseholderIterations = 64;
+
+// Householder iterations run unconditionally by the batch kernel before checking
+// convergence; lanes still moving afterwards are finished by the scalar solver
+constexpr int batchIterations = 5;
+
+constexpr int maxBracketIterations = 200;
+
+template<typename T>
+OptionParametersT<T> withVolatility(OptionParametersT<T> params, T sigma) {
+    params.sigma = sigma;
+    return params;
+}
+
+// Discounted spot and strike with the no-arbitrage price range they imply
+template<typename T>
+struct QuoteBoundsT {
+    T spot;
+    T strike;
+    T lower;
+    T upper;
+};
+
+template<typename T>
+QuoteBoundsT<T> quoteBounds(const OptionParametersT<T>& params) {
+    QuoteBoundsT<T> bounds;
+    bounds.spot = params.S * std::exp(-params.q * params.expiry);
+    bounds.strike = params.K * std::exp(-params.r * params.expiry);
+    if (params.style == OptionStyle::Call) {
+        bounds.lower = std::max(bounds.spot - bounds.strike, T(0));
+        bounds.upper = bounds.spot;
+    } else {
+        bounds.lower = std::max(bounds.strike - bounds.spot, T(0));
+        bounds.upper = bounds.strike;
+    }
+    return bounds;
+}
+
+// Corrado & Miller (1996) closed-form estimate from the call-equivalent price
+template<typename T>
+T corradoMillerGuess(T callPrice, T spot, T strike, T expiry) {
+    T gap = spot - strike;
+    T a = callPrice - T(0.5) * gap;
+    T discriminant = std::max(a * a - gap * gap / T(M_PI), T(0));
+    T total = std::sqrt(T(2) * T(M_PI)) / (spot + strike) * (a + std::sqrt(discriminant));
+    T guess = total / std::sqrt(expiry);
+    return std::isfinite(guess) ? std::min(std::max(guess, T(minGuess)), T(maxGuess)) : T(placeholderVolatility);
+}
+
+// Third-order Householder step for f(sigma) = model - target. gamma and delta are the second
+// and third sigma-derivatives of the Black-Scholes price over vega, both functions of d1, d2.
+template<typename T>
+T householderStep(T diff, T vega, T d1, T d2, T sigma) {
+    T nu = -diff / vega;
+    T gamma = d1 * d2 / sigma;
+    T delta = (d1 * d1 * d2 * d2 - d1 * d2 - d1 * d1 - d2 * d2) / (sigma * sigma);
+    return nu * (T(1) + T(0.5) * gamma * nu) / (T(1) + nu * (gamma + delta * nu / T(6)));
+}
+
+template<typename T, OptionStyle Style>
+T solveBlackScholesVolatility(const OptionParametersT<T>& params, T price, T sigma, T scale) {
+    T sqrtT = std::sqrt(params.expiry);
+    T moneyness = std::log(params.S / params.K) + (params.r - params.q) * params.expiry;
+
+    // The price rises with sigma, so every evaluation narrows a bracket for the root
+    T lo = T(0);
+    T hi = std::numeric_limits<T>::infinity();
+
+    for (int iteration = 0; iteration < maxHouseholderIterations; ++iteration) {
+        PricingResultT<T> value = BlackScholesKernelT<T>::template evaluate<Style>(withVolatility(params, sigma));
+        T diff = value.price - price;
+        // Within rounding of the price itself, which is on the order of eps * scale
+        if (std::abs(diff) <= T(4) * std::numeric_limits<T>::epsilon() * scale) {
+            return sigma;
+        }
+        (diff > T(0) ? hi : lo) = sigma;
+
+        T sigmaSqrtT = sigma * sqrtT;
+        T d1 = moneyness / sigmaSqrtT + T(0.5) * sigmaSqrtT;
+        T d2 = d1 - sigmaSqrtT;
+        T next = sigma + householderStep(diff, value.greeks.vega, d1, d2, sigma);
+
+        // Fall back to bisection (or doubling while unbounded) when the step leaves the bracket
+        if (!(next > lo && next < hi)) {
+            next = std::isinf(hi) ? T(2) * sigma : T(0.5) * (lo + hi);
+        }
+        if (std::abs(next - sigma) <= T(4) * std::numeric_limits<T>::epsilon() * sigma) {
+            return next;
+        }
+        sigma = next;
+    }
+    throw NumericalError("Implied volatility did not converge");
+}
+
+template<typename T>
+T blackScholesVolatility(const OptionParametersT<T>& params, T price) {
+    validateOptionParametersT(withVolatility(params, T(placeholderVolatility)));
+
+    QuoteBoundsT<T> bounds = quoteBounds(params);
+    if (!(price > bounds.lower && price < bounds.upper)) {
+        throw OptionPricingError("Option price is outside the no-arbitrage bounds");
+    }
+
+    T callPrice = params.style == OptionStyle::Call ? price : price + bounds.spot - bounds.strike;
+    T guess = corradoMillerGuess(callPrice, bounds.spot, bounds.strike, params.expiry);
+    if (params.style == OptionStyle::Call) {
+        return solveBlackScholesVolatility<T, OptionStyle::Call>(params, price, guess, bounds.upper);
+    }
+    return solveBlackScholesVolatility<T, OptionStyle::Put>(params, price, guess, bounds.upper);
+}
+
+template<typename T>
+T blackScholesVolatilityOrNaN(const OptionParametersT<T>& params, T price) {
+    try {
+        return blackScholesVolatility(params, price);
+    } catch (const std::exception&) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+}
+
+template<typename T>
+OptionParametersT<T> batchQuote(const OptionBatchT<T>& batch, std::size_t i) {
+    OptionParametersT<T> params;
+    params.S = batch.S[i];
+    params.K = batch.K[i];
+    params.r = batch.r[i];
+    params.q = batch.q[i];
+    params.sigma = T(placeholderVolatility);
+    params.expiry = batch.expiry[i];
+    params.style = batch.style[i];
+    params.type = OptionType::European;
+    return params;
+}
+
+#if OPTION_PRICING_HAS_SIMD
+// Runs batchIterations safeguarded Householder steps for one lane group, branch-free. vols
+// receives the estimates and steps the size of the last step, for the convergence check.
+inline void impliedVolatilityPacked(const double* S_, const double* K_, const double* r_, const double* q_,
+                                    const double* expiry_, const double* sign_, const double* price_,
+                                    double* vols, double* steps, double* valid) {
+    PackedDouble S = packedLoad(S_);
+    PackedDouble K = packedLoad(K_);
+    PackedDouble r = packedLoad(r_);
+    PackedDouble q = packedLoad(q_);
+    PackedDouble time = packedLoad(expiry_);
+    PackedDouble sign = packedLoad(sign_);
+    PackedDouble price = packedLoad(price_);
+    PackedDouble zero = packedSet(0.0);
+    PackedDouble one = packedSet(1.0);
+
+    PackedDouble spot = S * packedExp(-q * time);
+    PackedDouble strike = K * packedExp(-r * time);
+    PackedMask isCall = packedGreater(sign, zero);
+    PackedDouble lower = packedMax(sign * (spot - strike), zero);
+    PackedDouble upper = packedSelect(isCall, spot, strike);
+    packedStore(valid, packedSelect(packedGreater(price, lower), packedSelect(packedLess(price, upper), one, zero), zero));
+
+    // Corrado-Miller guess from the call-equivalent price
+    PackedDouble sqrtT = packedSqrt(time);
+    PackedDouble gap = spot - strike;
+    PackedDouble callPrice = packedSelect(isCall, price, price + gap);
+    PackedDouble a = callPrice - packedSet(0.5) * gap;
+    PackedDouble discriminant = packedMax(a * a - gap * gap * packedSet(1.0 / M_PI), zero);
+    PackedDouble sigma = packedSet(std::sqrt(2.0 * M_PI)) * (a + packedSqrt(discriminant)) / ((spot + strike) * sqrtT);
+    sigma = packedMin(packedMax(sigma, packedSet(minGuess)), packedSet(maxGuess));
+
+    PackedDouble moneyness = packedLog(S / K) + (r - q) * time;
+    PackedDouble lo = zero;
+    PackedDouble hi = packedSet(std::numeric_limits<double>::max());
+    PackedDouble step = zero;
+    PackedDouble tolerance = packedSet(4.0 * std::numeric_limits<double>::epsilon()) * upper;
+
+    for (int iteration = 0; iteration < batchIterations; ++iteration) {
+        PackedDouble sigmaSqrtT = sigma * sqrtT;
+        PackedDouble d1 = moneyness / sigmaSqrtT + packedSet(0.5) * sigmaSqrtT;
+        PackedDouble d2 = d1 - sigmaSqrtT;
+        PackedDouble pd1;
+        PackedDouble model = sign * (spot * packedNormalCDF(sign * d1, pd1) - strike * packedNormalCDF(sign * d2));
+        PackedDouble vega = spot * pd1 * sqrtT;
+        PackedDouble diff = model - price;
+
+        PackedMask above = packedGreater(diff, zero);
+        hi = packedSelect(above, sigma, hi);
+        lo = packedSelect(above, lo, sigma);
+
+        PackedDouble nu = -diff / vega;
+        PackedDouble gamma = d1 * d2 / sigma;
+        PackedDouble delta = (d1 * d1 * d2 * d2 - d1 * d2 - d1 * d1 - d2 * d2) / (sigma * sigma);
+        PackedDouble next = sigma + nu * (one + packedSet(0.5) * gamma * nu) /
+                                    (one + nu * (gamma + delta * nu * packedSet(1.0 / 6.0)));
+
+        // Bisect (or double while unbounded) when the step leaves the bracket or is NaN
+        PackedDouble fallback = packedSelect(packedLess(hi, packedSet(std::numeric_limits<double>::max())),
+                                             packedSet(0.5) * (lo + hi), packedSet(2.0) * sigma);
+        next = packedSelect(packedGreater(next, lo), next, fallback);
+        next = packedSelect(packedLess(next, hi), next, fallback);
+
+        // Lanes already within rounding of the quote stay where they are
+        PackedMask settled = packedLess(packedAbs(diff), tolerance);
+        next = packedSelect(settled, sigma, next);
+
+        step = packedAbs(next - sigma);
+        sigma = next;
+    }
+    packedStore(vols, sigma);
+    packedStore(steps, step);
+}
+#endif
+
+} // namespace
+
+template<typename T>
+T BlackScholesModelT<T>::impliedVolatility(const OptionParametersT<T>& params, T price) const {
+    return blackScholesVolatility(params, price);
+}
+
+template<typename T>
+void BlackScholesModelT<T>::impliedVolatilityBatch(const OptionBatchT<T>& batch, const T* prices, T* vols) const {
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same_v<T, double>) {
+        constexpr int W = PackedDouble::width;
+        alignas(64) double in[6][W];
+        alignas(64) double sign[W];
+        alignas(64) double price[W];
+        alignas(64) double sigma[W];
+        alignas(64) double step[W];
+        alignas(64) double valid[W];
+
+        for (std::size_t first = 0; first < batch.size; first += W) {
+            std::size_t count = std::min<std::size_t>(W, batch.size - first);
+            for (int j = 0; j < W; ++j) {
+                // Unused lanes of the last group price a harmless at-the-money option
+                bool live = std::size_t(j) < count;
+                std::size_t i = first + j;
+                in[0][j] = live ? batch.S[i] : 1.0;
+                in[1][j] = live ? batch.K[i] : 1.0;
+                in[2][j] = live ? batch.r[i] : 0.0;
+                in[3][j] = live ? batch.q[i] : 0.0;
+                in[4][j] = live ? batch.expiry[i] : 1.0;
+                sign[j] = live && batch.style[i] == OptionStyle::Put ? -1.0 : 1.0;
+                price[j] = live ? prices[i] : 0.1;
+            }
+            impliedVolatilityPacked(in[0], in[1], in[2], in[3], in[4], sign, price, sigma, step, valid);
+
+            for (std::size_t j = 0; j < count; ++j) {
+                OptionParametersT<T> params = batchQuote(batch, first + j);
+                bool accepted = valid[j] != 0.0 && std::isfinite(sigma[j]) &&
+                                step[j] <= 64.0 * std::numeric_limits<double>::epsilon() * sigma[j] &&
+                                params.S > 0.0 && params.K > 0.0 && params.r >= 0.0 && params.q >= 0.0 &&
+                                params.expiry > 0.0 && std::isfinite(params.S) && std::isfinite(params.K) &&
+                                std::isfinite(params.r) && std::isfinite(params.q) && std::isfinite(params.expiry);
+                vols[first + j] = accepted ? sigma[j] : blackScholesVolatilityOrNaN(params, prices[first + j]);
+            }
+        }
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        vols[i] = blackScholesVolatilityOrNaN(batchQuote(batch, i), prices[i]);
+    }
+}
+
+template<typename T>
+T BinomialModelT<T>::impliedVolatility(const OptionParametersT<T>& params, T price) const {
+    validateOptionParametersT(withVolatility(params, T(placeholderVolatility)));
+
+    T upper = params.style == OptionStyle::Call ? params.S : params.K;
+    if (!(price < upper)) {
+        throw OptionPricingError("Option price is outside the no-arbitrage bounds");
+    }
+
+    // Below this volatility the CRR up-move probability leaves [0, 1]
+    T floor = std::max(T(1e-4), T(1.01) * std::abs(params.r - params.q) * std::sqrt(params.expiry / T(steps)));
+    T ceiling = T(10);
+
+    BinomialWorkspaceT<T>& workspace = threadWorkspace();
+    auto excess = [&](T sigma) { return calculatePrice(withVolatility(params, sigma), workspace) - price; };
+
+    // Seed with the Black-Scholes volatility of the same quote when it has one: the early
+    // exercise premium is usually small, so the root lies close by
+    T seed = T(placeholderVolatility);
+    QuoteBoundsT<T> bounds = quoteBounds(params);
+    if (price > bounds.lower && price < bounds.upper) {
+        seed = std::min(std::max(blackScholesVolatility(params, price), floor), ceiling);
+    }
+
+    // Grow a bracket [lo, hi] around the seed
+    T lo = std::max(floor, seed * T(0.9));
+    T hi = std::min(ceiling, seed * T(1.1));
+    T fLo = excess(lo);
+    T fHi = excess(hi);
+    while (fLo > T(0) && lo > floor) {
+        hi = lo;
+        fHi = fLo;
+        lo = std::max(floor, lo * T(0.5));
+        fLo = excess(lo);
+    }
+    while (fHi < T(0) && hi < ceiling) {
+        lo = hi;
+        fLo = fHi;
+        hi = std::min(ceiling, hi * T(2));
+        fHi = excess(hi);
+    }
+    if (fLo > T(0) || fHi < T(0)) {
+        throw OptionPricingError("No volatility reproduces the option price");
+    }
+
+    // Illinois variant of regula falsi: halves the weight of an endpoint that is kept twice
+    int side = 0;
+    for (int iteration = 0; iteration < maxBracketIterations; ++iteration) {
+        T sigma = lo - fLo * (hi - lo) / (fHi - fLo);
+        T f = excess(sigma);
+        if (std::abs(f) <= T(1e-12) * price || hi - lo <= T(1e-12) * hi) {
+            return sigma;
+        }
+        if (f > T(0)) {
+            hi = sigma;
+            fHi = f;
+            if (side == 1) {
+                fLo *= T(0.5);
+            }
+            side = 1;
+        } else {
+            lo = sigma;
+            fLo = f;
+            if (side == -1) {
+                fHi *= T(0.5);
+            }
+            side = -1;
+        }
+    }
+    throw NumericalError("Implied volatility did not converge");
+}
+
+template<typename T>
+T impliedVolatilityT(const OptionParametersT<T>& params, T price, int steps) {
+    if (params.type == OptionType::American) {
+        return BinomialModelT<T>(steps).impliedVolatility(params, price);
+    }
+    return BlackScholesModelT<T>().impliedVolatility(params, price);
+}
+
+// Explicit instantiations
+template double BlackScholesModelT<double>::impliedVolatility(const OptionParameters&, double) const;
+template void BlackScholesModelT<double>::impliedVolatilityBatch(const OptionBatch&, const double*, double*) const;
+template double BinomialModelT<double>::impliedVolatility(const OptionParameters&, double) const;
+template double impliedVolatilityT<double>(const OptionParameters&, double, int);
@@ -0,0 +1,367 @@
+#include "instrumentation.h"
+#include "pricing_exceptions.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+int LatencyHistogram::bucketFor(std::uint64_t nanoseconds) {
+    if (nanoseconds < 4) {
+        return int(nanoseconds);
+    }
+    int octave = 0;
+#if defined(__GNUC__)
+    octave = 63 - __builtin_clzll(nanoseconds);
+#else
+    for (std::uint64_t v = nanoseconds; v > 1; v >>= 1) {
+        ++octave;
+    }
+#endif
+    // The two bits below the leading one pick the bucket within the octave
+    int bucket = octave * subBuckets + int((nanoseconds >> (octave - 2)) & 3);
+    return bucket < bucketCount ? bucket : bucketCount - 1;
+}
+
+double LatencyHistogram::upperBound(int bucket) {
+    if (bucket < 2 * subBuckets) {
+        return double(bucket < 4 ? bucket + 1 : 4);   // Exact buckets for 0-3 ns; 4-7 stay empty
+    }
+    int octave = bucket / subBuckets;
+    int sub = bucket % subBuckets;
+    return double(std::uint64_t(subBuckets + sub + 1) << (octave - 2));
+}
+
+std::uint64_t LatencyHistogram::total() const {
+    std::uint64_t sum = 0;
+    for (std::uint64_t count : counts) {
+        sum += count;
+    }
+    return sum;
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+    std::uint64_t samples = total();
+    if (samples == 0) {
+        return 0.0;
+    }
+    double rank = fraction * double(samples);
+    std::uint64_t seen = 0;
+    for (int b = 0; b < bucketCount; ++b) {
+        seen += counts[b];
+        if (double(seen) >= rank && counts[b] > 0) {
+            return upperBound(b);
+        }
+    }
+    return upperBound(bucketCount - 1);
+}
+
+const char* probeName(Probe probe) {
+    switch (probe) {
+        case Probe::EnginePrice: return "engine price";
+        case Probe::Validate: return "validate";
+        case Probe::TreeBuild: return "tree build";
+        case Probe::GreeksBump: return "greeks bumps";
+    }
+    return "unknown";
+}
+
+const char* exceptionKindName(ExceptionKind kind) {
+    switch (kind) {
+        case ExceptionKind::NumericalError: return "NumericalError";
+        case ExceptionKind::DataFileError: return "DataFileError";
+        case ExceptionKind::OptionPricingError: return "OptionPricingError";
+        case ExceptionKind::InputValidationError: return "InputValidationError";
+        case ExceptionKind::Other: return "other";
+    }
+    return "unknown";
+}
+
+namespace {
+
+constexpr int maxModels = 16;   // The last slot collects any further models
+
+using Counter = std::atomic<std::uint64_t>;
+
+struct TimedCounters {
+    Counter calls;
+    Counter nanoseconds;
+    Counter latency[LatencyHistogram::bucketCount];
+};
+
+// Counters of one thread. Zero-initialized by value-initialization.
+struct ThreadBlock {
+    TimedCounters probes[probeCount];
+    TimedCounters models[maxModels];
+    Counter exceptions[exceptionKindCount];
+    Counter trees;
+    Counter treeLanes;
+    Counter treeSteps;
+    Counter greeksBumps;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBlock>> blocks;
+    std::vector<const std::type_info*> models;
+};
+
+// Never destroyed, so threads that outlive static destruction can still record
+Registry& registry() {
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+#if OPTION_PRICING_INSTRUMENTATION
+// Only the owning thread writes a block, so a load and a store make a lock-free increment
+inline void add(Counter& counter, std::uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void addTimed(TimedCounters& counters, std::uint64_t nanoseconds) {
+    add(counters.calls, 1);
+    add(counters.nanoseconds, nanoseconds);
+    add(counters.latency[LatencyHistogram::bucketFor(nanoseconds)], 1);
+}
+
+ThreadBlock& threadBlock() {
+    thread_local ThreadBlock* block = [] {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.blocks.push_back(std::unique_ptr<ThreadBlock>(new ThreadBlock()));
+        return shared.blocks.back().get();
+    }();
+    return *block;
+}
+
+// Slot of a model type. Each thread caches the slots it has seen, so the registry lock is
+// only taken the first time a thread meets a model.
+int modelSlot(const std::type_info& model) {
+    thread_local const std::type_info* seen[maxModels] = {};
+    thread_local int seenSlots[maxModels];
+    thread_local int seenCount = 0;
+    for (int i = 0; i < seenCount; ++i) {
+        if (*seen[i] == model) {
+            return seenSlots[i];
+        }
+    }
+
+    int slot = maxModels - 1;
+    {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        int known = int(shared.models.size());
+        for (int i = 0; i < known; ++i) {
+            if (*shared.models[i] == model) {
+                slot = i;
+            }
+        }
+        if (slot == maxModels - 1 && known < maxModels - 1) {
+            shared.models.push_back(&model);
+            slot = known;
+        }
+    }
+    if (seenCount < maxModels) {
+        seen[seenCount] = &model;
+        seenSlots[seenCount] = slot;
+        ++seenCount;
+    }
+    return slot;
+}
+#endif
+
+std::string typeName(const std::type_info& type) {
+#if defined(__GNUG__)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status),
+                                                     std::free);
+    if (status == 0 && demangled) {
+        return demangled.get();
+    }
+#endif
+    return type.name();
+}
+
+void accumulate(ProbeStats& stats, const TimedCounters& counters) {
+    stats.calls += counters.calls.load(std::memory_order_relaxed);
+    stats.nanoseconds += counters.nanoseconds.load(std::memory_order_relaxed);
+    for (int b = 0; b < LatencyHistogram::bucketCount; ++b) {
+        stats.latency.counts[b] += counters.latency[b].load(std::memory_order_relaxed);
+    }
+}
+
+void clear(TimedCounters& counters) {
+    counters.calls.store(0, std::memory_order_relaxed);
+    counters.nanoseconds.store(0, std::memory_order_relaxed);
+    for (Counter& bucket : counters.latency) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string formatDuration(double nanoseconds) {
+    char text[32];
+    if (nanoseconds < 1e3) {
+        std::snprintf(text, sizeof(text), "%.0f ns", nanoseconds);
+    } else if (nanoseconds < 1e6) {
+        std::snprintf(text, sizeof(text), "%.1f us", nanoseconds / 1e3);
+    } else if (nanoseconds < 1e9) {
+        std::snprintf(text, sizeof(text), "%.1f ms", nanoseconds / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.2f s", nanoseconds / 1e9);
+    }
+    return text;
+}
+
+void appendRow(std::string& report, const std::string& name, const ProbeStats& stats) {
+    char line[256];
+    double mean = stats.calls ? double(stats.nanoseconds) / double(stats.calls) : 0.0;
+    std::snprintf(line, sizeof(line), "  %-32s %12llu %10s %10s %10s %10s\n", name.c_str(),
+                  static_cast<unsigned long long>(stats.calls), formatDuration(mean).c_str(),
+                  formatDuration(stats.latency.percentile(0.50)).c_str(),
+                  formatDuration(stats.latency.percentile(0.99)).c_str(),
+                  formatDuration(double(stats.nanoseconds)).c_str());
+    report += line;
+}
+
+} // namespace
+
+#if OPTION_PRICING_INSTRUMENTATION
+
+void recordProbe(Probe probe, std::uint64_t nanoseconds) {
+    addTimed(threadBlock().probes[int(probe)], nanoseconds);
+}
+
+void recordModelCall(const std::type_info& model, std::uint64_t nanoseconds) {
+    ThreadBlock& block = threadBlock();
+    addTimed(block.models[modelSlot(model)], nanoseconds);
+    addTimed(block.probes[int(Probe::EnginePrice)], nanoseconds);
+}
+
+void recordCurrentException() {
+    ExceptionKind kind = ExceptionKind::Other;
+    try {
+        throw;
+    } catch (const NumericalError&) {
+        kind = ExceptionKind::NumericalError;
+    } catch (const DataFileError&) {
+        kind = ExceptionKind::DataFileError;
+    } catch (const OptionPricingError&) {
+        kind = ExceptionKind::OptionPricingError;
+    } catch (const InputValidationError&) {
+        kind = ExceptionKind::InputValidationError;
+    } catch (...) {
+    }
+    add(threadBlock().exceptions[int(kind)], 1);
+}
+
+void recordTree(int steps, int lanes) {
+    ThreadBlock& block = threadBlock();
+    add(block.trees, 1);
+    add(block.treeLanes, std::uint64_t(lanes));
+    add(block.treeSteps, std::uint64_t(steps));
+}
+
+void recordGreeksBumps(std::uint64_t count) {
+    add(threadBlock().greeksBumps, count);
+}
+
+#endif // OPTION_PRICING_INSTRUMENTATION
+
+InstrumentationSnapshot instrumentationSnapshot() {
+    InstrumentationSnapshot snapshot;
+    snapshot.enabled = OPTION_PRICING_INSTRUMENTATION != 0;
+
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    std::size_t modelCount = shared.models.size();
+    for (std::size_t m = 0; m < modelCount; ++m) {
+        snapshot.models.push_back({typeName(*shared.models[m]), ProbeStats()});
+    }
+    ModelStats others{"other models", ProbeStats()};
+
+    for (const auto& block : shared.blocks) {
+        for (int p = 0; p < probeCount; ++p) {
+            accumulate(snapshot.probes[p], block->probes[p]);
+        }
+        for (std::size_t m = 0; m < modelCount; ++m) {
+            accumulate(snapshot.models[m].stats, block->models[m]);
+        }
+        accumulate(others.stats, block->models[maxModels - 1]);
+        for (int e = 0; e < exceptionKindCount; ++e) {
+            snapshot.exceptions[e] += block->exceptions[e].load(std::memory_order_relaxed);
+        }
+        snapshot.trees += block->trees.load(std::memory_order_relaxed);
+        snapshot.treeLanes += block->treeLanes.load(std::memory_order_relaxed);
+        snapshot.treeSteps += block->treeSteps.load(std::memory_order_relaxed);
+        snapshot.greeksBumps += block->greeksBumps.load(std::memory_order_relaxed);
+    }
+    if (others.stats.calls > 0) {
+        snapshot.models.push_back(others);
+    }
+    return snapshot;
+}
+
+void resetInstrumentation() {
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for (const auto& block : shared.blocks) {
+        for (TimedCounters& counters : block->probes) {
+            clear(counters);
+        }
+        for (TimedCounters& counters : block->models) {
+            clear(counters);
+        }
+        for (Counter& counter : block->exceptions) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (Counter* counter : {&block->trees, &block->treeLanes, &block->treeSteps, &block->greeksBumps}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string formatInstrumentation(const InstrumentationSnapshot& snapshot) {
+    if (!snapshot.enabled) {
+        return "Instrumentation is not compiled in; build with OPTION_PRICING_INSTRUMENTATION=ON.\n";
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "  %-32s %12s %10s %10s %10s %10s\n", "", "calls", "mean", "p50", "p99",
+                  "total");
+    std::string report = "Engine calls by model\n";
+    report += line;
+    for (const ModelStats& model : snapshot.models) {
+        appendRow(report, model.model, model.stats);
+    }
+    report += "Probes\n";
+    report += line;
+    for (int p = 0; p < probeCount; ++p) {
+        appendRow(report, probeName(Probe(p)), snapshot.probes[p]);
+    }
+
+    std::snprintf(line, sizeof(line), "Trees: %llu passes, %llu valuations, %.0f steps per pass\n",
+                  static_cast<unsigned long long>(snapshot.trees),
+                  static_cast<unsigned long long>(snapshot.treeLanes),
+                  snapshot.trees ? double(snapshot.treeSteps) / double(snapshot.trees) : 0.0);
+    report += line;
+    std::snprintf(line, sizeof(line), "Finite-difference bumps: %llu\n",
+                  static_cast<unsigned long long>(snapshot.greeksBumps));
+    report += line;
+
+    report += "Exceptions:";
+    std::uint64_t thrown = 0;
+    for (int e = 0; e < exceptionKindCount; ++e) {
+        if (snapshot.exceptions[e] > 0) {
+            std::snprintf(line, sizeof(line), " %s %llu", exceptionKindName(ExceptionKind(e)),
+                          static_cast<unsigned long long>(snapshot.exceptions[e]));
+            report += line;
+            thrown += snapshot.exceptions[e];
+        }
+    }
+    report += thrown ? "\n" : " none\n";
+    return report;
+}
@@ -0,0 +1,120 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+// Opt-in counters and latency histograms for the pricing hot paths. They are compiled in
+// when OPTION_PRICING_INSTRUMENTATION is 1 (the CMake option of the same name). Otherwise
+// the recording macros expand to nothing, and snapshots come back empty with enabled false.
+//
+// Each thread records into a block of counters of its own, which only that thread writes,
+// with relaxed atomic stores. Recording therefore takes no locks and never contends.
+// Snapshots sum the blocks of all threads, including threads that have since exited.
+
+#ifndef OPTION_PRICING_INSTRUMENTATION
+#define OPTION_PRICING_INSTRUMENTATION 0
+#endif
+
+enum class Probe { EnginePrice, Validate, TreeBuild, GreeksBump };
+constexpr int probeCount = 4;
+
+// Exception types of pricing_exceptions.h, matched most derived first
+enum class ExceptionKind { NumericalError, DataFileError, OptionPricingError, InputValidationError, Other };
+constexpr int exceptionKindCount = 5;
+
+// Log-linear histogram of nanoseconds with four buckets per power of two, so a percentile
+// is reported to within 25%
+struct LatencyHistogram {
+    static constexpr int subBuckets = 4;
+    static constexpr int bucketCount = 44 * subBuckets;   // Up to 2^44 ns, almost five hours
+    std::array<std::uint64_t, bucketCount> counts{};
+
+    static int bucketFor(std::uint64_t nanoseconds);
+    static double upperBound(int bucket);
+
+    std::uint64_t total() const;
+    // Upper bound in nanoseconds of the bucket holding the given fraction of samples
+    double percentile(double fraction) const;
+};
+
+struct ProbeStats {
+    std::uint64_t calls = 0;
+    std::uint64_t nanoseconds = 0;
+    LatencyHistogram latency;
+};
+
+struct ModelStats {
+    std::string model;   // Type name of the model
+    ProbeStats stats;
+};
+
+struct InstrumentationSnapshot {
+    bool enabled = false;
+    std::array<ProbeStats, probeCount> probes;
+    std::vector<ModelStats> models;   // Engine calls per model, in order of first use
+    std::array<std::uint64_t, exceptionKindCount> exceptions{};   // Escaping the engine
+    std::uint64_t trees = 0;          // Lattice passes
+    std::uint64_t treeLanes = 0;      // Valuations in those passes, bumped copies included
+    std::uint64_t treeSteps = 0;      // Time steps summed over passes
+    std::uint64_t greeksBumps = 0;    // Bumped revaluations for finite-difference Greeks
+};
+
+const char* probeName(Probe probe);
+const char* exceptionKindName(ExceptionKind kind);
+
+InstrumentationSnapshot instrumentationSnapshot();
+
+// Zeroes all counters. Counts recorded concurrently with a reset may survive it.
+void resetInstrumentation();
+
+// Multi-line text report
+std::string formatInstrumentation(const InstrumentationSnapshot& snapshot);
+
+#if OPTION_PRICING_INSTRUMENTATION
+
+using InstrumentationClock = std::chrono::steady_clock;
+
+inline std::uint64_t nanosecondsSince(InstrumentationClock::time_point start) {
+    return std::uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(InstrumentationClock::now() - start).count());
+}
+
+void recordProbe(Probe probe, std::uint64_t nanoseconds);
+// Also records the EnginePrice probe
+void recordModelCall(const std::type_info& model, std::uint64_t nanoseconds);
+// Classifies the exception being handled; call from a catch block
+void recordCurrentException();
+void recordTree(int steps, int lanes);
+void recordGreeksBumps(std::uint64_t count);
+
+// Records the time until the end of the enclosing scope
+class ScopedProbe {
+    Probe probe;
+    InstrumentationClock::time_point start;
+
+public:
+    explicit ScopedProbe(Probe probe) : probe(probe), start(InstrumentationClock::now()) {}
+    ~ScopedProbe() { recordProbe(probe, nanosecondsSince(start)); }
+
+    ScopedProbe(const ScopedProbe&) = delete;
+    ScopedProbe& operator=(const ScopedProbe&) = delete;
+};
+
+#define OPTION_PRICING_PROBE_NAME_(line) scopedProbe##line
+#define OPTION_PRICING_PROBE_NAME(line) OPTION_PRICING_PROBE_NAME_(line)
+#define OPTION_PRICING_PROBE(probe) ScopedProbe OPTION_PRICING_PROBE_NAME(__LINE__)(probe)
+#define OPTION_PRICING_RECORD(call) call
+
+#else
+
+#define OPTION_PRICING_PROBE(probe) ((void)0)
+#define OPTION_PRICING_RECORD(call) ((void)0)
+
+#endif // OPTION_PRICING_INSTRUMENTATION
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,297 @@
+#include "live_book.h"
+#include "option_pricing.h"
+#include "math_utils.h"
+#include "vector_math.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+#if OPTION_PRICING_HAS_SIMD
+constexpr std::size_t laneWidth = PackedDouble::width;
+#else
+constexpr std::size_t laneWidth = 1;
+#endif
+
+// Rows repriced per pool task. A tick on a smaller underlying stays on the calling thread,
+// where it finishes sooner than waking the workers would.
+constexpr std::size_t parallelBlock = 8192;
+
+// Valid parameters with one field replaced, so updates are checked with the messages of
+// validateOptionParametersT
+template<typename T>
+OptionParametersT<T> placeholderParameters() {
+    OptionParametersT<T> params;
+    params.S = T(1);
+    params.K = T(1);
+    params.r = T(0);
+    params.q = T(0);
+    params.sigma = T(1);
+    params.expiry = T(1);
+    return params;
+}
+
+} // namespace
+
+template<typename T>
+typename LiveBookT<T>::Underlying& LiveBookT<T>::underlyingAt(std::size_t underlying) {
+    if (underlying >= underlyings.size()) {
+        throw OptionPricingError("Unknown underlying " + std::to_string(underlying));
+    }
+    return underlyings[underlying];
+}
+
+template<typename T>
+std::size_t LiveBookT<T>::addUnderlying(T spot, T rate, T dividendYield) {
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.S = spot;
+    params.r = rate;
+    params.q = dividendYield;
+    validateOptionParametersT(params);
+
+    Underlying u;
+    u.spot = spot;
+    u.rate = rate;
+    u.dividendYield = dividendYield;
+    underlyings.push_back(std::move(u));
+    return underlyings.size() - 1;
+}
+
+template<typename T>
+std::size_t LiveBookT<T>::addPosition(std::size_t underlying, T strike, T expiry, T volatility, OptionStyle style) {
+    Underlying& u = underlyingAt(underlying);
+    OptionParametersT<T> params;
+    params.S = u.spot;
+    params.K = strike;
+    params.r = u.rate;
+    params.q = u.dividendYield;
+    params.sigma = volatility;
+    params.expiry = expiry;
+    validateOptionParametersT(params);
+
+    // A new lane group is padded with copies of the first option, then overwritten row by row
+    std::size_t row = u.size++;
+    if (row % laneWidth == 0) {
+        std::size_t padded = row + laneWidth;
+        for (std::vector<T>* column : {&u.strike, &u.expiry, &u.volatility, &u.sign}) {
+            column->resize(padded);
+        }
+        for (std::vector<T>* column : {&u.logStrike, &u.sqrtT, &u.sigmaSqrtT, &u.inverseSigmaSqrtT, &u.offset,
+                                       &u.strikeDiscount, &u.carry, &u.decay, &u.price, &u.delta, &u.gamma,
+                                       &u.theta, &u.vega, &u.rho}) {
+            column->resize(padded);
+        }
+        std::fill(u.strike.begin() + row, u.strike.end(), strike);
+        std::fill(u.expiry.begin() + row, u.expiry.end(), expiry);
+        std::fill(u.volatility.begin() + row, u.volatility.end(), volatility);
+        std::fill(u.sign.begin() + row, u.sign.end(), T(1));
+    }
+    u.strike[row] = strike;
+    u.expiry[row] = expiry;
+    u.volatility[row] = volatility;
+    u.sign[row] = style == OptionStyle::Put ? T(-1) : T(1);
+
+    std::size_t group = row - row % laneWidth;
+    refresh(u, group, group + laneWidth, All);
+    reprice(u, group, group + laneWidth);
+
+    positions.emplace_back(underlying, row);
+    return positions.size() - 1;
+}
+
+template<typename T>
+void LiveBookT<T>::updateSpot(std::size_t underlying, T spot) {
+    Underlying& u = underlyingAt(underlying);
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.S = spot;
+    validateOptionParametersT(params);
+
+    u.spot = spot;
+    repriceAll(u);
+}
+
+template<typename T>
+void LiveBookT<T>::updateRate(std::size_t underlying, T rate) {
+    Underlying& u = underlyingAt(underlying);
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.r = rate;
+    validateOptionParametersT(params);
+
+    u.rate = rate;
+    refresh(u, 0, u.price.size(), Rate);
+    repriceAll(u);
+}
+
+template<typename T>
+void LiveBookT<T>::updateDividendYield(std::size_t underlying, T dividendYield) {
+    Underlying& u = underlyingAt(underlying);
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.q = dividendYield;
+    validateOptionParametersT(params);
+
+    u.dividendYield = dividendYield;
+    refresh(u, 0, u.price.size(), Dividend);
+    repriceAll(u);
+}
+
+template<typename T>
+void LiveBookT<T>::updateVolatility(std::size_t underlying, T volatility) {
+    Underlying& u = underlyingAt(underlying);
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.sigma = volatility;
+    validateOptionParametersT(params);
+
+    std::fill(u.volatility.begin(), u.volatility.end(), volatility);
+    refresh(u, 0, u.price.size(), Volatility);
+    repriceAll(u);
+}
+
+template<typename T>
+void LiveBookT<T>::updatePositionVolatility(std::size_t position, T volatility) {
+    if (position >= positions.size()) {
+        throw OptionPricingError("Unknown position " + std::to_string(position));
+    }
+    OptionParametersT<T> params = placeholderParameters<T>();
+    params.sigma = volatility;
+    validateOptionParametersT(params);
+
+    Underlying& u = underlyings[positions[position].first];
+    std::size_t row = positions[position].second;
+    std::size_t group = row - row % laneWidth;
+    u.volatility[row] = volatility;
+    refresh(u, row, row + 1, Volatility);
+    reprice(u, group, group + laneWidth);
+}
+
+template<typename T>
+PricingResultT<T> LiveBookT<T>::result(std::size_t position) const {
+    if (position >= positions.size()) {
+        throw OptionPricingError("Unknown position " + std::to_string(position));
+    }
+    const Underlying& u = underlyings[positions[position].first];
+    std::size_t row = positions[position].second;
+    PricingResultT<T> result;
+    result.price = u.price[row];
+    result.greeks.delta = u.delta[row];
+    result.greeks.gamma = u.gamma[row];
+    result.greeks.theta = u.theta[row];
+    result.greeks.vega = u.vega[row];
+    result.greeks.rho = u.rho[row];
+    return result;
+}
+
+template<typename T>
+void LiveBookT<T>::refresh(Underlying& u, std::size_t first, std::size_t last, unsigned terms) {
+    using std::exp;
+    using std::log;
+    using std::sqrt;
+    for (std::size_t i = first; i < last; ++i) {
+        T time = u.expiry[i];
+        if (terms == All) {
+            u.logStrike[i] = log(u.strike[i]);
+            u.sqrtT[i] = sqrt(time);
+        }
+        if (terms & Volatility) {
+            u.sigmaSqrtT[i] = u.volatility[i] * u.sqrtT[i];
+            u.inverseSigmaSqrtT[i] = T(1) / u.sigmaSqrtT[i];
+            u.decay[i] = u.volatility[i] / (T(2) * u.sqrtT[i]);
+        }
+        if (terms & Rate) {
+            u.strikeDiscount[i] = u.strike[i] * exp(-u.rate * time);
+        }
+        if (terms & Dividend) {
+            u.carry[i] = exp(-u.dividendYield * time);
+        }
+        T sigma = u.volatility[i];
+        u.offset[i] = (u.rate - u.dividendYield + T(0.5) * sigma * sigma) * time - u.logStrike[i];
+    }
+}
+
+template<typename T>
+void LiveBookT<T>::repriceAll(Underlying& u) {
+    std::size_t rows = u.price.size();
+    if (rows <= parallelBlock) {
+        reprice(u, 0, rows);
+        return;
+    }
+    WorkStealingPool::shared().run((rows + parallelBlock - 1) / parallelBlock, [&](std::size_t block) {
+        std::size_t first = block * parallelBlock;
+        reprice(u, first, std::min(rows, first + parallelBlock));
+    });
+}
+
+// Prices rows [first, last), a whole number of lane groups, at the underlying's spot. The
+// formulas are those of blackScholesPacked in option_pricing.cpp with the cached terms
+// substituted.
+template<typename T>
+void LiveBookT<T>::reprice(Underlying& u, std::size_t first, std::size_t last) {
+    using std::log;
+    T S = u.spot;
+    T logS = log(S);
+    T inverseS = T(1) / S;
+    T r = u.rate;
+    T q = u.dividendYield;
+
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same_v<T, double>) {
+        PackedDouble spot = packedSet(S);
+        PackedDouble logSpot = packedSet(logS);
+        PackedDouble inverseSpot = packedSet(inverseS);
+        PackedDouble rate = packedSet(r);
+        PackedDouble yield = packedSet(q);
+        for (std::size_t i = first; i < last; i += laneWidth) {
+            PackedDouble sign = packedLoad(&u.sign[i]);
+            PackedDouble sigmaSqrtT = packedLoad(&u.sigmaSqrtT[i]);
+            PackedDouble d1 = (logSpot + packedLoad(&u.offset[i])) * packedLoad(&u.inverseSigmaSqrtT[i]);
+            PackedDouble d2 = d1 - sigmaSqrtT;
+
+            PackedDouble pd1;
+            PackedDouble nd1 = packedNormalCDF(sign * d1, pd1);
+            PackedDouble nd2 = packedNormalCDF(sign * d2);
+
+            PackedDouble carry = packedLoad(&u.carry[i]);
+            PackedDouble spotCarry = spot * carry;
+            PackedDouble spotLeg = spotCarry * nd1;
+            PackedDouble strikeLeg = packedLoad(&u.strikeDiscount[i]) * nd2;
+            PackedDouble scaledDensity = spotCarry * pd1;
+
+            packedStore(&u.price[i], sign * (spotLeg - strikeLeg));
+            packedStore(&u.delta[i], sign * carry * nd1);
+            packedStore(&u.rho[i], sign * packedLoad(&u.expiry[i]) * strikeLeg);
+            packedStore(&u.theta[i], scaledDensity * packedLoad(&u.decay[i]) +
+                                     sign * (rate * strikeLeg - yield * spotLeg));
+            packedStore(&u.gamma[i], scaledDensity * packedLoad(&u.inverseSigmaSqrtT[i]) * inverseSpot * inverseSpot);
+            packedStore(&u.vega[i], scaledDensity * packedLoad(&u.sqrtT[i]));
+        }
+        return;
+    }
+#endif
+
+    for (std::size_t i = first; i < last; ++i) {
+        T sign = u.sign[i];
+        T d1 = (logS + u.offset[i]) * u.inverseSigmaSqrtT[i];
+        T d2 = d1 - u.sigmaSqrtT[i];
+
+        T pd1;
+        T nd1 = normalCDF(sign * d1, pd1);
+        T nd2 = normalCDF(sign * d2);
+
+        T spotCarry = S * u.carry[i];
+        T spotLeg = spotCarry * nd1;
+        T strikeLeg = u.strikeDiscount[i] * nd2;
+        T scaledDensity = spotCarry * pd1;
+
+        u.price[i] = sign * (spotLeg - strikeLeg);
+        u.delta[i] = sign * u.carry[i] * nd1;
+        u.rho[i] = sign * u.expiry[i] * strikeLeg;
+        u.theta[i] = scaledDensity * u.decay[i] + sign * (r * strikeLeg - q * spotLeg);
+        u.gamma[i] = scaledDensity * u.inverseSigmaSqrtT[i] * inverseS * inverseS;
+        u.vega[i] = scaledDensity * u.sqrtT[i];
+    }
+}
+
+// Explicit instantiations
+template class LiveBookT<double>;
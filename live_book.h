@@ -0,0 +1,74 @@
+#ifndef LIVE_BOOK_H
+#define LIVE_BOOK_H
+
+#include "types.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Book of European options kept priced as market data moves. Positions are grouped by
+// underlying, and each caches the Black-Scholes terms that do not depend on spot: sqrt(T),
+// both discount factors, and the strike and drift part of d1. A spot tick then costs two
+// normal CDFs and a few multiplies per option, for the options on that underlying only.
+// Volatility, rate and dividend updates refresh just the cached terms they enter first.
+//
+// Results match BlackScholesModelT::calculate, theta sign included. Updates and reads must
+// not overlap; underlyings with many positions are repriced on WorkStealingPool::shared().
+template<typename T = double>
+class LiveBookT {
+public:
+    // Returns the index of the new underlying. Throws OptionPricingError for invalid data.
+    std::size_t addUnderlying(T spot, T rate, T dividendYield);
+
+    // Adds a European option on underlying, prices it and returns its position index.
+    // Throws OptionPricingError for invalid parameters.
+    std::size_t addPosition(std::size_t underlying, T strike, T expiry, T volatility, OptionStyle style);
+
+    // Each update reprices the positions on underlying and throws OptionPricingError,
+    // leaving the book unchanged, for an invalid value
+    void updateSpot(std::size_t underlying, T spot);
+    void updateRate(std::size_t underlying, T rate);
+    void updateDividendYield(std::size_t underlying, T dividendYield);
+    // Sets the volatility of every position on underlying
+    void updateVolatility(std::size_t underlying, T volatility);
+    // Sets the volatility of one position and reprices only that position
+    void updatePositionVolatility(std::size_t position, T volatility);
+
+    PricingResultT<T> result(std::size_t position) const;
+
+    std::size_t underlyingCount() const { return underlyings.size(); }
+    std::size_t positionCount() const { return positions.size(); }
+
+private:
+    // Cached terms by the market data they depend on
+    enum Terms : unsigned { Volatility = 1, Rate = 2, Dividend = 4, All = 7 };
+
+    // Columns are padded with a harmless option to a whole number of SIMD lane groups
+    struct Underlying {
+        T spot{};
+        T rate{};
+        T dividendYield{};
+        std::size_t size = 0;
+
+        std::vector<T> strike, expiry, volatility, sign;           // sign is -1 for puts
+        std::vector<T> logStrike, sqrtT, sigmaSqrtT, inverseSigmaSqrtT;
+        std::vector<T> offset;            // d1 * sigma sqrt(T) - log(S)
+        std::vector<T> strikeDiscount;    // K exp(-rT)
+        std::vector<T> carry;             // exp(-qT)
+        std::vector<T> decay;             // sigma / (2 sqrt(T))
+        std::vector<T> price, delta, gamma, theta, vega, rho;
+    };
+
+    std::vector<Underlying> underlyings;
+    std::vector<std::pair<std::size_t, std::size_t>> positions;   // Underlying and row
+
+    Underlying& underlyingAt(std::size_t underlying);
+    static void refresh(Underlying& u, std::size_t first, std::size_t last, unsigned terms);
+    static void reprice(Underlying& u, std::size_t first, std::size_t last);
+    static void repriceAll(Underlying& u);
+};
+
+// Type aliases for backward compatibility
+using LiveBook = LiveBookT<double>;
+
+#endif // LIVE_BOOK_H
@@ -2,31 +2,196 @@
 #define MATH_UTILS_H
 
 #include <cmath>
+#include <algorithm>
 
-inline double normalPDF(double x) {
-    return (1.0 / std::sqrt(2.0 * M_PI)) * std::exp(-0.5 * x * x);
+// Templated on the number type so that automatic differentiation types (autodiff.h) pass
+// through; math functions are looked up by ADL
+
+// exp(-x^2 / 2)
+template<typename T>
+inline T gaussianKernel(T x) {
+    using std::exp;
+    return exp(-0.5 * x * x);
+}
+
+// The rounding error of x * x is recovered and applied, which keeps the result within an ulp
+// or two of exact where x * x / 2 is several hundred. A fused multiply-add gives the error
+// directly; otherwise Dekker's product splits x into halves whose products are exact.
+inline double gaussianKernel(double x) {
+    x = std::min(std::abs(x), 40.0);   // exp(-800) is zero; keeps x * x finite
+    double square = x * x;
+#if defined(FP_FAST_FMA)
+    double error = std::fma(x, x, -square);
+#else
+    double split = 134217729.0 * x;    // 2^27 + 1
+    double high = split - (split - x);
+    double low = x - high;
+    double error = ((high * high - square) + 2.0 * high * low) + low * low;
+#endif
+    return std::exp(-0.5 * square) * (1.0 - 0.5 * error);
+}
+
+template<typename T>
+inline T normalPDF(T x) {
+    return 0.39894228040143267794 * gaussianKernel(x);
+}
+
+// Normal CDF, also storing the density at x in pdf. For a = |x| the tail 1 - CDF(a) is
+// exp(-a^2 / 2) times the scaled Mills ratio, approximated by a degree 9/10 rational in a
+// with positive coefficients (relative error below 1e-16 on [0, 38.5]) and evaluated by
+// Estrin's scheme to shorten the dependency chain. Branch-free, and within 8 ulps of exact
+// across the whole range, lower tail included.
+template<typename T>
+inline T normalCDF(T x, T& pdf) {
+    using std::abs;
+    using std::min;
+    T a = min(abs(x), T(40.0));   // Beyond 38.5 the tail underflows to zero
+    T a2 = a * a;
+    T a4 = a2 * a2;
+    T numerator = ((1.3579298331428026e-06 * a + 3.663980117744294e-05) * a2 +
+                   (0.0004837313138343239 * a + 0.00404353102351409)) * a4 +
+                  ((0.02340872431650421 * a + 0.09700532196357908) * a2 +
+                   (0.2877976724449385 * a + 0.5919128149273417));
+    numerator = numerator * a2 + (0.7734132764189351 * a + 0.5);
+    T denominator = ((3.403825314732371e-06 * a2 + (9.184236160584978e-05 * a + 0.0012159384141165182)) * a4 +
+                     ((0.01022747154226705 * a + 0.05988269764290914) * a2 +
+                      (0.25310821474561734 * a + 0.777687981402208))) * a4 +
+                    ((1.70750467611014 * a + 2.5546344269717673) * a2 + (2.3447111136407277 * a + 1.0));
+    T kernel = gaussianKernel(a);
+    pdf = 0.39894228040143267794 * kernel;
+    T tail = kernel * (numerator / denominator);
+    return x < 0.0 ? tail : 1.0 - tail;
+}
+
+template<typename T>
+inline T normalCDF(T x) {
+    T pdf;
+    return normalCDF(x, pdf);
 }
 
-// Normal CDF approximation (Abramowitz and Stegun method)
-inline double normalCDF(double x) {
-    if (x < -10.0) return 0.0;
-    if (x > 10.0) return 1.0;
-    
-    if (x < 0.0) {
-        return 1.0 - normalCDF(-x);
+// Inverse of the normal CDF for p in (0, 1) (Acklam's rational approximation, relative
+// error about 1e-9)
+inline double inverseNormalCDF(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double tail = 0.02425;
+
+    if (p >= tail && p <= 1.0 - tail) {
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
     }
+    double q = std::sqrt(-2.0 * std::log(std::min(p, 1.0 - p)));
+    double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    return p < 0.5 ? x : -x;
+}
+
+// Bivariate normal CDF P(X < x, Y < y) with correlation rho (Genz 2004, as in Haug's
+// "Complete Guide to Option Pricing Formulas"). Accurate to about 1e-15 given an exact
+// univariate CDF.
+inline double bivariateNormalCDF(double x, double y, double rho) {
+    static const double w[3][10] = {
+        {0.17132449237917, 0.360761573048138, 0.46791393457269},
+        {4.71753363865118e-02, 0.106939325995318, 0.160078328543346, 0.203167426723066,
+         0.233492536538355, 0.249147045813403},
+        {1.76140071391521e-02, 4.06014298003869e-02, 6.26720483341091e-02, 8.32767415767048e-02,
+         0.10193011981724, 0.118194531961518, 0.131688638449177, 0.142096109318382,
+         0.149172986472604, 0.152753387130726}
+    };
+    static const double xx[3][10] = {
+        {-0.932469514203152, -0.661209386466265, -0.238619186083197},
+        {-0.981560634246719, -0.904117256370475, -0.769902674194305, -0.587317954286617,
+         -0.36783149899818, -0.125233408511469},
+        {-0.993128599185095, -0.963971927277914, -0.912234428251326, -0.839116971822219,
+         -0.746331906460151, -0.636053680726515, -0.510867001950827, -0.37370608871542,
+         -0.227785851141645, -7.65265211334973e-02}
+    };
 
-    static const double p = 0.2316419;
-    static const double b1 = 0.319381530;
-    static const double b2 = -0.356563782;
-    static const double b3 = 1.781477937;
-    static const double b4 = -1.821255978;
-    static const double b5 = 1.330274429;
-
-    double t = 1.0 / (1.0 + p * x);
-    double poly = t * (b1 + t * (b2 + t * (b3 + t * (b4 + t * b5))));
-    
-    return 1.0 - normalPDF(x) * poly;
+    int ng;
+    int lg;
+    if (std::abs(rho) < 0.3) {
+        ng = 0;
+        lg = 3;
+    } else if (std::abs(rho) < 0.75) {
+        ng = 1;
+        lg = 6;
+    } else {
+        ng = 2;
+        lg = 10;
+    }
+
+    double h = -x;
+    double k = -y;
+    double hk = h * k;
+    double bvn = 0.0;
+
+    if (std::abs(rho) < 0.925) {
+        if (std::abs(rho) > 0.0) {
+            double hs = (h * h + k * k) / 2.0;
+            double asr = std::asin(rho);
+            for (int i = 0; i < lg; ++i) {
+                for (int is = -1; is <= 1; is += 2) {
+                    double sn = std::sin(asr * (is * xx[ng][i] + 1.0) / 2.0);
+                    bvn += w[ng][i] * std::exp((sn * hk - hs) / (1.0 - sn * sn));
+                }
+            }
+            bvn *= asr / (4.0 * M_PI);
+        }
+        return bvn + normalCDF(-h) * normalCDF(-k);
+    }
+
+    if (rho < 0.0) {
+        k = -k;
+        hk = -hk;
+    }
+
+    if (std::abs(rho) < 1.0) {
+        double as = (1.0 - rho) * (1.0 + rho);
+        double a = std::sqrt(as);
+        double bs = (h - k) * (h - k);
+        double c = (4.0 - hk) / 8.0;
+        double d = (12.0 - hk) / 16.0;
+        double asr = -(bs / as + hk) / 2.0;
+        if (asr > -100.0) {
+            bvn = a * std::exp(asr) * (1.0 - c * (bs - as) * (1.0 - d * bs / 5.0) / 3.0 + c * d * as * as / 5.0);
+        }
+        if (-hk < 100.0) {
+            double b = std::sqrt(bs);
+            bvn -= std::exp(-hk / 2.0) * std::sqrt(2.0 * M_PI) * normalCDF(-b / a) * b *
+                   (1.0 - c * bs * (1.0 - d * bs / 5.0) / 3.0);
+        }
+        a /= 2.0;
+        for (int i = 0; i < lg; ++i) {
+            for (int is = -1; is <= 1; is += 2) {
+                double xs = a * (is * xx[ng][i] + 1.0);
+                xs *= xs;
+                double rs = std::sqrt(1.0 - xs);
+                asr = -(bs / xs + hk) / 2.0;
+                if (asr > -100.0) {
+                    bvn += a * w[ng][i] * std::exp(asr) *
+                           (std::exp(-hk * (1.0 - rs) / (2.0 * (1.0 + rs))) / rs - (1.0 + c * xs * (1.0 + d * xs)));
+                }
+            }
+        }
+        bvn = -bvn / (2.0 * M_PI);
+    }
+
+    if (rho > 0.0) {
+        return bvn + normalCDF(-std::max(h, k));
+    }
+    bvn = -bvn;
+    if (k > h) {
+        bvn += normalCDF(k) - normalCDF(h);
+    }
+    return bvn;
 }
 
 #endif // MATH_UTILS_H
\ No newline at end of file
@@ -0,0 +1,488 @@
+#include "monte_carlo.h"
+#include "math_utils.h"
+#include "pricing_exceptions.h"
+#include "thread_pool.h"
+#include "vector_math.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Paths per block; a multiple of every packed width so block loops need no remainder
+constexpr int blockPaths = 64;
+
+// Regression basis 1, u, u^2, u^3 in u = S / K - 1
+constexpr int basisSize = 4;
+
+// Tasks per worker: enough slack for stealing to even out uneven blocks
+constexpr std::size_t tasksPerWorker = 8;
+
+// Pricing and regression paths draw from disjoint parts of the counter space
+enum class Stream : std::uint32_t { Pricing = 0, Regression = 1 };
+
+template<typename T>
+void inverseNormalBlock(T* values, int count) {
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same<T, double>::value) {
+        for (int i = 0; i < count; i += PackedDouble::width) {
+            packedStore(values + i, packedInverseNormalCDF(packedLoad(values + i)));
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < count; ++i) {
+        values[i] = T(inverseNormalCDF(double(values[i])));
+    }
+}
+
+template<typename T>
+void expBlock(T* values, int count) {
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same<T, double>::value) {
+        for (int i = 0; i < count; i += PackedDouble::width) {
+            packedStore(values + i, packedExp(packedLoad(values + i)));
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < count; ++i) {
+        values[i] = std::exp(values[i]);
+    }
+}
+
+// Standard normals number 0..count of (stream, block, date); count is a multiple of four
+template<typename T>
+void drawNormals(const Philox4x32::Key& key, Stream stream, std::size_t block, int date, T* normals, int count) {
+    std::uint64_t index = block;
+    for (int j = 0; j < count; j += 4) {
+        Philox4x32::Counter bits = Philox4x32::generate(
+            {std::uint32_t(j / 4), std::uint32_t(date), std::uint32_t(index),
+             std::uint32_t(index >> 32) ^ (std::uint32_t(stream) << 31)},
+            key);
+        for (int k = 0; k < 4; ++k) {
+            // Midpoints of 2^32 equal cells, so never exactly 0 or 1
+            normals[j + k] = (T(bits[k]) + T(0.5)) * T(2.3283064365386962890625e-10);
+        }
+    }
+    inverseNormalBlock(normals, count);
+}
+
+// One block of paths, advanced one date at a time
+template<typename T>
+struct PathBlock {
+    T logReturn[blockPaths];     // ln(S_t / S_0)
+    T spot[blockPaths];
+    T normals[blockPaths];
+    T firstNormal[blockPaths];   // Normal of the first step, for the gamma weight
+};
+
+template<typename T>
+struct PathSimulator {
+    Philox4x32::Key key;
+    Stream stream;
+    bool antithetic;
+    T spot;
+    T drift;       // Of ln(S) per date
+    T diffusion;   // sigma sqrt(dt)
+
+    void start(PathBlock<T>& paths) const {
+        std::fill(paths.logReturn, paths.logReturn + blockPaths, T(0));
+    }
+
+    // Moves the block from date to date + 1 (date counts from zero)
+    void advance(PathBlock<T>& paths, std::size_t block, int date) const {
+        // Antithetic partners are path i and path i + blockPaths / 2
+        int fresh = antithetic ? blockPaths / 2 : blockPaths;
+        drawNormals(key, stream, block, date, paths.normals, fresh);
+        for (int i = fresh; i < blockPaths; ++i) {
+            paths.normals[i] = -paths.normals[i - fresh];
+        }
+        if (date == 0) {
+            std::copy(paths.normals, paths.normals + blockPaths, paths.firstNormal);
+        }
+        for (int i = 0; i < blockPaths; ++i) {
+            paths.logReturn[i] += drift + diffusion * paths.normals[i];
+            paths.spot[i] = paths.logReturn[i];
+        }
+        expBlock(paths.spot, blockPaths);
+        for (int i = 0; i < blockPaths; ++i) {
+            paths.spot[i] *= spot;
+        }
+    }
+};
+
+// Exercise value in units of the strike at moneyness m = S / K
+template<typename T>
+T normalisedIntrinsic(OptionStyle style, T m) {
+    return std::max(style == OptionStyle::Call ? m - T(1) : T(1) - m, T(0));
+}
+
+template<typename T>
+std::array<T, basisSize> regressionBasis(T m) {
+    T u = m - T(1);
+    return {T(1), u, u * u, u * u * u};
+}
+
+// Gaussian elimination with partial pivoting; false if the system is singular
+template<typename T>
+bool solveLinearSystem(std::array<std::array<T, basisSize>, basisSize> A, std::array<T, basisSize>& b) {
+    for (int col = 0; col < basisSize; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < basisSize; ++row) {
+            if (std::abs(A[row][col]) > std::abs(A[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::abs(A[pivot][col]) < T(1e-14) * std::abs(A[0][0])) {
+            return false;
+        }
+        std::swap(A[col], A[pivot]);
+        std::swap(b[col], b[pivot]);
+        for (int row = col + 1; row < basisSize; ++row) {
+            T factor = A[row][col] / A[col][col];
+            for (int k = col; k < basisSize; ++k) {
+                A[row][k] -= factor * A[col][k];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = basisSize - 1; row >= 0; --row) {
+        for (int k = row + 1; k < basisSize; ++k) {
+            b[row] -= A[row][k] * b[k];
+        }
+        b[row] /= A[row][row];
+    }
+    return true;
+}
+
+// European value in units of the strike at moneyness m = S / K, tau years before expiry
+template<typename T>
+T normalisedEuropean(OptionStyle style, T m, T r, T q, T sigma, T tau) {
+    T sigmaSqrtT = sigma * std::sqrt(tau);
+    T d1 = (std::log(m) + (r - q + T(0.5) * sigma * sigma) * tau) / sigmaSqrtT;
+    T d2 = d1 - sigmaSqrtT;
+    T forward = m * std::exp(-q * tau);
+    T discount = std::exp(-r * tau);
+    if (style == OptionStyle::Call) {
+        return forward * normalCDF(d1) - discount * normalCDF(d2);
+    }
+    return discount * normalCDF(-d2) - forward * normalCDF(-d1);
+}
+
+// Longstaff-Schwartz policy: at each date but the last, the discounted value of holding on
+// (in units of the strike) regressed on the basis over in-the-money paths. A path is
+// exercised only if its intrinsic value also beats the European value, a lower bound on
+// holding on that keeps cubic fits from extrapolating into early exercise in thinly
+// sampled tails.
+template<typename T>
+struct ExercisePolicy {
+    std::vector<std::array<T, basisSize>> coefficients;
+    std::vector<char> fitted;   // False where too few paths were in the money to fit
+    OptionStyle style;
+    T r, q, sigma;
+    T dt;
+
+    bool exercise(int date, T intrinsic, T m) const {
+        int dates = static_cast<int>(fitted.size());
+        if (date + 1 == dates) {
+            return true;
+        }
+        if (!fitted[date]) {
+            return false;
+        }
+        std::array<T, basisSize> basis = regressionBasis(m);
+        T continuation = T(0);
+        for (int k = 0; k < basisSize; ++k) {
+            continuation += coefficients[date][k] * basis[k];
+        }
+        if (intrinsic < continuation) {
+            return false;
+        }
+        return intrinsic >= normalisedEuropean(style, m, r, q, sigma, dt * T(dates - date - 1));
+    }
+};
+
+std::size_t blocksFor(std::size_t paths) {
+    return std::max<std::size_t>(1, (paths + blockPaths - 1) / blockPaths);
+}
+
+// Runs body(block) for every block, spread over the pool in contiguous chunks
+template<typename F>
+void forEachBlock(WorkStealingPool& pool, std::size_t blocks, F&& body) {
+    std::size_t tasks = std::min(blocks, pool.size() * tasksPerWorker);
+    pool.run(tasks, [&](std::size_t task) {
+        std::size_t first = blocks * task / tasks;
+        std::size_t last = blocks * (task + 1) / tasks;
+        for (std::size_t block = first; block < last; ++block) {
+            body(block);
+        }
+    });
+}
+
+template<typename T>
+ExercisePolicy<T> fitExercisePolicy(const OptionParametersT<T>& params, const MonteCarloSettings& settings,
+                                    const PathSimulator<T>& simulator, WorkStealingPool& pool) {
+    const int dates = settings.exerciseDates;
+    const std::size_t blocks = blocksFor(settings.regressionPaths);
+    const std::size_t n = blocks * blockPaths;
+
+    // Moneyness of every regression path at every date, date-major
+    std::vector<T> moneyness(std::size_t(dates) * n);
+    forEachBlock(pool, blocks, [&](std::size_t block) {
+        PathBlock<T> paths;
+        simulator.start(paths);
+        for (int date = 0; date < dates; ++date) {
+            simulator.advance(paths, block, date);
+            T* row = moneyness.data() + std::size_t(date) * n + block * blockPaths;
+            for (int i = 0; i < blockPaths; ++i) {
+                row[i] = paths.spot[i] / params.K;
+            }
+        }
+    });
+
+    ExercisePolicy<T> policy{std::vector<std::array<T, basisSize>>(dates), std::vector<char>(dates, 0),
+                             params.style, params.r, params.q, params.sigma, params.expiry / T(dates)};
+
+    std::vector<T> cashFlow(n);
+    const T* last = moneyness.data() + std::size_t(dates - 1) * n;
+    for (std::size_t p = 0; p < n; ++p) {
+        cashFlow[p] = normalisedIntrinsic(params.style, last[p]);
+    }
+
+    T discount = std::exp(-params.r * params.expiry / T(dates));
+    for (int date = dates - 2; date >= 0; --date) {
+        const T* m = moneyness.data() + std::size_t(date) * n;
+        std::array<std::array<T, basisSize>, basisSize> normal{};
+        std::array<T, basisSize> rhs{};
+        std::size_t inTheMoney = 0;
+        for (std::size_t p = 0; p < n; ++p) {
+            cashFlow[p] *= discount;
+            if (normalisedIntrinsic(params.style, m[p]) <= T(0)) {
+                continue;
+            }
+            std::array<T, basisSize> basis = regressionBasis(m[p]);
+            for (int i = 0; i < basisSize; ++i) {
+                for (int j = 0; j < basisSize; ++j) {
+                    normal[i][j] += basis[i] * basis[j];
+                }
+                rhs[i] += basis[i] * cashFlow[p];
+            }
+            ++inTheMoney;
+        }
+        if (inTheMoney < std::size_t(4 * basisSize) || !solveLinearSystem(normal, rhs)) {
+            continue;
+        }
+        policy.coefficients[date] = rhs;
+        policy.fitted[date] = 1;
+
+        for (std::size_t p = 0; p < n; ++p) {
+            T intrinsic = normalisedIntrinsic(params.style, m[p]);
+            if (intrinsic > T(0) && policy.exercise(date, intrinsic, m[p])) {
+                cashFlow[p] = intrinsic;
+            }
+        }
+    }
+    return policy;
+}
+
+// Per-block sums; a sample unit is one path, or one antithetic pair averaged
+template<typename T>
+struct BlockTotals {
+    T payoff{};
+    T payoffSquared{};
+    T control{};
+    T controlSquared{};
+    T cross{};
+    T delta{};
+    T gamma{};
+    T vega{};
+    T rho{};
+};
+
+} // namespace
+
+template<typename T>
+MonteCarloModelT<T>::MonteCarloModelT(MonteCarloSettings settings) : settings(settings) {
+    if (settings.paths == 0 || settings.regressionPaths == 0 || settings.exerciseDates < 1) {
+        throw OptionPricingError("Monte Carlo needs at least one path and one exercise date");
+    }
+}
+
+template<typename T>
+void MonteCarloModelT<T>::setWorkerCount(std::size_t workers) {
+    pool = std::make_shared<WorkStealingPool>(workers);
+}
+
+template<typename T>
+std::size_t MonteCarloModelT<T>::workerCount() const {
+    return pool ? pool->size() : WorkStealingPool::shared().size();
+}
+
+template<typename T>
+PricingResultT<T> MonteCarloModelT<T>::calculate(const OptionParametersT<T>& params) const {
+    return simulate(params).result;
+}
+
+template<typename T>
+MonteCarloResultT<T> MonteCarloModelT<T>::simulate(const OptionParametersT<T>& params) const {
+    validateOptionParametersT(params);
+    WorkStealingPool& workers = pool ? *pool : WorkStealingPool::shared();
+
+    const bool american = params.type == OptionType::American;
+    const int dates = american ? settings.exerciseDates : 1;
+    const T S = params.S;
+    const T K = params.K;
+    const T r = params.r;
+    const T q = params.q;
+    const T sigma = params.sigma;
+    const T dt = params.expiry / T(dates);
+    const T omega = params.style == OptionStyle::Call ? T(1) : T(-1);
+
+    PathSimulator<T> simulator{{std::uint32_t(settings.seed), std::uint32_t(settings.seed >> 32)},
+                               Stream::Pricing, settings.antithetic, S,
+                               (r - q - T(0.5) * sigma * sigma) * dt, sigma * std::sqrt(dt)};
+
+    // European options have a single date, on which the policy always exercises
+    ExercisePolicy<T> policy{std::vector<std::array<T, basisSize>>(1), std::vector<char>(1, 0),
+                             params.style, r, q, sigma, dt};
+    if (american) {
+        PathSimulator<T> regression = simulator;
+        regression.stream = Stream::Regression;
+        policy = fitExercisePolicy(params, settings, regression, workers);
+    }
+
+    // Control: the discounted terminal stock for European options, the European option
+    // itself for American ones
+    T controlMean;
+    if (american) {
+        OptionParametersT<T> european = params;
+        european.type = OptionType::European;
+        controlMean = BlackScholesModelT<T>().calculate(european).price;
+    } else {
+        controlMean = S * std::exp(-q * params.expiry);
+    }
+
+    const std::size_t blocks = blocksFor(settings.paths);
+    std::vector<BlockTotals<T>> totals(blocks);
+    const T gammaWeight = T(1) / (sigma * std::sqrt(dt));
+    const T vegaDrift = r - q + T(0.5) * sigma * sigma;
+    const T terminalDiscount = std::exp(-r * params.expiry);
+
+    forEachBlock(workers, blocks, [&](std::size_t block) {
+        PathBlock<T> paths;
+        T payoff[blockPaths] = {};
+        T delta[blockPaths] = {};
+        T vega[blockPaths] = {};
+        T rho[blockPaths] = {};
+        bool alive[blockPaths];
+        std::fill(alive, alive + blockPaths, true);
+
+        simulator.start(paths);
+        for (int date = 0; date < dates; ++date) {
+            simulator.advance(paths, block, date);
+            T t = dt * T(date + 1);
+            T discount = std::exp(-r * t);
+            for (int i = 0; i < blockPaths; ++i) {
+                if (!alive[i]) {
+                    continue;
+                }
+                T m = paths.spot[i] / K;
+                T intrinsic = normalisedIntrinsic(params.style, m);
+                if (intrinsic <= T(0) || !policy.exercise(date, intrinsic, m)) {
+                    continue;
+                }
+                // Pathwise derivatives of the discounted payoff with the exercise date held fixed
+                T discountedSpot = discount * omega * paths.spot[i];
+                payoff[i] = discount * K * intrinsic;
+                delta[i] = discountedSpot / S;
+                vega[i] = discountedSpot * (paths.logReturn[i] - vegaDrift * t) / sigma;
+                rho[i] = t * (discountedSpot - payoff[i]);
+                alive[i] = false;
+            }
+        }
+
+        T control[blockPaths];
+        for (int i = 0; i < blockPaths; ++i) {
+            control[i] = american ? terminalDiscount * std::max(omega * (paths.spot[i] - K), T(0))
+                                  : terminalDiscount * paths.spot[i];
+        }
+
+        BlockTotals<T>& sum = totals[block];
+        int units = settings.antithetic ? blockPaths / 2 : blockPaths;
+        for (int j = 0; j < units; ++j) {
+            T y = payoff[j];
+            T c = control[j];
+            if (settings.antithetic) {
+                y = T(0.5) * (y + payoff[j + units]);
+                c = T(0.5) * (c + control[j + units]);
+            }
+            sum.payoff += y;
+            sum.payoffSquared += y * y;
+            sum.control += c;
+            sum.controlSquared += c * c;
+            sum.cross += y * c;
+        }
+        for (int i = 0; i < blockPaths; ++i) {
+            sum.delta += delta[i];
+            sum.gamma += delta[i] * (paths.firstNormal[i] * gammaWeight - T(1)) / S;
+            sum.vega += vega[i];
+            sum.rho += rho[i];
+        }
+    });
+
+    // Summed in block order, so the result does not depend on how blocks were scheduled
+    BlockTotals<T> total;
+    for (const BlockTotals<T>& sum : totals) {
+        total.payoff += sum.payoff;
+        total.payoffSquared += sum.payoffSquared;
+        total.control += sum.control;
+        total.controlSquared += sum.controlSquared;
+        total.cross += sum.cross;
+        total.delta += sum.delta;
+        total.gamma += sum.gamma;
+        total.vega += sum.vega;
+        total.rho += sum.rho;
+    }
+
+    const T paths = T(blocks * blockPaths);
+    const T units = settings.antithetic ? paths / T(2) : paths;
+    T meanPayoff = total.payoff / units;
+    T meanControl = total.control / units;
+    T payoffVariance = (total.payoffSquared - units * meanPayoff * meanPayoff) / (units - T(1));
+    T controlVariance = (total.controlSquared - units * meanControl * meanControl) / (units - T(1));
+    T covariance = (total.cross - units * meanPayoff * meanControl) / (units - T(1));
+
+    MonteCarloResultT<T> estimate;
+    PricingResultT<T>& result = estimate.result;
+    T variance = payoffVariance;
+    result.price = meanPayoff;
+    if (settings.controlVariate && controlVariance > T(0)) {
+        T beta = covariance / controlVariance;
+        result.price -= beta * (meanControl - controlMean);
+        variance -= covariance * covariance / controlVariance;
+    }
+    estimate.standardError = std::sqrt(std::max(variance, T(0)) / units);
+
+    result.greeks.delta = total.delta / paths;
+    result.greeks.gamma = total.gamma / paths;
+    result.greeks.vega = total.vega / paths;
+    result.greeks.rho = total.rho / paths;
+    // dV/d(expiry) from the Black-Scholes equation, positive like the other models
+    result.greeks.theta = T(0.5) * sigma * sigma * S * S * result.greeks.gamma +
+                          (r - q) * S * result.greeks.delta - r * result.price;
+
+    // Exercising today beats holding on
+    T intrinsic = std::max(omega * (S - K), T(0));
+    if (american && intrinsic >= result.price) {
+        result.price = intrinsic;
+        result.greeks = GreeksT<T>();
+        result.greeks.delta = omega;
+        estimate.standardError = T(0);
+    }
+    return estimate;
+}
+
+// Explicit instantiations
+template class MonteCarloModelT<double>;
@@ -1,226 +1,978 @@
 #include "option_pricing.h"
+#include "static_pricing.h"
+#include "autodiff.h"
 #include "math_utils.h"
 #include "pricing_exceptions.h"
 #include "greek_calculations.h"
+#include "vector_math.h"
+#include "thread_pool.h"
+#include "result_cache.h"
 #include <cmath>
 #include <algorithm>
 #include <stdexcept>
 #include <functional>
+#include <numeric>
+#include <type_traits>
+#include <string>
+#include <array>
+#include <limits>
 
+namespace {
+
+// Status bits of one field: the range check fails for values at or below zero (or below
+// zero when zero is allowed). NaN and infinities fail the finite check, comparing false
+// against the largest double.
 template<typename T>
-void validateOptionParametersT(const OptionParametersT<T>& params) {
-    // Lambda for checking positive values
-    auto checkPositive = [](T value, const std::string& name) {
-        if (value <= T(0)) {
-            throw OptionPricingError(name + " must be positive");
-        }
-    };
+inline ValidationStatus fieldStatus(const T& value, bool allowZero, int field) {
+    using std::abs;
+    bool outOfRange = allowZero ? value < T(0) : value <= T(0);
+    bool notFinite = !(abs(value) <= std::numeric_limits<double>::max());
+    return ValidationStatus((ValidationStatus(outOfRange) << field) | (ValidationStatus(notFinite) << (8 + field)));
+}
 
-    // Lambda for checking non-negative values
-    auto checkNonNegative = [](T value, const std::string& name) {
-        if (value < T(0)) {
-            throw OptionPricingError(name + " cannot be negative");
-        }
-    };
+template<typename T>
+inline ValidationStatus rowStatus(const T& S, const T& K, const T& r, const T& sigma, const T& expiry, const T& q) {
+    return ValidationStatus(fieldStatus(S, false, 0) | fieldStatus(K, false, 1) | fieldStatus(r, true, 2) |
+                            fieldStatus(sigma, false, 3) | fieldStatus(expiry, false, 4) | fieldStatus(q, true, 5));
+}
 
-    // Lambda for checking for invalid numbers
-    auto checkValidNumber = [](T value, const std::string& name) {
-        if (std::isnan(value) || std::isinf(value)) {
-            throw OptionPricingError(name + " contains invalid value");
-        }
-    };
+} // namespace
 
-    // Apply validation checks
-    checkPositive(params.S, "Stock price");
-    checkPositive(params.K, "Strike price");
-    checkNonNegative(params.r, "Risk-free rate");
-    checkPositive(params.sigma, "Volatility");
-    checkPositive(params.expiry, "Time to expiration");
-    checkNonNegative(params.q, "Dividend yield");
+template<typename T>
+ValidationStatus validationStatusT(const OptionParametersT<T>& params) {
+    return rowStatus(params.S, params.K, params.r, params.sigma, params.expiry, params.q);
+}
+
+template<typename T>
+std::size_t validateOptionBatchT(const OptionBatchT<T>& batch, ValidationStatus* status) {
+    std::size_t invalid = 0;
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        status[i] = rowStatus(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.expiry[i], batch.q[i]);
+        invalid += status[i] != 0;
+    }
+    return invalid;
+}
+
+std::string validationMessage(ValidationStatus status) {
+    static const char* const names[] = {"Stock price", "Strike price", "Risk-free rate",
+                                        "Volatility", "Time to expiration", "Dividend yield"};
+    for (int field = 0; field < 6; ++field) {
+        if (status & (1u << field)) {
+            bool allowZero = field == 2 || field == 5;
+            return std::string(names[field]) + (allowZero ? " cannot be negative" : " must be positive");
+        }
+    }
+    for (int field = 0; field < 6; ++field) {
+        if (status & (1u << (8 + field))) {
+            return std::string(names[field]) + " contains invalid value";
+        }
+    }
+    return "Valid option parameters";
+}
 
-    // Check for invalid numbers
-    std::array<std::pair<T, std::string>, 6> checks = {{
-        {params.S, "Stock price"},
-        {params.K, "Strike price"},
-        {params.r, "Risk-free rate"},
-        {params.sigma, "Volatility"},
-        {params.expiry, "Time to expiration"},
-        {params.q, "Dividend yield"}
-    }};
+template<typename T>
+void validateOptionParametersT(const OptionParametersT<T>& params) {
+    OPTION_PRICING_PROBE(Probe::Validate);
 
-    for (const auto& [value, name] : checks) {
-        checkValidNumber(value, name);
+    ValidationStatus status = validationStatusT(params);
+    if (status != 0) {
+        throw OptionPricingError(validationMessage(status));
     }
 }
 
 template<typename T>
 PricingResultT<T> BlackScholesModelT<T>::calculate(const OptionParametersT<T>& params) const {
     validateOptionParametersT(params);
-    PricingResultT<T> result;
-    
-    T S = params.S;
-    T K = params.K;
-    T r = params.r;
-    T q = params.q;
-    T sigma = params.sigma;
-    T time = params.expiry;
+    return evaluate(params);
+}
+
+template<typename T>
+PricingResultT<T> BlackScholesModelT<T>::evaluate(const OptionParametersT<T>& params) {
+    if (params.style == OptionStyle::Call) {
+        return BlackScholesKernelT<T>::template evaluate<OptionStyle::Call>(params);
+    }
+    return BlackScholesKernelT<T>::template evaluate<OptionStyle::Put>(params);
+}
+
+namespace {
+
+template<typename T>
+OptionParametersT<T> batchRow(const OptionBatchT<T>& batch, std::size_t i) {
+    OptionParametersT<T> params;
+    params.S = batch.S[i];
+    params.K = batch.K[i];
+    params.r = batch.r[i];
+    params.q = batch.q[i];
+    params.sigma = batch.sigma[i];
+    params.expiry = batch.expiry[i];
+    params.style = batch.style[i];
+    params.type = batch.type ? batch.type[i] : OptionType::European;
+    return params;
+}
 
-    T sqrtT = std::sqrt(time);
-    T sigmaSqrtT = sigma * sqrtT;
+// Rows [first, first + count) of a batch
+template<typename T>
+OptionBatchT<T> sliceBatch(const OptionBatchT<T>& batch, std::size_t first, std::size_t count) {
+    OptionBatchT<T> slice = batch;
+    slice.size = count;
+    slice.S += first;
+    slice.K += first;
+    slice.r += first;
+    slice.q += first;
+    slice.sigma += first;
+    slice.expiry += first;
+    slice.style += first;
+    if (slice.type) {
+        slice.type += first;
+    }
+    return slice;
+}
 
-    T d1 = (std::log(S / K) + (r - q + T(0.5) * sigma * sigma) * time) / sigmaSqrtT;
-    T d2 = d1 - sigmaSqrtT;
+template<typename T>
+void storeBatchRow(const PricingResultBatchT<T>& results, std::size_t i, const PricingResultT<T>& row) {
+    results.price[i] = row.price;
+    if (results.delta) results.delta[i] = row.greeks.delta;
+    if (results.gamma) results.gamma[i] = row.greeks.gamma;
+    if (results.theta) results.theta[i] = row.greeks.theta;
+    if (results.vega) results.vega[i] = row.greeks.vega;
+    if (results.rho) results.rho[i] = row.greeks.rho;
+}
 
-    T nd1 = normalCDF(d1);
-    T nd2 = normalCDF(d2);
+// True when any Greek column is requested; the lattice then computes all of them
+template<typename T>
+bool wantsGreeks(const PricingResultBatchT<T>& results) {
+    return results.delta || results.gamma || results.theta || results.vega || results.rho;
+}
 
-    T expQT = std::exp(-q * time);
-    T expRT = std::exp(-r * time);
+// Rejects the batch on its first invalid row with the same message as validateOptionParametersT
+template<typename T>
+void validateOptionBatchT(const OptionBatchT<T>& batch) {
+    constexpr std::size_t Chunk = 256;
+    ValidationStatus status[Chunk];
+    for (std::size_t first = 0; first < batch.size; first += Chunk) {
+        OptionBatchT<T> slice = sliceBatch(batch, first, std::min(Chunk, batch.size - first));
+        if (validateOptionBatchT(slice, status) == 0) {
+            continue;
+        }
+        std::size_t row = std::find_if(status, status + slice.size, [](ValidationStatus s) { return s != 0; }) - status;
+        throw OptionPricingError("Row " + std::to_string(first + row) + ": " + validationMessage(status[row]));
+    }
+}
 
-    if (params.style == OptionStyle::Call) {
-        result.price = S * expQT * nd1 - K * expRT * nd2;
-    } else {
-        result.price = K * expRT * (T(1) - nd2) - S * expQT * (T(1) - nd1);
+// Sets every output of the invalid rows to NaN
+template<typename T>
+void markInvalidRows(const PricingResultBatchT<T>& results, const ValidationStatus* status, std::size_t size) {
+    const T nan = T(std::numeric_limits<double>::quiet_NaN());
+    for (std::size_t i = 0; i < size; ++i) {
+        if (status[i] != 0) {
+            for (T* column : {results.price, results.delta, results.gamma, results.theta, results.vega, results.rho}) {
+                if (column) {
+                    column[i] = nan;
+                }
+            }
+        }
     }
+}
 
-    // Calculate Greeks
-    T pd1 = normalPDF(d1);
+#if OPTION_PRICING_HAS_SIMD
+// Prices one lane group starting at offset i. Puts are handled through
+// N(-x) = 1 - N(x) with a +/-1 sign per lane so the kernel has no branches.
+inline void blackScholesPacked(const double* S_, const double* K_, const double* r_, const double* q_,
+                               const double* sigma_, const double* expiry_, const double* sign_,
+                               double* price, double* delta, double* gamma,
+                               double* theta, double* vega, double* rho) {
+    PackedDouble S = packedLoad(S_);
+    PackedDouble K = packedLoad(K_);
+    PackedDouble r = packedLoad(r_);
+    PackedDouble q = packedLoad(q_);
+    PackedDouble sigma = packedLoad(sigma_);
+    PackedDouble time = packedLoad(expiry_);
+    PackedDouble sign = packedLoad(sign_);
+
+    PackedDouble sqrtT = packedSqrt(time);
+    PackedDouble sigmaSqrtT = sigma * sqrtT;
+
+    PackedDouble d1 = (packedLog(S / K) + (r - q + packedSet(0.5) * sigma * sigma) * time) / sigmaSqrtT;
+    PackedDouble d2 = d1 - sigmaSqrtT;
+
+    PackedDouble pd1;
+    PackedDouble nd1 = packedNormalCDF(sign * d1, pd1);
+    PackedDouble nd2 = packedNormalCDF(sign * d2);
+
+    PackedDouble expQT = packedExp(-q * time);
+    PackedDouble expRT = packedExp(-r * time);
+
+    PackedDouble spotLeg = S * expQT * nd1;
+    PackedDouble strikeLeg = K * expRT * nd2;
+
+    packedStore(price, sign * (spotLeg - strikeLeg));
+    packedStore(delta, sign * expQT * nd1);
+    packedStore(rho, sign * time * strikeLeg);
+
+    // Theta is reported positive, matching BlackScholesModelT::calculate
+    PackedDouble decay = S * sigma * expQT * pd1 / (packedSet(2.0) * sqrtT);
+    packedStore(theta, decay + sign * (r * strikeLeg - q * spotLeg));
+
+    packedStore(gamma, expQT * pd1 / (S * sigmaSqrtT));
+    packedStore(vega, S * expQT * pd1 * sqrtT);
+}
+#endif
 
-    if (params.style == OptionStyle::Call) {
-        result.greeks.delta = expQT * nd1;
-        result.greeks.theta = -(S * sigma * expQT * pd1) / (T(2) * sqrtT)
-                           - r * K * expRT * nd2
-                           + q * S * expQT * nd1;
-        result.greeks.rho = K * time * expRT * nd2;
+} // namespace
+
+template<typename T>
+void BlackScholesModelT<T>::calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results,
+                                           ValidationStatus* status) const {
+    // Invalid rows go through the kernels like any other, which is cheaper than compacting
+    // the batch, and have their outputs overwritten afterwards
+    std::size_t invalid = 0;
+    if (status) {
+        invalid = validateOptionBatchT(batch, status);
     } else {
-        result.greeks.delta = -expQT * (T(1) - nd1);
-        result.greeks.theta = -(S * sigma * expQT * pd1) / (T(2) * sqrtT)
-                           + r * K * expRT * (T(1) - nd2)
-                           - q * S * expQT * (T(1) - nd1);
-        result.greeks.rho = -K * time * expRT * (T(1) - nd2);
+        validateOptionBatchT(batch);
+    }
+
+    if (results.delta && results.gamma && results.theta && results.vega && results.rho) {
+        evaluateBatch(batch, results);
+        if (invalid > 0) {
+            markInvalidRows(results, status, batch.size);
+        }
+        return;
     }
 
-    // Make theta positive
-    result.greeks.theta = -result.greeks.theta;
+    // Greek columns left null are computed into scratch space and discarded
+    constexpr std::size_t Chunk = 256;
+    T scratch[5][Chunk];
+    for (std::size_t first = 0; first < batch.size; first += Chunk) {
+        OptionBatchT<T> slice = sliceBatch(batch, first, std::min(Chunk, batch.size - first));
+
+        PricingResultBatchT<T> out;
+        out.price = results.price + first;
+        out.delta = results.delta ? results.delta + first : scratch[0];
+        out.gamma = results.gamma ? results.gamma + first : scratch[1];
+        out.theta = results.theta ? results.theta + first : scratch[2];
+        out.vega = results.vega ? results.vega + first : scratch[3];
+        out.rho = results.rho ? results.rho + first : scratch[4];
+        evaluateBatch(slice, out);
+    }
+    if (invalid > 0) {
+        markInvalidRows(results, status, batch.size);
+    }
+}
 
-    // Common Greeks for both calls and puts
-    result.greeks.gamma = expQT * pd1 / (S * sigmaSqrtT);
-    result.greeks.vega = S * expQT * pd1 * sqrtT;
+template<typename T>
+void BlackScholesModelT<T>::evaluateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results) {
+#if OPTION_PRICING_HAS_SIMD
+    if constexpr (std::is_same_v<T, double>) {
+        constexpr int W = PackedDouble::width;
+        alignas(64) double sign[W];
+
+        std::size_t i = 0;
+        for (; i + W <= batch.size; i += W) {
+            for (int j = 0; j < W; ++j) {
+                sign[j] = batch.style[i + j] == OptionStyle::Put ? -1.0 : 1.0;
+            }
+            blackScholesPacked(batch.S + i, batch.K + i, batch.r + i, batch.q + i,
+                               batch.sigma + i, batch.expiry + i, sign,
+                               results.price + i, results.delta + i, results.gamma + i,
+                               results.theta + i, results.vega + i, results.rho + i);
+        }
 
-    return result;
+        // Pad the remainder into a full lane group so every row goes through the same kernel
+        std::size_t tail = batch.size - i;
+        if (tail > 0) {
+            alignas(64) double in[6][W];
+            alignas(64) double out[6][W];
+            for (int j = 0; j < W; ++j) {
+                bool live = std::size_t(j) < tail;
+                in[0][j] = live ? batch.S[i + j] : 1.0;
+                in[1][j] = live ? batch.K[i + j] : 1.0;
+                in[2][j] = live ? batch.r[i + j] : 0.0;
+                in[3][j] = live ? batch.q[i + j] : 0.0;
+                in[4][j] = live ? batch.sigma[i + j] : 1.0;
+                in[5][j] = live ? batch.expiry[i + j] : 1.0;
+                sign[j] = live && batch.style[i + j] == OptionStyle::Put ? -1.0 : 1.0;
+            }
+            blackScholesPacked(in[0], in[1], in[2], in[3], in[4], in[5], sign,
+                               out[0], out[1], out[2], out[3], out[4], out[5]);
+            for (std::size_t j = 0; j < tail; ++j) {
+                results.price[i + j] = out[0][j];
+                results.delta[i + j] = out[1][j];
+                results.gamma[i + j] = out[2][j];
+                results.theta[i + j] = out[3][j];
+                results.vega[i + j] = out[4][j];
+                results.rho[i + j] = out[5][j];
+            }
+        }
+        return;
+    }
+#endif
+
+    for (std::size_t i = 0; i < batch.size; ++i) {
+        storeBatchRow(results, i, evaluate(batchRow(batch, i)));
+    }
+}
+
+namespace {
+
+template<typename T>
+BinomialWorkspaceT<T>& binomialThreadWorkspace() {
+    thread_local BinomialWorkspaceT<T> workspace;
+    return workspace;
 }
 
+// Constants for one parameter set carried through a recombining CRR lattice
 template<typename T>
-T BinomialModelT<T>::calculateBinomialPrice(const OptionParametersT<T>& params) const {
-    priceTree.clear();
-    priceTree.resize(steps + 1);
+struct LatticeLaneT {
+    T S{};
+    T K{};
+    T sign{};       // +1 for calls, -1 for puts
+    T exercise{};   // 1 when early exercise is allowed, 0 otherwise
+    T u{};
+    T d{};
+    T logU{};
+    T p{};
+    T pDown{};
+    T discount{};
+};
 
+template<typename T>
+LatticeLaneT<T> makeLatticeLane(const OptionParametersT<T>& params, int steps) {
+    using std::exp;
+    using std::sqrt;
+    LatticeLaneT<T> lane;
     T dt = params.expiry / T(steps);
-    T u = std::exp(params.sigma * std::sqrt(dt));
-    T d = T(1) / u;
-    T p = (std::exp((params.r - params.q) * dt) - d) / (u - d);
-    T discount = std::exp(-params.r * dt);
-
-    if (p < T(0) || p > T(1)) {
+    lane.u = exp(params.sigma * sqrt(dt));
+    lane.d = T(1) / lane.u;
+    lane.logU = params.sigma * sqrt(dt);
+    lane.p = (exp((params.r - params.q) * dt) - lane.d) / (lane.u - lane.d);
+    lane.pDown = T(1) - lane.p;
+    lane.discount = exp(-params.r * dt);
+
+    if (lane.p < T(0) || lane.p > T(1)) {
         throw NumericalError("Invalid probability in binomial model");
     }
 
-    // Initialize terminal nodes
-    for (int i = 0; i <= steps; ++i) {
-        T St = params.S * std::pow(u, T(steps - i)) * std::pow(d, T(i));
-        if (params.style == OptionStyle::Call) {
-            priceTree[i] = std::max(T(0), St - params.K);
-        } else {
-            priceTree[i] = std::max(T(0), params.K - St);
+    lane.S = params.S;
+    lane.K = params.K;
+    lane.sign = params.style == OptionStyle::Call ? T(1) : T(-1);
+
+    // For call options with no dividends, American = European
+    bool earlyExercise = params.type == OptionType::American &&
+                         !(params.style == OptionStyle::Call && params.q == T(0));
+    lane.exercise = earlyExercise ? T(1) : T(0);
+    return lane;
+}
+
+// Option values on the first two time steps, from which delta, gamma and theta are read
+template<typename T, int W>
+struct LatticeNodesT {
+    T root[W]{};
+    T step1[2][W]{};
+    T step2[3][W]{};
+};
+
+// Smallest value a lattice node may take. Far out-of-the-money nodes would otherwise decay
+// into subnormal numbers, which are an order of magnitude slower on most CPUs; the floor
+// changes prices by less than 1e-290.
+template<typename T>
+inline T latticeFloor() {
+    return T(1e-300);
+}
+
+// One backward-induction step over count nodes: each node becomes the larger of its
+// discounted continuation value and the exercise value at the same position. Lanes with no
+// early exercise carry latticeFloor() there, so every lane goes through the same loop.
+// Without EarlyExercise the node is just the continuation value and exercise is unused.
+template<typename T, int W, bool EarlyExercise>
+inline void inductionStep(T* __restrict values, const T* __restrict exercise, int count,
+                          const T* __restrict discount, const T* __restrict p, const T* __restrict pDown) {
+    for (int i = 0; i < count; ++i) {
+        T* node = values + i * W;
+        for (int l = 0; l < W; ++l) {
+            T continuation = discount[l] * (p[l] * node[l] + pDown[l] * node[W + l]);
+            if constexpr (EarlyExercise) {
+                T intrinsic = exercise[i * W + l];
+                node[l] = continuation > intrinsic ? continuation : intrinsic;
+            } else {
+                node[l] = continuation;
+            }
+        }
+    }
+}
+
+// Backward induction for W parameter sets in one pass. Node i of lane l is stored at
+// tree[i * W + l], so the innermost loop runs across lanes (or nodes when W == 1).
+//
+// Every node of the recombining tree sits on one of the 2N + 1 spot levels S * u^(N - j),
+// j = 0..2N. Intrinsic values for those levels are computed once up front and split by the
+// parity of j: at a given step all nodes share one parity and occupy a contiguous run of
+// that table, so the induction loop streams through memory with no transcendental calls.
+// With EarlyExercise false every lane is European and only the terminal payoffs are built.
+// Lanes on one lattice may pass its spot levels, shared by all of them, in spotLevels.
+template<typename T, int W, bool EarlyExercise = true>
+void runLattice(const LatticeLaneT<T>* lanes, int steps, BinomialWorkspaceT<T>& workspace,
+                LatticeNodesT<T, W>& nodes, const T* spotLevels = nullptr) {
+    OPTION_PRICING_PROBE(Probe::TreeBuild);
+    OPTION_PRICING_RECORD(recordTree(steps, W));
+    using std::exp;
+    std::size_t levels = std::size_t(steps + 1) * W;
+    if (workspace.priceTree.size() < levels) {
+        workspace.priceTree.resize(levels);
+    }
+    if (EarlyExercise && workspace.exerciseValues.size() < 2 * levels) {
+        workspace.exerciseValues.resize(2 * levels);
+    }
+
+    T* values = workspace.priceTree.data();
+    T* evenLevels = workspace.exerciseValues.data();
+    T* oddLevels = evenLevels + (EarlyExercise ? levels : 0);
+
+    // Lane constants as plain arrays so the lane loops vectorize
+    T discount[W], p[W], pDown[W];
+    for (int l = 0; l < W; ++l) {
+        const LatticeLaneT<T>& lane = lanes[l];
+        discount[l] = lane.discount;
+        p[l] = lane.p;
+        pDown[l] = lane.pDown;
+
+        if constexpr (!EarlyExercise) {
+            for (int i = 0; i <= steps; ++i) {
+                T spot = spotLevels ? spotLevels[2 * i] : lane.S * exp(T(steps - 2 * i) * lane.logU);
+                values[i * W + l] = std::max(latticeFloor<T>(), lane.sign * (spot - lane.K));
+            }
+            continue;
+        }
+
+        for (int j = 0; j <= 2 * steps; ++j) {
+            T spot = spotLevels ? spotLevels[j] : lane.S * exp(T(steps - j) * lane.logU);
+            T* table = (j & 1) ? oddLevels : evenLevels;
+            table[(j >> 1) * W + l] = std::max(latticeFloor<T>(), lane.sign * (spot - lane.K));
+        }
+
+        // Terminal nodes sit on the even levels j = 2i
+        for (int i = 0; i <= steps; ++i) {
+            values[i * W + l] = evenLevels[i * W + l];
+        }
+
+        if (lane.exercise == T(0)) {
+            for (int m = 0; m <= steps; ++m) {
+                evenLevels[m * W + l] = latticeFloor<T>();
+                oddLevels[m * W + l] = latticeFloor<T>();
+            }
         }
     }
 
     // Backward induction
     for (int step = steps - 1; step >= 0; --step) {
-        for (int i = 0; i <= step; ++i) {
-            T St = params.S * std::pow(u, T(step - i)) * std::pow(d, T(i));
-            T continuation = discount * (p * priceTree[i] + (T(1) - p) * priceTree[i + 1]);
-
-            if (params.type == OptionType::American) {
-                T intrinsic = (params.style == OptionStyle::Call) ? 
-                    std::max(T(0), St - params.K) : 
-                    std::max(T(0), params.K - St);
-                priceTree[i] = std::max(continuation, intrinsic);
-            } else {
-                priceTree[i] = continuation;
+        const T* exercise = nullptr;
+        if constexpr (EarlyExercise) {
+            int parity = (steps - step) & 1;
+            exercise = (parity ? oddLevels : evenLevels) + ((steps - step - parity) / 2) * W;
+        }
+        inductionStep<T, W, EarlyExercise>(values, exercise, step + 1, discount, p, pDown);
+
+        if (step == 2) {
+            for (int i = 0; i < 3; ++i) {
+                for (int l = 0; l < W; ++l) {
+                    nodes.step2[i][l] = values[i * W + l];
+                }
+            }
+        } else if (step == 1) {
+            for (int i = 0; i < 2; ++i) {
+                for (int l = 0; l < W; ++l) {
+                    nodes.step1[i][l] = values[i * W + l];
+                }
             }
         }
     }
 
-    return priceTree[0];
+    for (int l = 0; l < W; ++l) {
+        nodes.root[l] = values[l];
+    }
+}
+
+// Bump sizes for the lattice vega and rho
+struct LatticeBumps {
+    static constexpr double dvol = 0.0001;   // Smaller step for vega
+    static constexpr double dr = 0.0001;     // 1 basis point for rho
+};
+
+// The parameters with style and type replaced by a kernel's template arguments
+template<OptionStyle Style, OptionType Type, typename T>
+OptionParametersT<T> withOptionKind(OptionParametersT<T> params) {
+    params.style = Style;
+    params.type = Type;
+    return params;
+}
+
+template<typename T>
+OptionParametersT<T> vegaBumped(OptionParametersT<T> params) {
+    params.sigma += T(LatticeBumps::dvol);
+    return params;
+}
+
+template<typename T>
+OptionParametersT<T> rhoBumped(OptionParametersT<T> params) {
+    params.r += T(LatticeBumps::dr);
+    return params;
+}
+
+// Reads price and Greeks for one option out of the lane it occupied in a lattice pass,
+// given its prices with volatility and rate bumped
+template<typename T, int W>
+PricingResultT<T> latticeGreeks(const LatticeNodesT<T, W>& nodes, const LatticeLaneT<T>& base, T expiry,
+                                int steps, int baseLane, T vegaPrice, T rhoPrice) {
+    PricingResultT<T> result;
+    result.price = nodes.root[baseLane];
+
+    // Delta and gamma from the spot levels S*u, S*d (step 1) and S*u^2, S, S*d^2 (step 2)
+    T S = base.S;
+    T u = base.u;
+    T d = base.d;
+    result.greeks.delta = (nodes.step1[0][baseLane] - nodes.step1[1][baseLane]) / (S * u - S * d);
+
+    T deltaUp = (nodes.step2[0][baseLane] - nodes.step2[1][baseLane]) / (S * u * u - S);
+    T deltaDown = (nodes.step2[1][baseLane] - nodes.step2[2][baseLane]) / (S - S * d * d);
+    result.greeks.gamma = (deltaUp - deltaDown) / (T(0.5) * (S * u * u - S * d * d));
+
+    // Theta from the middle node two steps ahead, which sits at the current spot
+    T dt = expiry / T(steps);
+    result.greeks.theta = (result.price - nodes.step2[1][baseLane]) / (T(2) * dt);
+
+    result.greeks.vega = (vegaPrice - result.price) / T(LatticeBumps::dvol);
+    result.greeks.rho = (rhoPrice - result.price) / T(LatticeBumps::dr);
+    return result;
+}
+
+} // namespace
+
+template<typename T>
+BinomialWorkspaceT<T>& BinomialModelT<T>::threadWorkspace() {
+    return binomialThreadWorkspace<T>();
 }
 
 template<typename T>
 T BinomialModelT<T>::calculatePrice(const OptionParametersT<T>& params) const {
+    return calculatePrice(params, threadWorkspace());
+}
+
+template<typename T>
+T BinomialModelT<T>::calculatePrice(const OptionParametersT<T>& params,
+                                    BinomialWorkspaceT<T>& workspace) const {
+    BinomialKernelT<T> kernel(steps);
+    return dispatchOptionKind(params.style, params.type, [&](auto style, auto type) {
+        return kernel.template calculatePrice<decltype(style)::value, decltype(type)::value>(params, workspace);
+    });
+}
+
+template<typename T>
+PricingResultT<T> BinomialModelT<T>::calculate(const OptionParametersT<T>& params) const {
+    return calculate(params, threadWorkspace());
+}
+
+template<typename T>
+PricingResultT<T> BinomialModelT<T>::calculate(const OptionParametersT<T>& params,
+                                               BinomialWorkspaceT<T>& workspace) const {
+    BinomialKernelT<T> kernel(steps);
+    return dispatchOptionKind(params.style, params.type, [&](auto style, auto type) {
+        return kernel.template calculate<decltype(style)::value, decltype(type)::value>(params, workspace);
+    });
+}
+
+template<typename T>
+template<OptionStyle Style, OptionType Type>
+T BinomialKernelT<T>::calculatePrice(const OptionParametersT<T>& params, BinomialWorkspaceT<T>& workspace) const {
     validateOptionParametersT(params);
 
-    // For call options with no dividends, American = European
-    if (params.style == OptionStyle::Call && params.q == T(0)) {
-        OptionParametersT<T> europeanParams = params;
-        europeanParams.type = OptionType::European;
-        return calculateBinomialPrice(europeanParams);
+    LatticeLaneT<T> lane = makeLatticeLane(withOptionKind<Style, Type>(params), steps);
+    LatticeNodesT<T, 1> nodes;
+    if (lane.exercise == T(0)) {
+        runLattice<T, 1, false>(&lane, steps, workspace, nodes);
+    } else {
+        runLattice<T, 1, true>(&lane, steps, workspace, nodes);
     }
+    return nodes.root[0];
+}
 
-    return calculateBinomialPrice(params);
+template<typename T>
+template<OptionStyle Style, OptionType Type>
+PricingResultT<T> BinomialKernelT<T>::calculate(const OptionParametersT<T>& params) const {
+    return calculate<Style, Type>(params, binomialThreadWorkspace<T>());
 }
 
 template<typename T>
-PricingResultT<T> BinomialModelT<T>::calculate(const OptionParametersT<T>& params) const {
+template<OptionStyle Style, OptionType Type>
+PricingResultT<T> BinomialKernelT<T>::calculate(const OptionParametersT<T>& params,
+                                                BinomialWorkspaceT<T>& workspace) const {
     try {
-        PricingResultT<T> result;
-        result.price = calculatePrice(params);
-
-        // Improved step sizes for more accurate Greeks
-        T h = params.S * T(0.0001);    // Smaller step for delta/gamma
-        T dt = T(1) / T(365);          // One day for theta
-        T dvol = T(0.0001);            // Smaller step for vega
-        T dr = T(0.0001);              // 1 basis point for rho
-
-        // Delta and Gamma calculations
-        OptionParametersT<T> upParams = params;
-        OptionParametersT<T> downParams = params;
-        upParams.S += h;
-        downParams.S -= h;
-        
-        T priceUp = calculatePrice(upParams);
-        T priceDown = calculatePrice(downParams);
-        
-        result.greeks.delta = (priceUp - priceDown) / (T(2) * h);
-        
-        T priceMiddle = result.price;
-        result.greeks.gamma = (priceUp - T(2) * priceMiddle + priceDown) / (h * h);
-
-        // Theta calculation
-        OptionParametersT<T> thetaParams = params;
-        thetaParams.expiry -= dt;
-        if (thetaParams.expiry > T(0)) {
-            result.greeks.theta = -(calculatePrice(thetaParams) - priceMiddle) / dt;
-        } else {
-            result.greeks.theta = T(0);
-        }
-        
-        // Vega calculation
-        OptionParametersT<T> vegaParams = params;
-        vegaParams.sigma += dvol;
-        result.greeks.vega = (calculatePrice(vegaParams) - priceMiddle) / dvol;
-
-        // Rho calculation
-        OptionParametersT<T> rhoParams = params;
-        rhoParams.r += dr;
-        result.greeks.rho = (calculatePrice(rhoParams) - priceMiddle) / dr;
-
-        return result;
+        validateOptionParametersT(params);
+        if (steps < 2) {
+            throw NumericalError("Binomial Greeks require at least 2 steps");
+        }
+
+        // Base, vega and rho parameter sets on separate single-lane lattices, whose induction
+        // loops vectorize across nodes. Interleaving them as lanes of one lattice measured
+        // slower once the single-lane loop is vectorized too. The rho bump leaves the spot
+        // levels unchanged, so its lattice reuses those of the base.
+        OptionParametersT<T> fixed = withOptionKind<Style, Type>(params);
+        LatticeLaneT<T> lanes[3] = {makeLatticeLane(fixed, steps), makeLatticeLane(vegaBumped(fixed), steps),
+                                    makeLatticeLane(rhoBumped(fixed), steps)};
+        LatticeLaneT<T> base = lanes[0];
+        std::size_t levelCount = std::size_t(2 * steps + 1);
+        if (workspace.spotLevels.size() < levelCount) {
+            workspace.spotLevels.resize(levelCount);
+        }
+        T* levels = workspace.spotLevels.data();
+        using std::exp;
+        for (int j = 0; j <= 2 * steps; ++j) {
+            levels[j] = base.S * exp(T(steps - j) * base.logU);
+        }
+
+        LatticeNodesT<T, 1> nodes[3];
+        for (int set = 0; set < 3; ++set) {
+            const T* shared = set == 1 ? nullptr : levels;
+            // European options, and calls without dividends, are never exercised early
+            if (base.exercise == T(0)) {
+                runLattice<T, 1, false>(&lanes[set], steps, workspace, nodes[set], shared);
+            } else {
+                runLattice<T, 1, true>(&lanes[set], steps, workspace, nodes[set], shared);
+            }
+        }
+
+        return latticeGreeks(nodes[0], base, params.expiry, steps, 0, nodes[1].root[0], nodes[2].root[0]);
     } catch (const std::exception& e) {
         throw NumericalError("Error in binomial calculation: " + std::string(e.what()));
     }
 }
 
+template<typename T>
+void BinomialModelT<T>::calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results) const {
+    calculateBatch(batch, results, threadWorkspace());
+}
+
+template<typename T>
+void BinomialModelT<T>::calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results,
+                                       BinomialWorkspaceT<T>& workspace) const {
+    try {
+        validateOptionBatchT(batch);
+
+        // Row by row: at -O3 the single-option induction loop already vectorizes across
+        // nodes, and interleaving options as lanes measured no faster
+        bool withGreeks = wantsGreeks(results);
+        for (std::size_t i = 0; i < batch.size; ++i) {
+            if (withGreeks) {
+                storeBatchRow(results, i, calculate(batchRow(batch, i), workspace));
+            } else {
+                results.price[i] = calculatePrice(batchRow(batch, i), workspace);
+            }
+        }
+    } catch (const NumericalError&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw NumericalError("Error in binomial calculation: " + std::string(e.what()));
+    }
+}
+
+template<typename T>
+void BinomialModelT<T>::calculateStrikes(const OptionParametersT<T>& params, std::size_t count, const T* K,
+                                         const OptionStyle* style, const PricingResultBatchT<T>& results) const {
+    using std::exp;
+    BinomialWorkspaceT<T>& workspace = threadWorkspace();
+
+    try {
+        for (std::size_t i = 0; i < count; ++i) {
+            OptionParametersT<T> row = params;
+            row.K = K[i];
+            validateOptionParametersT(row);
+        }
+
+        bool withGreeks = wantsGreeks(results);
+        if (withGreeks && steps < 2) {
+            throw NumericalError("Binomial Greeks require at least 2 steps");
+        }
+
+        // One lattice for the base parameters and, with Greeks, one each for the vega and rho
+        // bumps. Strikes only enter the payoffs, so the constants and spot levels of a lattice
+        // serve every strike. The rho bump leaves the spot levels of the base unchanged.
+        int sets = withGreeks ? 3 : 1;
+        OptionParametersT<T> setParams[3] = {params, vegaBumped(params), rhoBumped(params)};
+        LatticeLaneT<T> setLanes[3];
+        std::size_t levelCount = std::size_t(2 * steps + 1);
+        if (workspace.spotLevels.size() < 2 * levelCount) {
+            workspace.spotLevels.resize(2 * levelCount);
+        }
+        const T* setLevels[3];
+        for (int set = 0; set < sets; ++set) {
+            setLanes[set] = makeLatticeLane(setParams[set], steps);
+            if (set == 2) {
+                setLevels[set] = setLevels[0];
+                continue;
+            }
+            T* levels = workspace.spotLevels.data() + set * levelCount;
+            for (int j = 0; j <= 2 * steps; ++j) {
+                levels[j] = setLanes[set].S * exp(T(steps - j) * setLanes[set].logU);
+            }
+            setLevels[set] = levels;
+        }
+
+        // Each strike runs its own single-lane lattices over the shared levels: the induction
+        // loop then vectorizes across nodes, which measured faster than strikes as lanes
+        for (std::size_t i = 0; i < count; ++i) {
+            bool exercisable = params.type == OptionType::American &&
+                               !(style[i] == OptionStyle::Call && params.q == T(0));
+            LatticeNodesT<T, 1> nodes[3];
+            for (int set = 0; set < sets; ++set) {
+                LatticeLaneT<T> lane = setLanes[set];
+                lane.K = K[i];
+                lane.sign = style[i] == OptionStyle::Call ? T(1) : T(-1);
+                lane.exercise = exercisable ? T(1) : T(0);
+                if (exercisable) {
+                    runLattice<T, 1, true>(&lane, steps, workspace, nodes[set], setLevels[set]);
+                } else {
+                    runLattice<T, 1, false>(&lane, steps, workspace, nodes[set], setLevels[set]);
+                }
+            }
+
+            if (!withGreeks) {
+                results.price[i] = nodes[0].root[0];
+                continue;
+            }
+            storeBatchRow(results, i, latticeGreeks(nodes[0], setLanes[0], params.expiry, steps, 0,
+                                                    nodes[1].root[0], nodes[2].root[0]));
+        }
+    } catch (const NumericalError&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw NumericalError("Error in binomial calculation: " + std::string(e.what()));
+    }
+}
+
+namespace {
+
+// Copies the selected rows of a batch into contiguous columns
+template<typename T>
+struct GatheredBatchT {
+    std::vector<T> S, K, r, q, sigma, expiry;
+    std::vector<OptionStyle> style;
+    std::vector<OptionType> type;
+    std::vector<T> price, delta, gamma, theta, vega, rho;
+
+    GatheredBatchT(const OptionBatchT<T>& batch, const std::vector<std::size_t>& rows) {
+        for (std::size_t i : rows) {
+            S.push_back(batch.S[i]);
+            K.push_back(batch.K[i]);
+            r.push_back(batch.r[i]);
+            q.push_back(batch.q[i]);
+            sigma.push_back(batch.sigma[i]);
+            expiry.push_back(batch.expiry[i]);
+            style.push_back(batch.style[i]);
+            type.push_back(batch.type ? batch.type[i] : OptionType::European);
+        }
+        for (auto* column : {&price, &delta, &gamma, &theta, &vega, &rho}) {
+            column->resize(rows.size());
+        }
+    }
+
+    OptionBatchT<T> view() const {
+        return {S.size(), S.data(), K.data(), r.data(), q.data(), sigma.data(), expiry.data(),
+                style.data(), type.data()};
+    }
+
+    PricingResultBatchT<T> results(const PricingResultBatchT<T>& like) {
+        return {price.data(), like.delta ? delta.data() : nullptr, like.gamma ? gamma.data() : nullptr,
+                like.theta ? theta.data() : nullptr, like.vega ? vega.data() : nullptr,
+                like.rho ? rho.data() : nullptr};
+    }
+
+    void scatter(const std::vector<std::size_t>& rows, const PricingResultBatchT<T>& out) const {
+        for (std::size_t j = 0; j < rows.size(); ++j) {
+            out.price[rows[j]] = price[j];
+            if (out.delta) out.delta[rows[j]] = delta[j];
+            if (out.gamma) out.gamma[rows[j]] = gamma[j];
+            if (out.theta) out.theta[rows[j]] = theta[j];
+            if (out.vega) out.vega[rows[j]] = vega[j];
+            if (out.rho) out.rho[rows[j]] = rho[j];
+        }
+    }
+};
+
+} // namespace
+
+template<typename T>
+void priceBatchT(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results, int steps,
+                 ValidationStatus* status) {
+    std::size_t invalid = 0;
+    if (status) {
+        invalid = validateOptionBatchT(batch, status);
+    }
+
+    std::vector<std::size_t> european;
+    std::vector<std::size_t> american;
+    if (batch.type || invalid > 0) {
+        for (std::size_t i = 0; i < batch.size; ++i) {
+            if (invalid > 0 && status[i] != 0) {
+                continue;
+            }
+            bool isEuropean = !batch.type || batch.type[i] == OptionType::European;
+            (isEuropean ? european : american).push_back(i);
+        }
+    }
+
+    BlackScholesModelT<T> blackScholes;
+    BinomialModelT<T> binomial(steps);
+
+    // Single-type batches are priced in place. The Black-Scholes kernels skip invalid rows
+    // themselves; the lattice needs them removed first.
+    if (american.empty()) {
+        blackScholes.calculateBatch(batch, results, status);
+        return;
+    }
+    if (european.empty() && invalid == 0) {
+        binomial.calculateBatch(batch, results);
+        return;
+    }
+
+    // The models validate the gathered rows too, but would name them by their sub-batch index
+    if (!status) {
+        validateOptionBatchT(batch);
+    }
+    if (!european.empty()) {
+        GatheredBatchT<T> europeanRows(batch, european);
+        blackScholes.calculateBatch(europeanRows.view(), europeanRows.results(results));
+        europeanRows.scatter(european, results);
+    }
+    if (!american.empty()) {
+        GatheredBatchT<T> americanRows(batch, american);
+        binomial.calculateBatch(americanRows.view(), americanRows.results(results));
+        americanRows.scatter(american, results);
+    }
+    if (invalid > 0) {
+        markInvalidRows(results, status, batch.size);
+    }
+}
+
+namespace {
+
+// Tasks per worker: enough slack for stealing to even out cost misestimates
+constexpr std::size_t tasksPerWorker = 16;
+
+} // namespace
+
+template<typename T>
+void PricingEngineT<T>::setWorkerCount(std::size_t workers) {
+    pool = std::make_shared<WorkStealingPool>(workers);
+}
+
+template<typename T>
+std::size_t PricingEngineT<T>::workerCount() const {
+    return pool ? pool->size() : WorkStealingPool::shared().size();
+}
+
+template<typename T>
+void PricingEngineT<T>::enableResultCache(const ResultCacheConfig& config) {
+    cache = std::make_shared<PricingResultCacheT<T>>(config);
+}
+
+template<typename T>
+PricingResultT<T> PricingEngineT<T>::cachedPrice(const OptionParametersT<T>& params) const {
+    validateOptionParametersT(params);
+
+    // A value rounded out of range, such as a volatility under half a step, is priced as given
+    OptionParametersT<T> rounded = cache->quantize(params);
+    if (validationStatusT(rounded) != 0) {
+        return calculateWith(modelFor(params), params);
+    }
+
+    PricingResultT<T> result;
+    if (!cache->find(rounded, result)) {
+        result = calculateWith(modelFor(rounded), rounded);
+        cache->insert(rounded, result);
+    }
+    return result;
+}
+
+template<typename T>
+void PricingEngineT<T>::priceBatch(const std::vector<OptionParametersT<T>>& options,
+                                   PricingResultT<T>* results, ValidationStatus* status) const {
+    std::size_t n = options.size();
+    if (n == 0) {
+        return;
+    }
+
+    std::vector<double> cost(n);
+    double totalCost = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        cost[i] = modelFor(options[i]).costEstimate(options[i]);
+        totalCost += cost[i];
+    }
+
+    // Longest jobs first, so the cheap tail is left for balancing at the end
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return cost[a] > cost[b]; });
+
+    // Cut the sorted list into tasks of about equal cost. Expensive options end up in
+    // tasks of their own; thousands of cheap ones share a task.
+    WorkStealingPool& workers = pool ? *pool : WorkStealingPool::shared();
+    double target = totalCost / double(workers.size() * tasksPerWorker);
+    std::vector<std::size_t> taskBegin{0};
+    double taskCost = 0.0;
+    for (std::size_t k = 0; k < n; ++k) {
+        taskCost += cost[order[k]];
+        if (taskCost >= target && k + 1 < n) {
+            taskBegin.push_back(k + 1);
+            taskCost = 0.0;
+        }
+    }
+    taskBegin.push_back(n);
+
+    workers.run(taskBegin.size() - 1, [&](std::size_t task) {
+        for (std::size_t k = taskBegin[task]; k < taskBegin[task + 1]; ++k) {
+            const OptionParametersT<T>& params = options[order[k]];
+            if (status) {
+                status[order[k]] = validationStatusT(params);
+                if (status[order[k]] != 0) {
+                    T nan = T(std::numeric_limits<double>::quiet_NaN());
+                    results[order[k]] = {nan, {nan, nan, nan, nan, nan}};
+                    continue;
+                }
+            }
+            results[order[k]] = price(params);
+        }
+    });
+}
+
+template<typename T>
+std::vector<PricingResultT<T>> PricingEngineT<T>::pricePortfolio(const std::vector<OptionParametersT<T>>& options) const {
+    std::vector<PricingResultT<T>> results(options.size());
+    priceBatch(options, results.data());
+    return results;
+}
+
 // Explicit instantiations
 template class BlackScholesModelT<double>;
 template class BinomialModelT<double>;
+template class BlackScholesModelT<HyperDual>;
+template class BinomialModelT<HyperDual>;
+template class BlackScholesModelT<Adjoint>;
+template class BinomialModelT<Adjoint>;
 template void validateOptionParametersT<double>(const OptionParametersT<double>&);
+template ValidationStatus validationStatusT<double>(const OptionParametersT<double>&);
+template std::size_t validateOptionBatchT<double>(const OptionBatch&, ValidationStatus*);
+template void priceBatchT<double>(const OptionBatch&, const PricingResultBatch&, int, ValidationStatus*);
+template class PricingEngineT<double>;
+
+#define INSTANTIATE_BINOMIAL_KERNEL(STYLE, TYPE)                                                          \
+    template PricingResultT<double> BinomialKernelT<double>::calculate<STYLE, TYPE>(                      \
+        const OptionParameters&) const;                                                                   \
+    template PricingResultT<double> BinomialKernelT<double>::calculate<STYLE, TYPE>(                      \
+        const OptionParameters&, BinomialWorkspace&) const;                                               \
+    template double BinomialKernelT<double>::calculatePrice<STYLE, TYPE>(const OptionParameters&,         \
+                                                                        BinomialWorkspace&) const;
+INSTANTIATE_BINOMIAL_KERNEL(OptionStyle::Call, OptionType::European)
+INSTANTIATE_BINOMIAL_KERNEL(OptionStyle::Call, OptionType::American)
+INSTANTIATE_BINOMIAL_KERNEL(OptionStyle::Put, OptionType::European)
+INSTANTIATE_BINOMIAL_KERNEL(OptionStyle::Put, OptionType::American)
+#undef INSTANTIATE_BINOMIAL_KERNEL
@@ -3,7 +3,9 @@
 
 #include "types.h"
 #include "pricing_exceptions.h"
+#include "instrumentation.h"
 #include <memory>
+#include <string>
 #include <vector>
 
 // Base model with template parameter
@@ -12,6 +14,10 @@ class PricingModelBaseT {
 public:
     virtual ~PricingModelBaseT() = default;
     virtual PricingResultT<T> calculate(const OptionParametersT<T>& params) const = 0;
+
+    // Rough cost of calculate() relative to one Black-Scholes valuation. Only used to
+    // balance parallel work, so order-of-magnitude accuracy is enough.
+    virtual double costEstimate(const OptionParametersT<T>&) const { return 1.0; }
 };
 
 // Black-Scholes model with template parameter
@@ -19,27 +25,82 @@ template<typename T = double>
 class BlackScholesModelT : public PricingModelBaseT<T> {
 public:
     PricingResultT<T> calculate(const OptionParametersT<T>& params) const override;
+
+    // Prices a columnar batch of European options, writing price and Greeks into results.
+    // Greek columns may be left null. Uses AVX2/AVX-512 kernels for double when available,
+    // otherwise a scalar loop. An invalid row throws OptionPricingError, unless status is
+    // given: the status of every row is then written there and invalid rows get NaN.
+    void calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results,
+                        ValidationStatus* status = nullptr) const;
+
+    // Volatility at which calculate() reproduces price; params.sigma is ignored. Starts from
+    // a Corrado-Miller guess and refines with safeguarded third-order Householder steps.
+    // Throws OptionPricingError when price is outside the no-arbitrage bounds.
+    T impliedVolatility(const OptionParametersT<T>& params, T price) const;
+
+    // Columnar form for whole chains: vols[i] is the implied volatility of prices[i].
+    // batch.sigma is ignored and may be null. Rows whose price admits no volatility get NaN.
+    void impliedVolatilityBatch(const OptionBatchT<T>& batch, const T* prices, T* vols) const;
+
+private:
+    static PricingResultT<T> evaluate(const OptionParametersT<T>& params);
+    static void evaluateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results);
 };
 
-// Binomial model with template parameter
+// Scratch space for binomial valuations. Buffers only grow, so reusing one
+// workspace makes repeated calculations allocation-free.
+template<typename T = double>
+struct BinomialWorkspaceT {
+    std::vector<T> priceTree;
+    std::vector<T> exerciseValues;
+    std::vector<T> spotLevels;
+};
+
+// Binomial model with template parameter. The model itself is immutable and may be
+// shared across threads; all per-call state lives in a BinomialWorkspaceT.
 template<typename T = double>
 class BinomialModelT : public PricingModelBaseT<T> {
-    mutable std::vector<T> priceTree;
     int steps;
 
 public:
-    explicit BinomialModelT(int steps) : priceTree(steps + 1), steps(steps) {}
+    explicit BinomialModelT(int steps) : steps(steps) {}
+
+    // Uses a workspace owned by the calling thread
     PricingResultT<T> calculate(const OptionParametersT<T>& params) const override;
+    PricingResultT<T> calculate(const OptionParametersT<T>& params, BinomialWorkspaceT<T>& workspace) const;
+
+    double costEstimate(const OptionParametersT<T>&) const override { return 1.0 + double(steps) * steps / 256.0; }
+
+    // Price only, without Greeks
+    T calculatePrice(const OptionParametersT<T>& params) const;
+    T calculatePrice(const OptionParametersT<T>& params, BinomialWorkspaceT<T>& workspace) const;
+
+    // Prices a columnar batch row by row with the single-option tree, reusing one workspace;
+    // there is no lattice across options. Leave the Greek columns null to compute prices
+    // only. Any Greek column set computes all five Greeks and writes the ones requested.
+    void calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results) const;
+    void calculateBatch(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results,
+                        BinomialWorkspaceT<T>& workspace) const;
+
+    // Prices options that differ from params only in strike and style, such as one expiry
+    // of a chain. They share one lattice setup: the transition probabilities and spot levels
+    // are computed once for all strikes. Results are as for calculateBatch.
+    void calculateStrikes(const OptionParametersT<T>& params, std::size_t count, const T* K,
+                          const OptionStyle* style, const PricingResultBatchT<T>& results) const;
+
+    // Volatility at which calculatePrice() reproduces price, found by bracketed root search
+    // seeded with the Black-Scholes implied volatility; params.sigma is ignored
+    T impliedVolatility(const OptionParametersT<T>& params, T price) const;
     
 private:
-    T calculatePrice(const OptionParametersT<T>& params) const;
-    T calculateBinomialPrice(const OptionParametersT<T>& params) const;
+    static BinomialWorkspaceT<T>& threadWorkspace();
 };
 
 // Type aliases for backward compatibility
 using PricingModelBase = PricingModelBaseT<double>;
 using BlackScholesModel = BlackScholesModelT<double>;
 using BinomialModel = BinomialModelT<double>;
+using BinomialWorkspace = BinomialWorkspaceT<double>;
 
 template<typename T = double>
 using PricingModelPtr = std::unique_ptr<PricingModelBaseT<T>>;
@@ -54,31 +115,140 @@ PricingModelPtr<T> createPricingModelT(OptionType type, int steps = 500) {
     }
 }
 
+// Factory that picks the American model explicitly, trading speed against accuracy.
+// Defined alongside the models in american_models.cpp; steps only applies to Binomial.
+// CrankNicolson uses the default grid of CrankNicolsonModelT.
+template<typename T = double>
+PricingModelPtr<T> createPricingModelT(OptionType type, AmericanModel americanModel, int steps = 500);
+
 // Type alias for backward compatibility
 inline std::unique_ptr<PricingModelBase> createPricingModel(OptionType type, int steps = 500) {
     return createPricingModelT<double>(type, steps);
 }
 
+inline std::unique_ptr<PricingModelBase> createPricingModel(OptionType type, AmericanModel americanModel,
+                                                            int steps = 500) {
+    return createPricingModelT<double>(type, americanModel, steps);
+}
+
+// Batch counterpart of createPricingModelT: European rows are priced by the Black-Scholes
+// kernels and American rows by the binomial lattice with the given step count.
+// Invalid rows throw as in calculateBatch, or with status given are skipped: their status
+// is reported there and their outputs are NaN.
+template<typename T>
+void priceBatchT(const OptionBatchT<T>& batch, const PricingResultBatchT<T>& results, int steps = 500,
+                 ValidationStatus* status = nullptr);
+
+inline void priceBatch(const OptionBatch& batch, const PricingResultBatch& results, int steps = 500,
+                       ValidationStatus* status = nullptr) {
+    priceBatchT<double>(batch, results, steps, status);
+}
+
+// Implied volatility for either option type: Black-Scholes for European options, the
+// binomial tree with the given step count for American ones
+template<typename T>
+T impliedVolatilityT(const OptionParametersT<T>& params, T price, int steps = 500);
+
+inline double impliedVolatility(const OptionParameters& params, double price, int steps = 500) {
+    return impliedVolatilityT<double>(params, price, steps);
+}
+
+class WorkStealingPool;
+struct ResultCacheConfig;
+template<typename T> class PricingResultCacheT;
+
 // Template version of the pricing engine
 template<typename T = double>
 class PricingEngineT {
     std::shared_ptr<PricingModelBaseT<T>> model;
+    std::shared_ptr<PricingModelBaseT<T>> americanModel;   // Optional override for American options
+    std::shared_ptr<WorkStealingPool> pool;                // Null means the process-wide default pool
+    std::shared_ptr<PricingResultCacheT<T>> cache;         // Optional
+
+    const PricingModelBaseT<T>& modelFor(const OptionParametersT<T>& params) const {
+        const auto& chosen = (americanModel && params.type == OptionType::American) ? americanModel : model;
+        if (!chosen) {
+            throw OptionPricingError("Pricing model not initialized");
+        }
+        return *chosen;
+    }
+
+    // Prices with the given model, timing the call and counting its exceptions when
+    // instrumentation is compiled in
+    static PricingResultT<T> calculateWith(const PricingModelBaseT<T>& model, const OptionParametersT<T>& params) {
+#if OPTION_PRICING_INSTRUMENTATION
+        InstrumentationClock::time_point start = InstrumentationClock::now();
+        try {
+            PricingResultT<T> result = model.calculate(params);
+            recordModelCall(typeid(model), nanosecondsSince(start));
+            return result;
+        } catch (...) {
+            recordCurrentException();
+            throw;
+        }
+#else
+        return model.calculate(params);
+#endif
+    }
+
+    PricingResultT<T> cachedPrice(const OptionParametersT<T>& params) const;
 
 public:
     explicit PricingEngineT(std::shared_ptr<PricingModelBaseT<T>> model) 
         : model(std::move(model)) {}
+
+    // Prices European options with Black-Scholes and American options with the chosen model
+    explicit PricingEngineT(AmericanModel american, int steps = 500)
+        : model(createPricingModelT<T>(OptionType::European)),
+          americanModel(createPricingModelT<T>(OptionType::American, american, steps)) {}
     
     PricingResultT<T> price(const OptionParametersT<T>& params) const {
-        if (!model) {
-            throw OptionPricingError("Pricing model not initialized");
+        if (cache) {
+            return cachedPrice(params);
         }
-        return model->calculate(params);
+        return calculateWith(modelFor(params), params);
     }
+
+    // Puts a result cache (result_cache.h) in front of price() and priceBatch(), shared by
+    // copies of this engine. A repeated request then costs a hash lookup. With quantization
+    // steps configured, options are priced at their rounded parameters.
+    void enableResultCache(const ResultCacheConfig& config);
+    void disableResultCache() { cache.reset(); }
+    // Null unless a cache is enabled
+    PricingResultCacheT<T>* resultCache() const { return cache.get(); }
+
+    // Gives this engine (and its copies) a dedicated pool of the given size instead of the
+    // shared one sized to the hardware. Zero selects the hardware concurrency.
+    void setWorkerCount(std::size_t workers);
+    std::size_t workerCount() const;
+
+    // Prices every option in parallel, writing results[i] for options[i]. results must hold
+    // options.size() entries. Options are grouped into tasks of similar estimated cost,
+    // most expensive first, and spread over the pool's work-stealing queues. With status
+    // given, invalid options are skipped instead of throwing: status[i] reports each one
+    // and its result is NaN.
+    void priceBatch(const std::vector<OptionParametersT<T>>& options, PricingResultT<T>* results,
+                    ValidationStatus* status = nullptr) const;
+
+    std::vector<PricingResultT<T>> pricePortfolio(const std::vector<OptionParametersT<T>>& options) const;
 };
 
 // Type alias for backward compatibility
 using PricingEngine = PricingEngineT<double>;
 
+// Status of one option, without allocating or throwing
+template<typename T>
+ValidationStatus validationStatusT(const OptionParametersT<T>& params);
+
+// Writes the status of every row of batch to status[0, batch.size) in one branch-free pass
+// over the columns and returns the number of invalid rows
+template<typename T>
+std::size_t validateOptionBatchT(const OptionBatchT<T>& batch, ValidationStatus* status);
+
+// Error message for the lowest set bit of a nonzero status
+std::string validationMessage(ValidationStatus status);
+
+// Throws OptionPricingError with validationMessage when params is invalid
 template<typename T>
 void validateOptionParametersT(const OptionParametersT<T>& params);
 
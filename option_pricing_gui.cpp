@@ -1,15 +1,46 @@
 #include "option_pricing_gui.h"
 #include <QtWidgets/QVBoxLayout>
-#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QHBoxLayout>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QElapsedTimer>
+#include "american_models.h"
+#include "instrumentation.h"
+#include "result_cache.h"
+#include <algorithm>
 
 OptionPricingGUI::OptionPricingGUI(QWidget *parent) : QMainWindow(parent) {
     setWindowTitle("Option Pricing Calculator");
+    engine.enableResultCache(ResultCacheConfig());
+
+    // Two workers, so a new job need not wait for a stale one to finish its current stage
+    workers.setMaxThreadCount(2);
+    scenarioWorker.setMaxThreadCount(1);
+
+    // Typing or holding a spin arrow changes the inputs faster than a tree prices them;
+    // recalculate once they have been still for a moment
+    debounceTimer = new QTimer(this);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(100);
+    connect(debounceTimer, &QTimer::timeout, this, &OptionPricingGUI::calculateOption);
+
     setupUI();
+    calculateOption();
+}
+
+OptionPricingGUI::~OptionPricingGUI() {
+    // Running jobs use the engine and post back to this window
+    ++generation;
+    ++scenarioGeneration;
+    workers.clear();
+    scenarioWorker.clear();
+    workers.waitForDone();
+    scenarioWorker.waitForDone();
 }
 
 void OptionPricingGUI::setupUI() {
     QWidget *centralWidget = new QWidget(this);
-    QVBoxLayout *mainLayout = new QVBoxLayout(centralWidget);
+    QHBoxLayout *mainLayout = new QHBoxLayout(centralWidget);
+    QVBoxLayout *contractLayout = new QVBoxLayout;
     
     QGroupBox* inputGroup = createInputGroup();
     QGroupBox* outputGroup = createOutputGroup();
@@ -18,13 +49,24 @@ void OptionPricingGUI::setupUI() {
     QPushButton *calculateButton = new QPushButton("Calculate", this);
     connect(calculateButton, &QPushButton::clicked, this, &OptionPricingGUI::calculateOption);
     
-    // Add widgets to main layout
-    mainLayout->addWidget(inputGroup);
-    mainLayout->addWidget(outputGroup);
-    mainLayout->addWidget(calculateButton);
+    // Contract on the left, its scenario heatmap on the right
+    contractLayout->addWidget(inputGroup);
+    contractLayout->addWidget(outputGroup);
+    contractLayout->addWidget(calculateButton);
+    mainLayout->addLayout(contractLayout);
+    mainLayout->addWidget(createScenarioGroup(), 1);
+
+    // Statistics panel for instrumented builds; wider to fit the tables
+    if (instrumentationSnapshot().enabled) {
+        contractLayout->addWidget(createStatisticsGroup());
+        setCentralWidget(centralWidget);
+        setFixedSize(1360, 960);
+        refreshStatistics();
+        return;
+    }
     
     setCentralWidget(centralWidget);
-    setFixedSize(400, 600);
+    setFixedSize(1000, 600);
 }
 
 QDoubleSpinBox* OptionPricingGUI::createDoubleSpinBox(double min, double max, double step, int decimals) {
@@ -59,6 +101,17 @@ QGroupBox* OptionPricingGUI::createInputGroup() {
     optionStyleCombo->addItem("Call");
     optionStyleCombo->addItem("Put");
 
+    // Recalculate whenever an input changes
+    for (QDoubleSpinBox* input : {stockPriceInput, strikePriceInput, riskFreeRateInput, volatilityInput,
+                                  timeToExpiryInput, dividendYieldInput}) {
+        connect(input, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+                this, &OptionPricingGUI::scheduleCalculation);
+    }
+    for (QComboBox* input : {optionTypeCombo, optionStyleCombo}) {
+        connect(input, QOverload<int>::of(&QComboBox::currentIndexChanged),
+                this, &OptionPricingGUI::scheduleCalculation);
+    }
+
     // Add widgets to layout
     int row = 0;
     layout->addWidget(new QLabel("Stock Price:"), row, 0);
@@ -97,6 +150,8 @@ QGroupBox* OptionPricingGUI::createOutputGroup() {
     vegaLabel = new QLabel("-");
     rhoLabel = new QLabel("-");
     modelLabel = new QLabel("-");
+    statusLabel = new QLabel("-");
+    statusLabel->setWordWrap(true);
 
     // Set the fixed-width font for all labels
     for (QLabel* label : {priceLabel, deltaLabel, gammaLabel, thetaLabel, vegaLabel, rhoLabel, modelLabel}) {
@@ -121,49 +176,257 @@ QGroupBox* OptionPricingGUI::createOutputGroup() {
     layout->addWidget(vegaLabel, row++, 1);
     layout->addWidget(new QLabel("Rho:"), row, 0);
     layout->addWidget(rhoLabel, row++, 1);
+    layout->addWidget(new QLabel("Status:"), row, 0);
+    layout->addWidget(statusLabel, row++, 1);
 
     groupBox->setLayout(layout);
     return groupBox;
 }
 
+QGroupBox* OptionPricingGUI::createScenarioGroup() {
+    QGroupBox *groupBox = new QGroupBox("Scenarios");
+    QVBoxLayout *layout = new QVBoxLayout;
+
+    scenarioAxisCombo = new QComboBox(this);
+    scenarioAxisCombo->addItems({"Spot x Volatility", "Spot x Time to Expiry"});
+    scenarioMetricCombo = new QComboBox(this);
+    scenarioMetricCombo->addItems({"Price", "P&L", "Delta", "Gamma", "Theta", "Vega", "Rho"});
+    scenarioStatusLabel = new QLabel("-");
+    heatmap = new ScenarioHeatmap(this);
+
+    // A new axis needs pricing; a new metric only recolours the cells already priced
+    connect(scenarioAxisCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &OptionPricingGUI::calculateScenarios);
+    connect(scenarioMetricCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &OptionPricingGUI::updateScenarioMetric);
+
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(scenarioAxisCombo);
+    controls->addWidget(scenarioMetricCombo);
+    controls->addStretch();
+    controls->addWidget(scenarioStatusLabel);
+
+    layout->addLayout(controls);
+    layout->addWidget(heatmap, 1);
+    groupBox->setLayout(layout);
+    return groupBox;
+}
+
+QGroupBox* OptionPricingGUI::createStatisticsGroup() {
+    QGroupBox *groupBox = new QGroupBox("Engine Statistics");
+    QVBoxLayout *layout = new QVBoxLayout;
+
+    QFont fixedFont("Monospace");
+    fixedFont.setStyleHint(QFont::Monospace);
+
+    statisticsText = new QPlainTextEdit;
+    statisticsText->setReadOnly(true);
+    statisticsText->setFont(fixedFont);
+    statisticsText->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    QPushButton *refreshButton = new QPushButton("Refresh");
+    QPushButton *resetButton = new QPushButton("Reset");
+    connect(refreshButton, &QPushButton::clicked, this, &OptionPricingGUI::refreshStatistics);
+    connect(resetButton, &QPushButton::clicked, this, &OptionPricingGUI::resetStatistics);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addStretch();
+    buttons->addWidget(refreshButton);
+    buttons->addWidget(resetButton);
+
+    layout->addWidget(statisticsText);
+    layout->addLayout(buttons);
+    groupBox->setLayout(layout);
+    return groupBox;
+}
+
+void OptionPricingGUI::refreshStatistics() {
+    if (statisticsText) {
+        std::string text = formatInstrumentation(instrumentationSnapshot());
+        text += "\n" + formatResultCacheStats(engine.resultCache()->stats()) + "\n";
+        statisticsText->setPlainText(QString::fromStdString(text));
+    }
+}
+
+void OptionPricingGUI::resetStatistics() {
+    resetInstrumentation();
+    refreshStatistics();
+}
+
 void OptionPricingGUI::updateOptionType(int index) {
     modelLabel->setText(index == 0 ? "Black-Scholes" : "Binomial");
 }
 
+OptionParameters OptionPricingGUI::currentParameters() const {
+    OptionParameters params;
+    params.S = stockPriceInput->value();
+    params.K = strikePriceInput->value();
+    params.r = riskFreeRateInput->value();
+    params.sigma = volatilityInput->value();
+    params.expiry = timeToExpiryInput->value();
+    params.q = dividendYieldInput->value();
+    params.type = optionTypeCombo->currentIndex() == 0 ? OptionType::European : OptionType::American;
+    params.style = optionStyleCombo->currentIndex() == 0 ? OptionStyle::Call : OptionStyle::Put;
+    return params;
+}
+
+void OptionPricingGUI::scheduleCalculation() {
+    // The results on screen are stale from now on, so stop any work on them
+    ++generation;
+    ++scenarioGeneration;
+    workers.clear();
+    scenarioWorker.clear();
+    statusLabel->setText("Updating...");
+    scenarioStatusLabel->setText("Updating...");
+    debounceTimer->start();
+}
+
 void OptionPricingGUI::calculateOption() {
-    try {
-        OptionParameters params;
-        params.S = stockPriceInput->value();
-        params.K = strikePriceInput->value();
-        params.r = riskFreeRateInput->value();
-        params.sigma = volatilityInput->value();
-        params.expiry = timeToExpiryInput->value();
-        params.q = dividendYieldInput->value();
-        params.type = optionTypeCombo->currentIndex() == 0 ? OptionType::European : OptionType::American;
-        params.style = optionStyleCombo->currentIndex() == 0 ? OptionStyle::Call : OptionStyle::Put;
-
-        std::unique_ptr<PricingModelBase> model;
-        if (params.type == OptionType::European) {
-            model = std::make_unique<BlackScholesModel>();
-        } else {
-            model = std::make_unique<BinomialModel>(500);
+    debounceTimer->stop();
+    OptionParameters params = currentParameters();
+    std::uint64_t job = ++generation;
+    workers.clear();
+    statusLabel->setText("Calculating...");
+
+    QtConcurrent::run(&workers, [this, params, job] {
+        try {
+            // The tree takes a while at 500 steps; show the Barone-Adesi-Whaley approximation
+            // in the meantime
+            if (params.type == OptionType::American) {
+                postResult(job, BaroneAdesiWhaleyModel().calculate(params), "Barone-Adesi-Whaley", false);
+                if (generation.load() != job) {
+                    return;
+                }
+            }
+            PricingResult result = engine.price(params);
+            postResult(job, result, params.type == OptionType::European ? "Black-Scholes" : "Binomial", true);
+        } catch (const std::exception& e) {
+            postError(job, QString::fromStdString(e.what()));
+        }
+    });
+    calculateScenarios();
+}
+
+void OptionPricingGUI::calculateScenarios() {
+    OptionParameters params = currentParameters();
+    ScenarioAxis axis = scenarioAxisCombo->currentIndex() == 0 ? ScenarioAxis::Volatility : ScenarioAxis::Expiry;
+    std::uint64_t job = ++scenarioGeneration;
+    scenarioWorker.clear();
+    scenarioStatusLabel->setText("Pricing scenarios...");
+
+    QtConcurrent::run(&scenarioWorker, [this, params, axis, job] {
+        try {
+            // At least 100 x 100 cells: spot from half to one and a half times the current
+            // level, volatility up to 100% or twice the current, expiry up to the current
+            std::vector<double> spots = scenarioAxis(0.5 * params.S, 1.5 * params.S, 100);
+            std::vector<double> levels = axis == ScenarioAxis::Volatility
+                                             ? scenarioAxis(0.0, std::max(1.0, 2.0 * params.sigma), 100)
+                                             : scenarioAxis(0.0, params.expiry, 100);
+            std::size_t unpriced = scenarioGrid.setScenarios(params, axis, spots, levels, scenarioSteps);
+            postScenarioGrid(job);
+
+            QElapsedTimer timer;
+            timer.start();
+            scenarioGrid.priceMissing([this, job](const ScenarioTile& tile) { postScenarioTile(job, tile); },
+                                      [this, job] { return scenarioGeneration.load() != job; });
+            if (scenarioGeneration.load() == job) {
+                postScenarioStatus(job, QString("%1 x %2 cells, %3 priced in %4 ms")
+                                            .arg(scenarioGrid.columns())
+                                            .arg(scenarioGrid.rows())
+                                            .arg(unpriced)
+                                            .arg(timer.elapsed()));
+            }
+        } catch (const std::exception& e) {
+            postScenarioStatus(job, QString("Error: %1").arg(QString::fromStdString(e.what())));
         }
+    });
+}
 
-        PricingEngine engine(std::move(model));
-        PricingResult result = engine.price(params);
+void OptionPricingGUI::updateScenarioMetric(int index) {
+    heatmap->setMetric(static_cast<ScenarioHeatmap::Metric>(index));
+}
+
+// Called on the scenario worker between pricing runs: sends the new axes and the cells
+// kept from the previous grid
+void OptionPricingGUI::postScenarioGrid(std::uint64_t job) {
+    std::vector<PricingResult> cells;
+    std::vector<unsigned char> known;
+    for (std::size_t row = 0; row < scenarioGrid.rows(); ++row) {
+        for (std::size_t column = 0; column < scenarioGrid.columns(); ++column) {
+            cells.push_back(scenarioGrid.cell(row, column));
+            known.push_back(scenarioGrid.priced(row, column));
+        }
+    }
+    ScenarioAxis axis = scenarioGrid.axis();
+    std::vector<double> spots = scenarioGrid.spots();
+    std::vector<double> levels = scenarioGrid.levels();
+    QMetaObject::invokeMethod(this, [this, job, axis, spots, levels, cells, known] {
+        if (job == scenarioGeneration.load()) {
+            heatmap->setGrid(axis, spots, levels, cells, known);
+        }
+    }, Qt::QueuedConnection);
+}
 
-        displayResults(params, result.price, result.greeks);
-    } catch (const std::exception& e) {
-        QMessageBox::warning(this, "Error", QString("Calculation error: %1").arg(e.what()));
+// Called on a pool thread as a tile completes; only that tile's cells are read, since
+// other tiles are still being written
+void OptionPricingGUI::postScenarioTile(std::uint64_t job, const ScenarioTile& tile) {
+    std::vector<PricingResult> cells;
+    for (std::size_t row = tile.firstRow; row < tile.firstRow + tile.rows; ++row) {
+        for (std::size_t column = tile.firstColumn; column < tile.firstColumn + tile.columns; ++column) {
+            cells.push_back(scenarioGrid.cell(row, column));
+        }
     }
+    QMetaObject::invokeMethod(this, [this, job, tile, cells] {
+        if (job == scenarioGeneration.load()) {
+            heatmap->setTile(tile, cells);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void OptionPricingGUI::postScenarioStatus(std::uint64_t job, const QString& status) {
+    QMetaObject::invokeMethod(this, [this, job, status] {
+        if (job == scenarioGeneration.load()) {
+            scenarioStatusLabel->setText(status);
+        }
+    }, Qt::QueuedConnection);
+}
+
+// Called on a worker: hands the result to the UI thread, which shows it unless the inputs
+// have changed since the job started
+void OptionPricingGUI::postResult(std::uint64_t job, const PricingResult& result, const QString& model,
+                                  bool exact) {
+    QMetaObject::invokeMethod(this, [this, job, result, model, exact] {
+        if (job != generation.load()) {
+            return;
+        }
+        displayResults(result.price, result.greeks, model);
+        if (exact) {
+            heatmap->setReferencePrice(result.price);
+        }
+        statusLabel->setText(exact ? "Up to date" : "Approximate, refining...");
+        refreshStatistics();
+    }, Qt::QueuedConnection);
+}
+
+void OptionPricingGUI::postError(std::uint64_t job, const QString& message) {
+    QMetaObject::invokeMethod(this, [this, job, message] {
+        if (job != generation.load()) {
+            return;
+        }
+        for (QLabel* label : {priceLabel, deltaLabel, gammaLabel, thetaLabel, vegaLabel, rhoLabel, modelLabel}) {
+            label->setText("-");
+        }
+        statusLabel->setText(QString("Calculation error: %1").arg(message));
+        refreshStatistics();
+    }, Qt::QueuedConnection);
 }
 
-void OptionPricingGUI::displayResults(const OptionParameters& params, double price, const Greeks& greeks) {
+void OptionPricingGUI::displayResults(double price, const Greeks& greeks, const QString& model) {
     priceLabel->setText(QString::number(price, 'f', 4));
     deltaLabel->setText(QString::number(greeks.delta, 'f', 4));
     gammaLabel->setText(QString::number(greeks.gamma, 'f', 4));
     thetaLabel->setText(QString::number(greeks.theta, 'f', 4));
     vegaLabel->setText(QString::number(greeks.vega, 'f', 4));
     rhoLabel->setText(QString::number(greeks.rho, 'f', 4));
-    modelLabel->setText(params.type == OptionType::European ? "Black-Scholes" : "Binomial");
-}
\ No newline at end of file
+    modelLabel->setText(model);
+}
@@ -8,17 +8,32 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
+#include <QtWidgets/QPlainTextEdit>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include "option_pricing.h"
+#include "scenario_grid.h"
+#include "scenario_heatmap.h"
+#include <atomic>
+#include <cstdint>
 
 class OptionPricingGUI : public QMainWindow {
     Q_OBJECT
 
 public:
     OptionPricingGUI(QWidget *parent = nullptr);
+    ~OptionPricingGUI() override;
 
 private slots:
+    // Prices the current inputs now; input changes go through the debounce timer first
     void calculateOption();
+    void scheduleCalculation();
     void updateOptionType(int index);
+    // Prices the scenario grid for the current inputs, keeping cells that are unchanged
+    void calculateScenarios();
+    void updateScenarioMetric(int index);
+    void refreshStatistics();
+    void resetStatistics();
 
 private:
     // Input widgets
@@ -39,13 +54,51 @@ private:
     QLabel *vegaLabel;
     QLabel *rhoLabel;
     QLabel *modelLabel;
+    QLabel *statusLabel;
+
+    // Scenario heatmap
+    ScenarioHeatmap *heatmap;
+    QComboBox *scenarioAxisCombo;
+    QComboBox *scenarioMetricCombo;
+    QLabel *scenarioStatusLabel;
+
+    // Engine statistics, present only when instrumentation is compiled in
+    QPlainTextEdit *statisticsText = nullptr;
+
+    // Black-Scholes for European options, a 500-step tree for American ones. Shared by all
+    // recalculations with a result cache, so returning to earlier inputs is a lookup.
+    PricingEngine engine{AmericanModel::Binomial, 500};
+
+    // Live recalculation. Pricing runs on workers, never on the UI thread. Every calculation
+    // starts a new generation: queued jobs of older ones are dropped, a running one skips
+    // its remaining stages, and results arriving for an old generation are ignored.
+    QTimer *debounceTimer;
+    QThreadPool workers;
+    std::atomic<std::uint64_t> generation{0};
+
+    // The scenario grid is filled by one job at a time on its own worker, which spreads the
+    // tiles over the shared pricing pool. Jobs have their own generations, so changing the
+    // axis does not cancel the price above. American cells use a 200-step tree, enough for
+    // a heatmap and about six times cheaper than the engine's.
+    static constexpr int scenarioSteps = 200;
+    ScenarioGrid scenarioGrid;
+    QThreadPool scenarioWorker;
+    std::atomic<std::uint64_t> scenarioGeneration{0};
 
     // Setup methods
     void setupUI();
     QDoubleSpinBox* createDoubleSpinBox(double min, double max, double step, int decimals);
     QGroupBox* createInputGroup();
     QGroupBox* createOutputGroup();
-    void displayResults(const OptionParameters& params, double price, const Greeks& greeks);
+    QGroupBox* createStatisticsGroup();
+    QGroupBox* createScenarioGroup();
+    OptionParameters currentParameters() const;
+    void postResult(std::uint64_t job, const PricingResult& result, const QString& model, bool exact);
+    void postError(std::uint64_t job, const QString& message);
+    void postScenarioGrid(std::uint64_t job);
+    void postScenarioTile(std::uint64_t job, const ScenarioTile& tile);
+    void postScenarioStatus(std::uint64_t job, const QString& status);
+    void displayResults(double price, const Greeks& greeks, const QString& model);
 };
 
 #endif // OPTION_PRICING_GUI_H
\ No newline at end of file
@@ -0,0 +1,730 @@
+// Headless batch pricer. Reads option records from stdin or a file, prices them with a
+// PricingEngine and writes one result per record, in input order, to stdout or a file.
+//
+// Reading and parsing, pricing, and formatting and writing run on three threads joined by
+// queues of fixed-size chunks, so I/O overlaps with compute. A fixed set of chunks
+// circulates between the stages, which bounds memory however long the input is.
+
+#include "option_pricing.h"
+#include "columnar_file.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OPTION_PRICING_HAS_MMAP 1
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const usage =
+    "usage: option_pricing_cli [options] [input]\n"
+    "\n"
+    "Prices the options in input (a file, or stdin when absent or '-') and writes price,\n"
+    "delta, gamma, theta, vega and rho for each, in input order.\n"
+    "\n"
+    "  --format FORMAT       csv, binary or columnar, for input and output (default csv)\n"
+    "  --model NAME          American model: baw, bs2002, alo, binomial, cn (default binomial)\n"
+    "  --steps N             Tree steps for the binomial model (default 500)\n"
+    "  --workers N           Pricing threads, 0 for the hardware concurrency (default 0)\n"
+    "  --chunk N             Records per pipeline chunk (default 8192)\n"
+    "  --output FILE         Write results to FILE instead of stdout\n"
+    "  --convert FILE        Save the input as a columnar positions file instead of pricing\n"
+    "  --stats               Print hot-path statistics to stderr at the end (needs a build\n"
+    "                        with OPTION_PRICING_INSTRUMENTATION)\n"
+    "\n"
+    "CSV input lines hold S,K,r,sigma,expiry,q,type,style, where type is European or\n"
+    "American and style Call or Put (first letters suffice). Blank lines, lines starting\n"
+    "with '#' and a leading header line are skipped. Binary input is a sequence of\n"
+    "BinaryOptionRecord, binary output one of BinaryResultRecord per option, both in\n"
+    "native byte order.\n"
+    "\n"
+    "Columnar input is a positions file (see columnar_file.h), priced in place through the\n"
+    "memory mapping into a columnar results file given by --output. It uses the batch\n"
+    "kernels, Black-Scholes and the binomial lattice, so --model is ignored.\n";
+
+// Fixed-size binary records
+struct BinaryOptionRecord {
+    double S, K, r, sigma, expiry, q;
+    std::uint8_t type;    // 0 European, 1 American
+    std::uint8_t style;   // 0 Call, 1 Put
+    std::uint8_t padding[6];
+};
+
+struct BinaryResultRecord {
+    double price, delta, gamma, theta, vega, rho;
+};
+
+static_assert(sizeof(BinaryOptionRecord) == 56, "BinaryOptionRecord must be packed to 56 bytes");
+static_assert(sizeof(BinaryResultRecord) == 48, "BinaryResultRecord must be packed to 48 bytes");
+
+enum class Format { Csv, Binary, Columnar };
+
+struct Settings {
+    Format format = Format::Csv;
+    AmericanModel model = AmericanModel::Binomial;
+    int steps = 500;
+    std::size_t workers = 0;
+    std::size_t chunkSize = 8192;
+    std::string input = "-";
+    std::string output = "-";
+    std::string convertTo;   // Positions file to write instead of pricing
+    bool stats = false;
+};
+
+// Stages fail by throwing; the message is printed by main
+class CliError : public std::runtime_error {
+public:
+    CliError(const std::string& message) : std::runtime_error(message) {}
+};
+
+// Unit of work passed between the stages
+struct Chunk {
+    std::vector<OptionParameters> options;
+    std::vector<PricingResult> results;
+    std::string text;   // Formatted output
+};
+
+// Unbounded queue of chunks. Its size is bounded by the number of chunks in circulation.
+class ChunkQueue {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::unique_ptr<Chunk>> chunks;
+    bool closed = false;
+
+public:
+    void push(std::unique_ptr<Chunk> chunk) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks.push_back(std::move(chunk));
+        }
+        ready.notify_one();
+    }
+
+    // Null once the queue is closed and drained
+    std::unique_ptr<Chunk> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return closed || !chunks.empty(); });
+        if (chunks.empty()) {
+            return nullptr;
+        }
+        std::unique_ptr<Chunk> chunk = std::move(chunks.front());
+        chunks.pop_front();
+        return chunk;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+};
+
+// Contiguous view of the input that grows as it is consumed. A file is memory-mapped and
+// visible whole from the start; a stream is read in blocks, keeping any partial record.
+class InputBuffer {
+    std::FILE* stream = nullptr;
+    bool ownsStream = false;
+    std::vector<char> buffer;
+    const char* mapped = nullptr;
+    std::size_t mappedSize = 0;
+    const char* cursor = nullptr;
+    const char* limit = nullptr;
+    bool exhausted = false;
+
+    static constexpr std::size_t blockSize = std::size_t(1) << 20;
+
+public:
+    explicit InputBuffer(const std::string& path) {
+        if (path == "-") {
+            stream = stdin;
+            return;
+        }
+#ifdef OPTION_PRICING_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw CliError("cannot open " + path + ": " + std::strerror(errno));
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+            mappedSize = std::size_t(info.st_size);
+            if (mappedSize > 0) {
+                void* address = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED) {
+                    ::close(fd);
+                    throw CliError("cannot map " + path + ": " + std::strerror(errno));
+                }
+                ::madvise(address, mappedSize, MADV_SEQUENTIAL);
+                mapped = static_cast<const char*>(address);
+            }
+            ::close(fd);
+            cursor = mapped;
+            limit = mapped + mappedSize;
+            exhausted = true;
+            return;
+        }
+        ::close(fd);   // Pipes and devices are read as streams
+#endif
+        stream = std::fopen(path.c_str(), "rb");
+        if (!stream) {
+            throw CliError("cannot open " + path + ": " + std::strerror(errno));
+        }
+        ownsStream = true;
+    }
+
+    ~InputBuffer() {
+#ifdef OPTION_PRICING_HAS_MMAP
+        if (mapped) {
+            ::munmap(const_cast<char*>(mapped), mappedSize);
+        }
+#endif
+        if (ownsStream) {
+            std::fclose(stream);
+        }
+    }
+
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+
+    const char* begin() const { return cursor; }
+    const char* end() const { return limit; }
+
+    // True once end() is the end of the input
+    bool atEnd() const { return exhausted; }
+
+    void consume(const char* position) { cursor = position; }
+
+    // Reads more input after the unconsumed bytes. False at the end of the input.
+    bool refill() {
+        if (exhausted) {
+            return false;
+        }
+        std::size_t kept = std::size_t(limit - cursor);
+        if (kept > 0 && cursor != buffer.data()) {
+            std::memmove(buffer.data(), cursor, kept);
+        }
+        buffer.resize(std::max(buffer.size(), kept + blockSize));
+        std::size_t read = std::fread(buffer.data() + kept, 1, buffer.size() - kept, stream);
+        if (read == 0) {
+            if (std::ferror(stream)) {
+                throw CliError(std::string("read failed: ") + std::strerror(errno));
+            }
+            exhausted = true;
+        }
+        cursor = buffer.data();
+        limit = cursor + kept + read;
+        return true;
+    }
+};
+
+bool startsWithIgnoringCase(const char* text, const char* end, char letter) {
+    return text < end && std::tolower(static_cast<unsigned char>(*text)) == letter;
+}
+
+// Parses one CSV line without its terminator; false for lines that hold no record
+bool parseCsvLine(const char* begin, const char* end, std::size_t lineNumber, OptionParameters& params) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    if (begin == end || *begin == '#') {
+        return false;
+    }
+    if (lineNumber == 1 && std::isalpha(static_cast<unsigned char>(*begin))) {
+        return false;   // Header
+    }
+
+    // strtod needs a terminated string; lines are short, so copy
+    char line[512];
+    std::size_t length = std::size_t(end - begin);
+    if (length >= sizeof(line)) {
+        throw CliError("line " + std::to_string(lineNumber) + ": too long");
+    }
+    std::memcpy(line, begin, length);
+    line[length] = '\0';
+
+    auto fail = [&](const char* what) {
+        return CliError("line " + std::to_string(lineNumber) + ": " + what);
+    };
+
+    double* numbers[] = {&params.S, &params.K, &params.r, &params.sigma, &params.expiry, &params.q};
+    char* field = line;
+    for (double* number : numbers) {
+        char* next = nullptr;
+        *number = std::strtod(field, &next);
+        if (next == field) {
+            throw fail("expected a number");
+        }
+        while (*next == ' ' || *next == '\t') {
+            ++next;
+        }
+        if (*next != ',') {
+            throw fail("expected eight comma-separated fields");
+        }
+        field = next + 1;
+    }
+    while (*field == ' ' || *field == '\t') {
+        ++field;
+    }
+    char* fieldEnd = field + std::strlen(field);
+
+    if (startsWithIgnoringCase(field, fieldEnd, 'e')) {
+        params.type = OptionType::European;
+    } else if (startsWithIgnoringCase(field, fieldEnd, 'a')) {
+        params.type = OptionType::American;
+    } else {
+        throw fail("type must be European or American");
+    }
+    char* comma = std::strchr(field, ',');
+    if (!comma) {
+        throw fail("expected eight comma-separated fields");
+    }
+    field = comma + 1;
+    while (*field == ' ' || *field == '\t') {
+        ++field;
+    }
+    if (startsWithIgnoringCase(field, fieldEnd, 'c')) {
+        params.style = OptionStyle::Call;
+    } else if (startsWithIgnoringCase(field, fieldEnd, 'p')) {
+        params.style = OptionStyle::Put;
+    } else {
+        throw fail("style must be Call or Put");
+    }
+    return true;
+}
+
+// Fills chunk.options with up to chunkSize records; false once the input is exhausted
+class RecordReader {
+    InputBuffer input;
+    Format format;
+    std::size_t lineNumber = 0;
+    std::size_t recordNumber = 0;
+
+public:
+    RecordReader(const std::string& path, Format format) : input(path), format(format) {}
+
+    bool read(Chunk& chunk, std::size_t chunkSize) {
+        chunk.options.clear();
+        while (chunk.options.size() < chunkSize) {
+            if (!(format == Format::Csv ? readCsv(chunk, chunkSize) : readBinary(chunk, chunkSize))) {
+                break;
+            }
+        }
+        return !chunk.options.empty();
+    }
+
+private:
+    void check(const OptionParameters& params, std::size_t position, const char* unit) {
+        try {
+            validateOptionParameters(params);
+        } catch (const std::exception& e) {
+            throw CliError(std::string(unit) + " " + std::to_string(position) + ": " + e.what());
+        }
+    }
+
+    // Parses the complete lines in the buffer; false when no more input can follow
+    bool readCsv(Chunk& chunk, std::size_t chunkSize) {
+        const char* position = input.begin();
+        const char* end = input.end();
+        while (chunk.options.size() < chunkSize) {
+            const char* newline = static_cast<const char*>(std::memchr(position, '\n', std::size_t(end - position)));
+            if (!newline && !(input.atEnd() && position < end)) {
+                break;   // Partial line, or nothing left
+            }
+            const char* lineEnd = newline ? newline : end;
+            const char* trimmed = lineEnd;
+            if (trimmed > position && trimmed[-1] == '\r') {
+                --trimmed;
+            }
+            OptionParameters params;
+            if (parseCsvLine(position, trimmed, ++lineNumber, params)) {
+                check(params, lineNumber, "line");
+                chunk.options.push_back(params);
+            }
+            position = newline ? newline + 1 : end;
+        }
+        input.consume(position);
+        if (chunk.options.size() == chunkSize) {
+            return true;
+        }
+        return input.refill();
+    }
+
+    bool readBinary(Chunk& chunk, std::size_t chunkSize) {
+        const char* position = input.begin();
+        const char* end = input.end();
+        while (chunk.options.size() < chunkSize && std::size_t(end - position) >= sizeof(BinaryOptionRecord)) {
+            BinaryOptionRecord record;
+            std::memcpy(&record, position, sizeof(record));
+            position += sizeof(record);
+            OptionParameters params;
+            params.S = record.S;
+            params.K = record.K;
+            params.r = record.r;
+            params.sigma = record.sigma;
+            params.expiry = record.expiry;
+            params.q = record.q;
+            params.type = record.type ? OptionType::American : OptionType::European;
+            params.style = record.style ? OptionStyle::Put : OptionStyle::Call;
+            check(params, ++recordNumber, "record");
+            chunk.options.push_back(params);
+        }
+        input.consume(position);
+        if (chunk.options.size() == chunkSize) {
+            return true;
+        }
+        if (input.refill()) {
+            return true;
+        }
+        if (position != end) {
+            throw CliError("input ends inside a binary record");
+        }
+        return false;
+    }
+};
+
+void formatResults(Chunk& chunk, Format format) {
+    chunk.text.clear();
+    if (format == Format::Binary) {
+        chunk.text.resize(chunk.results.size() * sizeof(BinaryResultRecord));
+        char* out = &chunk.text[0];
+        for (const PricingResult& result : chunk.results) {
+            BinaryResultRecord record{result.price, result.greeks.delta, result.greeks.gamma,
+                                      result.greeks.theta, result.greeks.vega, result.greeks.rho};
+            std::memcpy(out, &record, sizeof(record));
+            out += sizeof(record);
+        }
+        return;
+    }
+    char line[160];
+    for (const PricingResult& result : chunk.results) {
+        int length = std::snprintf(line, sizeof(line), "%.10g,%.10g,%.10g,%.10g,%.10g,%.10g\n",
+                                   result.price, result.greeks.delta, result.greeks.gamma,
+                                   result.greeks.theta, result.greeks.vega, result.greeks.rho);
+        chunk.text.append(line, std::size_t(length));
+    }
+}
+
+std::size_t parseCount(const char* text, const char* option) {
+    char* end = nullptr;
+    long long value = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || value < 0) {
+        throw CliError(std::string(option) + " expects a non-negative integer");
+    }
+    return std::size_t(value);
+}
+
+Settings parseArguments(int argc, char* argv[]) {
+    Settings settings;
+    bool haveInput = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                throw CliError(argument + " expects a value");
+            }
+            return argv[++i];
+        };
+        if (argument == "--help" || argument == "-h") {
+            std::fputs(usage, stdout);
+            std::exit(0);
+        } else if (argument == "--format") {
+            std::string format = value();
+            if (format == "csv") {
+                settings.format = Format::Csv;
+            } else if (format == "binary") {
+                settings.format = Format::Binary;
+            } else if (format == "columnar") {
+                settings.format = Format::Columnar;
+            } else {
+                throw CliError("unknown format " + format);
+            }
+        } else if (argument == "--model") {
+            std::string model = value();
+            if (model == "baw") {
+                settings.model = AmericanModel::BaroneAdesiWhaley;
+            } else if (model == "bs2002") {
+                settings.model = AmericanModel::BjerksundStensland;
+            } else if (model == "alo") {
+                settings.model = AmericanModel::AndersenLakeOffengelt;
+            } else if (model == "binomial") {
+                settings.model = AmericanModel::Binomial;
+            } else if (model == "cn") {
+                settings.model = AmericanModel::CrankNicolson;
+            } else {
+                throw CliError("unknown model " + model);
+            }
+        } else if (argument == "--steps") {
+            settings.steps = int(std::max<std::size_t>(1, parseCount(value(), "--steps")));
+        } else if (argument == "--workers") {
+            settings.workers = parseCount(value(), "--workers");
+        } else if (argument == "--chunk") {
+            settings.chunkSize = std::max<std::size_t>(1, parseCount(value(), "--chunk"));
+        } else if (argument == "--output" || argument == "-o") {
+            settings.output = value();
+        } else if (argument == "--stats") {
+            settings.stats = true;
+        } else if (argument == "--convert") {
+            settings.convertTo = value();
+        } else if (argument.size() > 1 && argument[0] == '-') {
+            throw CliError("unknown option " + argument);
+        } else if (!haveInput) {
+            settings.input = argument;
+            haveInput = true;
+        } else {
+            throw CliError("more than one input given");
+        }
+    }
+    return settings;
+}
+
+// Chunks in circulation: one per stage plus one queued ahead of each
+constexpr int chunkCount = 6;
+
+struct StageTimes {
+    double read = 0.0;
+    double price = 0.0;
+    double write = 0.0;
+};
+
+double secondsBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+int run(const Settings& settings) {
+    RecordReader reader(settings.input, settings.format);
+
+    std::FILE* output = stdout;
+    if (settings.output != "-") {
+        output = std::fopen(settings.output.c_str(), settings.format == Format::Binary ? "wb" : "w");
+        if (!output) {
+            throw CliError("cannot open " + settings.output + ": " + std::strerror(errno));
+        }
+    }
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> outputCloser(output == stdout ? nullptr : output, std::fclose);
+
+    PricingEngine engine(settings.model, settings.steps);
+    if (settings.workers > 0) {
+        engine.setWorkerCount(settings.workers);
+    }
+
+    ChunkQueue free;
+    ChunkQueue parsed;
+    ChunkQueue priced;
+    for (int i = 0; i < chunkCount; ++i) {
+        free.push(std::make_unique<Chunk>());
+    }
+
+    // The first failing stage records its exception and closes every queue, which
+    // unblocks the others
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    auto fail = [&] {
+        {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+        free.close();
+        parsed.close();
+        priced.close();
+    };
+
+    StageTimes busy;
+    std::size_t total = 0;
+    std::size_t firstChunkRecords = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point firstWritten = start;
+    Clock::time_point lastWritten = start;
+
+    std::thread readThread([&] {
+        try {
+            while (std::unique_ptr<Chunk> chunk = free.pop()) {
+                Clock::time_point begin = Clock::now();
+                bool more = reader.read(*chunk, settings.chunkSize);
+                busy.read += secondsBetween(begin, Clock::now());
+                if (!more) {
+                    break;
+                }
+                parsed.push(std::move(chunk));
+            }
+            parsed.close();
+        } catch (...) {
+            fail();
+        }
+    });
+
+    std::thread writeThread([&] {
+        try {
+            while (std::unique_ptr<Chunk> chunk = priced.pop()) {
+                Clock::time_point begin = Clock::now();
+                formatResults(*chunk, settings.format);
+                if (std::fwrite(chunk->text.data(), 1, chunk->text.size(), output) != chunk->text.size()) {
+                    throw CliError(std::string("write failed: ") + std::strerror(errno));
+                }
+                Clock::time_point end = Clock::now();
+                busy.write += secondsBetween(begin, end);
+                if (total == 0) {
+                    firstWritten = end;
+                    firstChunkRecords = chunk->results.size();
+                }
+                lastWritten = end;
+                total += chunk->results.size();
+                free.push(std::move(chunk));
+            }
+            if (std::fflush(output) != 0) {
+                throw CliError(std::string("write failed: ") + std::strerror(errno));
+            }
+        } catch (...) {
+            fail();
+        }
+    });
+
+    // Pricing runs here; the engine spreads each chunk over its own workers
+    try {
+        while (std::unique_ptr<Chunk> chunk = parsed.pop()) {
+            Clock::time_point begin = Clock::now();
+            chunk->results.resize(chunk->options.size());
+            engine.priceBatch(chunk->options, chunk->results.data());
+            busy.price += secondsBetween(begin, Clock::now());
+            priced.push(std::move(chunk));
+        }
+        priced.close();
+    } catch (...) {
+        fail();
+    }
+
+    readThread.join();
+    writeThread.join();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    // Steady state leaves out the first chunk, which carries the pipeline fill
+    double elapsed = secondsBetween(start, lastWritten);
+    double steadyTime = secondsBetween(firstWritten, lastWritten);
+    double steadyRate = steadyTime > 0.0 ? double(total - firstChunkRecords) / steadyTime
+                                         : (elapsed > 0.0 ? double(total) / elapsed : 0.0);
+    std::fprintf(stderr, "priced %zu options in %.3f s, steady state %.0f options/s\n", total, elapsed, steadyRate);
+    std::fprintf(stderr, "busy time: read %.3f s, price %.3f s (%zu workers), write %.3f s\n", busy.read,
+                 busy.price, engine.workerCount(), busy.write);
+    return 0;
+}
+
+// Reads the whole input into columns and saves it as a positions file
+int convert(const Settings& settings) {
+    if (settings.format == Format::Columnar) {
+        throw CliError("--convert reads csv or binary input");
+    }
+    Clock::time_point start = Clock::now();
+    RecordReader reader(settings.input, settings.format);
+    std::vector<double> S, K, r, sigma, expiry, q;
+    std::vector<OptionStyle> style;
+    std::vector<OptionType> type;
+    Chunk chunk;
+    while (reader.read(chunk, settings.chunkSize)) {
+        for (const OptionParameters& params : chunk.options) {
+            S.push_back(params.S);
+            K.push_back(params.K);
+            r.push_back(params.r);
+            sigma.push_back(params.sigma);
+            expiry.push_back(params.expiry);
+            q.push_back(params.q);
+            style.push_back(params.style);
+            type.push_back(params.type);
+        }
+    }
+    OptionBatch batch{S.size(), S.data(), K.data(), r.data(), q.data(), sigma.data(), expiry.data(),
+                      style.data(), type.data()};
+    writePositionsFile(settings.convertTo, batch);
+    std::fprintf(stderr, "converted %zu options in %.3f s\n", batch.size, secondsBetween(start, Clock::now()));
+    return 0;
+}
+
+// Prices a positions file chunk by chunk from its mapping straight into a mapped results
+// file. There is nothing to parse or format, so no pipeline is needed.
+int runColumnar(const Settings& settings) {
+    if (settings.input == "-" || settings.output == "-") {
+        throw CliError("columnar format needs an input file and --output");
+    }
+    Clock::time_point start = Clock::now();
+    PositionsFileReader positions(settings.input);
+    ResultsFileWriter results(settings.output, positions.size());
+    Clock::time_point loaded = Clock::now();
+
+    // Invalid rows are skipped, left as NaN in the results file and reported below
+    WorkStealingPool pool(settings.workers);
+    std::size_t n = positions.size();
+    std::vector<ValidationStatus> status(n);
+    std::size_t chunks = (n + settings.chunkSize - 1) / settings.chunkSize;
+    pool.run(chunks, [&](std::size_t c) {
+        std::size_t first = c * settings.chunkSize;
+        std::size_t count = std::min(settings.chunkSize, n - first);
+        priceBatch(positions.batch(first, count), results.batch(first, count), settings.steps,
+                   status.data() + first);
+    });
+    Clock::time_point priced = Clock::now();
+    results.close();
+    Clock::time_point end = Clock::now();
+
+    constexpr std::size_t reportedRows = 10;
+    std::size_t invalid = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (status[i] != 0 && ++invalid <= reportedRows) {
+            std::fprintf(stderr, "record %zu: %s\n", i + 1, validationMessage(status[i]).c_str());
+        }
+    }
+    if (invalid > 0) {
+        std::fprintf(stderr, "skipped %zu invalid records%s\n", invalid, invalid > reportedRows ? ", first 10 shown" : "");
+    }
+
+    double elapsed = secondsBetween(start, end);
+    std::fprintf(stderr, "priced %zu options in %.3f s, %.0f options/s\n", n, elapsed,
+                 elapsed > 0.0 ? double(n) / elapsed : 0.0);
+    std::fprintf(stderr, "map %.3f s, price %.3f s (%zu workers), write back %.3f s\n",
+                 secondsBetween(start, loaded), secondsBetween(loaded, priced), pool.size(),
+                 secondsBetween(priced, end));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        Settings settings = parseArguments(argc, argv);
+        if (!settings.convertTo.empty()) {
+            return convert(settings);
+        }
+        int status = settings.format == Format::Columnar ? runColumnar(settings) : run(settings);
+        if (settings.stats) {
+            std::fputs(formatInstrumentation(instrumentationSnapshot()).c_str(), stderr);
+        }
+        return status;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "option_pricing_cli: %s\n", e.what());
+        return 1;
+    }
+}
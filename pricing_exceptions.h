@@ -14,6 +14,12 @@ public:
     NumericalError(const std::string& message) : OptionPricingError("Numerical Error: " + message) {}
 };
 
+// Unreadable, unwritable or malformed data files
+class DataFileError : public OptionPricingError {
+public:
+    DataFileError(const std::string& message) : OptionPricingError(message) {}
+};
+
 class InputValidationError : public std::runtime_error {
 public:
     InputValidationError(const std::string& message) : std::runtime_error(message) {}
@@ -0,0 +1,176 @@
+#include "result_cache.h"
+#include "pricing_exceptions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Largest multiple of a step that still converts to a 64-bit integer
+constexpr double quantizedLimit = 4.0e18;
+
+inline double roundToStep(double value, double step) {
+    if (step <= 0.0 || !(std::abs(value / step) < quantizedLimit)) {
+        return value;
+    }
+    return std::round(value / step) * step;
+}
+
+// Bucket of a value: its multiple of step, or its bit pattern for exact keys
+inline std::int64_t keyField(double value, double step) {
+    if (step > 0.0 && std::abs(value / step) < quantizedLimit) {
+        return std::int64_t(std::llround(value / step));
+    }
+    std::int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+template<typename T>
+PricingResultCacheT<T>::PricingResultCacheT(const ResultCacheConfig& config) : settings(config) {
+    if (settings.shards == 0) {
+        throw OptionPricingError("Result cache needs at least one shard");
+    }
+    shardCapacity = std::max<std::size_t>(1, settings.memoryLimit / (settings.shards * entryBytes()));
+    for (std::size_t i = 0; i < settings.shards; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+template<typename T>
+std::size_t PricingResultCacheT<T>::entryBytes() {
+    // List node: entry and two links. Index node: key, iterator, link and cached hash,
+    // plus about one bucket pointer per entry.
+    return sizeof(Entry) + 2 * sizeof(void*) + sizeof(Key) + sizeof(typename std::list<Entry>::iterator) +
+           3 * sizeof(void*);
+}
+
+template<typename T>
+bool PricingResultCacheT<T>::Key::operator==(const Key& other) const {
+    return std::equal(fields, fields + 6, other.fields) && style == other.style && type == other.type;
+}
+
+template<typename T>
+std::size_t PricingResultCacheT<T>::KeyHash::operator()(const Key& key) const {
+    std::uint64_t h = (std::uint64_t(key.style) << 8) | std::uint64_t(key.type);
+    for (std::int64_t field : key.fields) {
+        h = mix(h ^ std::uint64_t(field));
+    }
+    return std::size_t(h);
+}
+
+template<typename T>
+OptionParametersT<T> PricingResultCacheT<T>::quantize(const OptionParametersT<T>& params) const {
+    OptionParametersT<T> rounded = params;
+    rounded.S = roundToStep(params.S, settings.spotStep);
+    rounded.K = roundToStep(params.K, settings.strikeStep);
+    rounded.r = roundToStep(params.r, settings.rateStep);
+    rounded.q = roundToStep(params.q, settings.dividendStep);
+    rounded.sigma = roundToStep(params.sigma, settings.volatilityStep);
+    rounded.expiry = roundToStep(params.expiry, settings.expiryStep);
+    return rounded;
+}
+
+template<typename T>
+typename PricingResultCacheT<T>::Key PricingResultCacheT<T>::makeKey(const OptionParametersT<T>& params) const {
+    Key key;
+    key.fields[0] = keyField(params.S, settings.spotStep);
+    key.fields[1] = keyField(params.K, settings.strikeStep);
+    key.fields[2] = keyField(params.r, settings.rateStep);
+    key.fields[3] = keyField(params.q, settings.dividendStep);
+    key.fields[4] = keyField(params.sigma, settings.volatilityStep);
+    key.fields[5] = keyField(params.expiry, settings.expiryStep);
+    key.style = params.style;
+    key.type = params.type;
+    return key;
+}
+
+template<typename T>
+typename PricingResultCacheT<T>::Shard& PricingResultCacheT<T>::shardFor(std::size_t hash) {
+    // The index uses the low bits of the hash, so pick the shard with the high ones
+    return *shards[(std::uint64_t(hash) >> 40) % shards.size()];
+}
+
+template<typename T>
+bool PricingResultCacheT<T>::find(const OptionParametersT<T>& params, PricingResultT<T>& result) {
+    Key key = makeKey(params);
+    Shard& shard = shardFor(KeyHash()(key));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found == shard.index.end()) {
+        ++shard.misses;
+        return false;
+    }
+    ++shard.hits;
+    shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+    result = found->second->second;
+    return true;
+}
+
+template<typename T>
+void PricingResultCacheT<T>::insert(const OptionParametersT<T>& params, const PricingResultT<T>& result) {
+    Key key = makeKey(params);
+    Shard& shard = shardFor(KeyHash()(key));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.count(key) != 0) {
+        return;
+    }
+    shard.lru.emplace_front(key, result);
+    shard.index.emplace(key, shard.lru.begin());
+    while (shard.lru.size() > shardCapacity) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+        ++shard.evictions;
+    }
+}
+
+template<typename T>
+ResultCacheStats PricingResultCacheT<T>::stats() const {
+    ResultCacheStats total;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->hits;
+        total.misses += shard->misses;
+        total.evictions += shard->evictions;
+        total.entries += shard->lru.size();
+    }
+    total.bytes = total.entries * entryBytes();
+    return total;
+}
+
+template<typename T>
+void PricingResultCacheT<T>::clear() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+    }
+}
+
+std::string formatResultCacheStats(const ResultCacheStats& stats) {
+    std::uint64_t lookups = stats.hits + stats.misses;
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "Result cache: %llu hits, %llu misses (%.1f%% hits), %llu evictions, %zu entries, %.1f KiB",
+                  static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                  lookups ? 100.0 * double(stats.hits) / double(lookups) : 0.0,
+                  static_cast<unsigned long long>(stats.evictions), stats.entries, double(stats.bytes) / 1024.0);
+    return line;
+}
+
+// Explicit instantiations
+template class PricingResultCacheT<double>;
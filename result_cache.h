@@ -0,0 +1,101 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Size and key quantization of a PricingResultCacheT
+struct ResultCacheConfig {
+    std::size_t memoryLimit = std::size_t(64) << 20;   // Bytes of entries over all shards
+    std::size_t shards = 16;
+
+    // Each parameter is rounded to a multiple of its step before lookup; zero keys the exact
+    // value. Results are computed at the rounded parameters, so every request in a bucket
+    // gets the same result, whichever arrived first.
+    double spotStep = 0.0;
+    double strikeStep = 0.0;
+    double rateStep = 0.0;
+    double dividendStep = 0.0;
+    double volatilityStep = 0.0;
+    double expiryStep = 0.0;
+};
+
+struct ResultCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;   // Estimated, at entryBytes per entry
+};
+
+// Thread-safe LRU map from quantized option parameters to pricing results. Keys hash to one
+// of several shards, each with its own lock, LRU list and share of the memory limit, so
+// concurrent lookups seldom contend. Lookups never wait for a pricing: two threads missing
+// the same key both compute it, and the first insert wins.
+template<typename T = double>
+class PricingResultCacheT {
+public:
+    explicit PricingResultCacheT(const ResultCacheConfig& config = ResultCacheConfig());
+
+    // params with each field rounded to its quantization step
+    OptionParametersT<T> quantize(const OptionParametersT<T>& params) const;
+
+    // Copies the result cached for the bucket of params into result and marks it most
+    // recently used. Counts a hit or a miss.
+    bool find(const OptionParametersT<T>& params, PricingResultT<T>& result);
+    // Stores result for the bucket of params, evicting least recently used entries of its
+    // shard beyond the shard's share of the memory limit
+    void insert(const OptionParametersT<T>& params, const PricingResultT<T>& result);
+
+    ResultCacheStats stats() const;
+    void clear();
+    const ResultCacheConfig& config() const { return settings; }
+
+    // Estimated memory of one entry: the LRU list node and the hash index node
+    static std::size_t entryBytes();
+
+private:
+    struct Key {
+        std::int64_t fields[6];   // S, K, r, q, sigma, expiry
+        OptionStyle style;
+        OptionType type;
+
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+    using Entry = std::pair<Key, PricingResultT<T>>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;   // Most recently used first
+        std::unordered_map<Key, typename std::list<Entry>::iterator, KeyHash> index;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    ResultCacheConfig settings;
+    std::size_t shardCapacity;   // Entries per shard
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Key makeKey(const OptionParametersT<T>& params) const;
+    Shard& shardFor(std::size_t hash);
+};
+
+// One-line summary such as "Result cache: 812 hits, 188 misses (81.2% hits), 0 evictions, ..."
+std::string formatResultCacheStats(const ResultCacheStats& stats);
+
+// Type aliases for backward compatibility
+using PricingResultCache = PricingResultCacheT<double>;
+
+#endif // RESULT_CACHE_H
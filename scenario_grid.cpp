@@ -0,0 +1,203 @@
+#include "scenario_grid.h"
+#include "option_pricing.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <map>
+
+template<typename T>
+std::size_t ScenarioGridT<T>::setScenarios(const OptionParametersT<T>& newContract, ScenarioAxis axis,
+                                           std::vector<T> spots, std::vector<T> levels, int newSteps) {
+    // Fields every cell depends on, besides its own spot and level
+    bool sameContract = newSteps == steps && axis == levelAxis && newContract.K == contract.K &&
+                        newContract.r == contract.r && newContract.q == contract.q &&
+                        newContract.style == contract.style && newContract.type == contract.type &&
+                        (axis == ScenarioAxis::Volatility ? newContract.expiry == contract.expiry
+                                                          : newContract.sigma == contract.sigma);
+
+    std::vector<PricingResultT<T>> newCells(spots.size() * levels.size());
+    std::vector<unsigned char> newDone(newCells.size(), 0);
+    if (sameContract) {
+        // Position of each new spot and level on the old axes, or npos
+        const std::size_t npos = std::numeric_limits<std::size_t>::max();
+        auto positions = [npos](const std::vector<T>& from, const std::vector<T>& to) {
+            std::map<T, std::size_t> index;
+            for (std::size_t i = 0; i < from.size(); ++i) {
+                index.emplace(from[i], i);
+            }
+            std::vector<std::size_t> found(to.size(), npos);
+            for (std::size_t i = 0; i < to.size(); ++i) {
+                auto it = index.find(to[i]);
+                if (it != index.end()) {
+                    found[i] = it->second;
+                }
+            }
+            return found;
+        };
+        std::vector<std::size_t> oldColumn = positions(spotValues, spots);
+        std::vector<std::size_t> oldRow = positions(levelValues, levels);
+        for (std::size_t row = 0; row < levels.size(); ++row) {
+            if (oldRow[row] == npos) {
+                continue;
+            }
+            for (std::size_t column = 0; column < spots.size(); ++column) {
+                if (oldColumn[column] != npos && priced(oldRow[row], oldColumn[column])) {
+                    newCells[row * spots.size() + column] = cell(oldRow[row], oldColumn[column]);
+                    newDone[row * spots.size() + column] = 1;
+                }
+            }
+        }
+    }
+
+    contract = newContract;
+    levelAxis = axis;
+    steps = newSteps;
+    spotValues = std::move(spots);
+    levelValues = std::move(levels);
+    cells = std::move(newCells);
+    done = std::move(newDone);
+    return unpricedCount();
+}
+
+template<typename T>
+std::size_t ScenarioGridT<T>::unpricedCount() const {
+    return std::size_t(std::count(done.begin(), done.end(), 0));
+}
+
+template<typename T>
+OptionParametersT<T> ScenarioGridT<T>::scenario(std::size_t row, std::size_t column) const {
+    OptionParametersT<T> params = contract;
+    params.S = spotValues[column];
+    if (levelAxis == ScenarioAxis::Volatility) {
+        params.sigma = levelValues[row];
+    } else {
+        params.expiry = levelValues[row];
+    }
+    return params;
+}
+
+template<typename T>
+void ScenarioGridT<T>::priceTile(const ScenarioTile& tile) {
+    std::vector<std::size_t> index;
+    std::vector<T> S, K, r, q, sigma, expiry;
+    for (std::size_t row = tile.firstRow; row < tile.firstRow + tile.rows; ++row) {
+        for (std::size_t column = tile.firstColumn; column < tile.firstColumn + tile.columns; ++column) {
+            if (priced(row, column)) {
+                continue;
+            }
+            OptionParametersT<T> params = scenario(row, column);
+            index.push_back(row * columns() + column);
+            S.push_back(params.S);
+            K.push_back(params.K);
+            r.push_back(params.r);
+            q.push_back(params.q);
+            sigma.push_back(params.sigma);
+            expiry.push_back(params.expiry);
+        }
+    }
+
+    std::size_t count = index.size();
+    std::vector<OptionStyle> style(count, contract.style);
+    std::vector<OptionType> type(count, contract.type);
+    std::vector<T> price(count), delta(count), gamma(count), theta(count), vega(count), rho(count);
+    std::vector<ValidationStatus> status(count, 0);
+    OptionBatchT<T> batch{count, S.data(), K.data(), r.data(), q.data(), sigma.data(), expiry.data(),
+                          style.data(), type.data()};
+    std::vector<unsigned char> failed(count, 0);
+    try {
+        priceBatchT(batch, PricingResultBatchT<T>{price.data(), delta.data(), gamma.data(), theta.data(),
+                                                  vega.data(), rho.data()},
+                    steps, status.data());
+    } catch (const std::exception&) {
+        // A lattice with an invalid probability fails the whole batch; reprice the tile one
+        // cell at a time so that only the failing cells are lost
+        for (std::size_t i = 0; i < count; ++i) {
+            OptionBatchT<T> row{1, &S[i], &K[i], &r[i], &q[i], &sigma[i], &expiry[i], &style[i], &type[i]};
+            try {
+                priceBatchT(row, PricingResultBatchT<T>{&price[i], &delta[i], &gamma[i], &theta[i], &vega[i], &rho[i]},
+                            steps, &status[i]);
+            } catch (const std::exception&) {
+                failed[i] = 1;
+            }
+        }
+    }
+
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    for (std::size_t i = 0; i < count; ++i) {
+        PricingResultT<T>& result = cells[index[i]];
+        if (failed[i] || status[i] != 0) {
+            result.price = nan;
+            result.greeks = GreeksT<T>{nan, nan, nan, nan, nan};
+        } else {
+            result.price = price[i];
+            result.greeks = GreeksT<T>{delta[i], gamma[i], theta[i], vega[i], rho[i]};
+        }
+        done[index[i]] = 1;
+    }
+}
+
+template<typename T>
+void ScenarioGridT<T>::priceMissing(const std::function<void(const ScenarioTile&)>& onTile,
+                                    const std::function<bool()>& stop) {
+    std::vector<ScenarioTile> pending;
+    for (std::size_t row = 0; row < rows(); row += tileSize) {
+        for (std::size_t column = 0; column < columns(); column += tileSize) {
+            ScenarioTile tile{row, std::min(tileSize, rows() - row), column, std::min(tileSize, columns() - column)};
+            bool missing = false;
+            for (std::size_t i = tile.firstRow; i < tile.firstRow + tile.rows && !missing; ++i) {
+                for (std::size_t j = tile.firstColumn; j < tile.firstColumn + tile.columns && !missing; ++j) {
+                    missing = !priced(i, j);
+                }
+            }
+            if (missing) {
+                pending.push_back(tile);
+            }
+        }
+    }
+
+    WorkStealingPool::shared().run(pending.size(), [&](std::size_t t) {
+        if (stop && stop()) {
+            return;
+        }
+        priceTile(pending[t]);
+        if (onTile) {
+            onTile(pending[t]);
+        }
+    });
+}
+
+template<typename T>
+std::vector<T> scenarioAxisT(T low, T high, std::size_t count) {
+    using std::ceil;
+    using std::floor;
+    using std::log10;
+    using std::pow;
+    if (count == 0 || !(high > low)) {
+        throw OptionPricingError("Scenario axis needs a nonempty range and at least one value");
+    }
+
+    // Tolerances keep ranges that are an exact multiple of a step, such as 1 / 100, on it
+    T target = (high - low) / T(count);
+    T decade = pow(T(10), floor(log10(target) + T(1e-9)));
+    T step = decade;
+    for (T multiple : {T(2), T(2.5), T(5)}) {
+        if (multiple * decade <= target * T(1 + 1e-9)) {
+            step = multiple * decade;
+        }
+    }
+
+    // Multiples of the step rather than sums, so equal indices give equal values
+    long long first = std::max(1LL, static_cast<long long>(ceil(low / step - T(1e-9))));
+    long long last = static_cast<long long>(floor(high / step + T(1e-9)));
+    std::vector<T> values;
+    for (long long i = first; i <= last; ++i) {
+        values.push_back(T(i) * step);
+    }
+    return values;
+}
+
+// Explicit instantiations
+template class ScenarioGridT<double>;
+template std::vector<double> scenarioAxisT<double>(double, double, std::size_t);
@@ -0,0 +1,85 @@
+#ifndef SCENARIO_GRID_H
+#define SCENARIO_GRID_H
+
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Quantity varied down the rows of a scenario grid; spot varies across the columns
+enum class ScenarioAxis : std::uint8_t { Volatility, Expiry };
+
+// Block of cells priced as one batch: rows [firstRow, firstRow + rows) by columns
+// [firstColumn, firstColumn + columns)
+struct ScenarioTile {
+    std::size_t firstRow = 0;
+    std::size_t rows = 0;
+    std::size_t firstColumn = 0;
+    std::size_t columns = 0;
+};
+
+// Price and Greeks of one contract over spot levels (columns) and volatilities or expiries
+// (rows). Cells are priced in square tiles, each one batch through priceBatchT, spread
+// over WorkStealingPool::shared(). Moving to new axes keeps every cell whose scenario was
+// already priced, so shifting one axis prices only the rows or columns it uncovers.
+// A grid is not thread-safe, except that onTile may read the cells of its own tile.
+template<typename T = double>
+class ScenarioGridT {
+public:
+    static constexpr std::size_t tileSize = 10;
+
+    // Moves to a contract and axes. A cell keeps its result when the contract, the axis
+    // kind, the step count and its own spot and level are unchanged; levels compare exactly,
+    // so build axes with scenarioAxisT. Every other cell becomes unpriced. contract.S and
+    // the contract field on the level axis are ignored. Returns the number of unpriced cells.
+    std::size_t setScenarios(const OptionParametersT<T>& contract, ScenarioAxis axis, std::vector<T> spots,
+                             std::vector<T> levels, int steps = 200);
+
+    // Prices every unpriced cell, with steps lattice steps for American contracts. onTile
+    // runs on a pool thread as each tile with newly priced cells completes. Once stop
+    // returns true, tiles not yet started are skipped and stay unpriced. Cells whose
+    // scenario fails validation or the lattice hold NaN.
+    void priceMissing(const std::function<void(const ScenarioTile&)>& onTile = {},
+                      const std::function<bool()>& stop = {});
+
+    std::size_t rows() const { return levelValues.size(); }
+    std::size_t columns() const { return spotValues.size(); }
+    const std::vector<T>& spots() const { return spotValues; }
+    const std::vector<T>& levels() const { return levelValues; }
+    ScenarioAxis axis() const { return levelAxis; }
+
+    const PricingResultT<T>& cell(std::size_t row, std::size_t column) const { return cells[row * columns() + column]; }
+    bool priced(std::size_t row, std::size_t column) const { return done[row * columns() + column] != 0; }
+    std::size_t unpricedCount() const;
+
+    // Parameters of the scenario in a cell
+    OptionParametersT<T> scenario(std::size_t row, std::size_t column) const;
+
+private:
+    OptionParametersT<T> contract;
+    ScenarioAxis levelAxis = ScenarioAxis::Volatility;
+    int steps = 0;
+    std::vector<T> spotValues;
+    std::vector<T> levelValues;
+    std::vector<PricingResultT<T>> cells;   // Row-major
+    std::vector<unsigned char> done;
+
+    void priceTile(const ScenarioTile& tile);
+};
+
+// Positive multiples of a step covering [low, high], with step the largest 1, 2, 2.5 or 5
+// times a power of ten at most (high - low) / count: between count and about twice count
+// values. Nearby ranges get the same step and so share values exactly, which lets
+// ScenarioGridT keep their cells.
+template<typename T>
+std::vector<T> scenarioAxisT(T low, T high, std::size_t count);
+
+// Type aliases for backward compatibility
+using ScenarioGrid = ScenarioGridT<double>;
+
+inline std::vector<double> scenarioAxis(double low, double high, std::size_t count) {
+    return scenarioAxisT<double>(low, high, count);
+}
+
+#endif // SCENARIO_GRID_H
@@ -0,0 +1,206 @@
+#include "scenario_heatmap.h"
+#include <QtGui/QColor>
+#include <QtGui/QCursor>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QPainter>
+#include <QtWidgets/QToolTip>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const char* const metricNames[] = {"Price", "P&L", "Delta", "Gamma", "Theta", "Vega", "Rho"};
+
+// Margins around the plot for the axis and scale labels
+constexpr int leftMargin = 56;
+constexpr int topMargin = 8;
+constexpr int rightMargin = 8;
+constexpr int bottomMargin = 36;
+
+} // namespace
+
+ScenarioHeatmap::ScenarioHeatmap(QWidget *parent) : QWidget(parent) {
+    setMouseTracking(true);
+}
+
+QSize ScenarioHeatmap::minimumSizeHint() const {
+    return QSize(leftMargin + rightMargin + 300, topMargin + bottomMargin + 300);
+}
+
+void ScenarioHeatmap::setGrid(ScenarioAxis newAxis, const std::vector<double>& newSpots,
+                              const std::vector<double>& newLevels, std::vector<PricingResult> newCells,
+                              std::vector<unsigned char> newKnown) {
+    axis = newAxis;
+    spots = newSpots;
+    levels = newLevels;
+    cells = std::move(newCells);
+    known = std::move(newKnown);
+    image = QImage(int(spots.size()), int(levels.size()), QImage::Format_RGB32);
+    recolour();
+    update();
+}
+
+void ScenarioHeatmap::setTile(const ScenarioTile& tile, const std::vector<PricingResult>& tileCells) {
+    std::vector<std::size_t> indices;
+    for (std::size_t row = 0; row < tile.rows; ++row) {
+        for (std::size_t column = 0; column < tile.columns; ++column) {
+            std::size_t index = (tile.firstRow + row) * spots.size() + tile.firstColumn + column;
+            cells[index] = tileCells[row * tile.columns + column];
+            known[index] = 1;
+            indices.push_back(index);
+        }
+    }
+
+    // Cells outside the scale would clip; recolour everything on the wider one
+    if (extendScale(indices)) {
+        recolour();
+        update();
+        return;
+    }
+    for (std::size_t index : indices) {
+        colourCell(index);
+    }
+    update(cellsRect(tile.firstRow, tile.rows, tile.firstColumn, tile.columns));
+}
+
+void ScenarioHeatmap::setMetric(Metric newMetric) {
+    metric = newMetric;
+    recolour();
+    update();
+}
+
+void ScenarioHeatmap::setReferencePrice(double price) {
+    referencePrice = price;
+    if (metric == ProfitLoss) {
+        recolour();
+        update();
+    }
+}
+
+double ScenarioHeatmap::value(std::size_t index) const {
+    const PricingResult& cell = cells[index];
+    switch (metric) {
+    case Price: return cell.price;
+    case ProfitLoss: return cell.price - referencePrice;
+    case Delta: return cell.greeks.delta;
+    case Gamma: return cell.greeks.gamma;
+    case Theta: return cell.greeks.theta;
+    case Vega: return cell.greeks.vega;
+    case Rho: return cell.greeks.rho;
+    }
+    return 0.0;
+}
+
+bool ScenarioHeatmap::extendScale(const std::vector<std::size_t>& indices) {
+    double oldLow = low;
+    double oldHigh = high;
+    for (std::size_t index : indices) {
+        double v = value(index);
+        if (known[index] && std::isfinite(v)) {
+            low = std::min(low, v);
+            high = std::max(high, v);
+        }
+    }
+    return low != oldLow || high != oldHigh;
+}
+
+void ScenarioHeatmap::recolour() {
+    low = std::numeric_limits<double>::infinity();
+    high = -std::numeric_limits<double>::infinity();
+    std::vector<std::size_t> all(cells.size());
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        all[i] = i;
+    }
+    extendScale(all);
+    for (std::size_t index : all) {
+        colourCell(index);
+    }
+}
+
+void ScenarioHeatmap::colourCell(std::size_t index) {
+    int x = int(index % spots.size());
+    int y = int(levels.size() - 1 - index / spots.size());
+    double v = value(index);
+    if (!known[index] || !std::isfinite(v)) {
+        image.setPixel(x, y, QColor(Qt::lightGray).rgb());
+        return;
+    }
+    // Blue at the bottom of the scale through green to red at the top
+    double t = high > low ? (v - low) / (high - low) : 0.5;
+    image.setPixel(x, y, QColor::fromHsvF(0.66 * (1.0 - t), 0.85, 0.95).rgb());
+}
+
+QRect ScenarioHeatmap::plotRect() const {
+    return rect().adjusted(leftMargin, topMargin, -rightMargin, -bottomMargin);
+}
+
+QRect ScenarioHeatmap::cellsRect(std::size_t firstRow, std::size_t rows, std::size_t firstColumn,
+                                 std::size_t columns) const {
+    QRect plot = plotRect();
+    double width = double(plot.width()) / double(spots.size());
+    double height = double(plot.height()) / double(levels.size());
+    // Image rows run top down, grid rows bottom up
+    double top = double(levels.size() - firstRow - rows) * height;
+    QRectF area(plot.left() + firstColumn * width, plot.top() + top, columns * width, rows * height);
+    return area.toAlignedRect().adjusted(-1, -1, 1, 1);
+}
+
+void ScenarioHeatmap::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    QRect plot = plotRect();
+    if (image.isNull()) {
+        painter.fillRect(plot, Qt::lightGray);
+        return;
+    }
+    painter.drawImage(plot, image);
+
+    // Axis ranges and the colour scale
+    QString level = axis == ScenarioAxis::Volatility ? "Vol" : "Expiry";
+    auto levelText = [&](double v) {
+        return axis == ScenarioAxis::Volatility ? QString("%1%").arg(100.0 * v, 0, 'f', 0)
+                                                : QString("%1y").arg(v, 0, 'f', 2);
+    };
+    int line = fontMetrics().height();
+    painter.drawText(QRect(0, plot.top(), leftMargin - 4, line), Qt::AlignRight, levelText(levels.back()));
+    painter.drawText(QRect(0, plot.bottom() - line, leftMargin - 4, line), Qt::AlignRight,
+                     levelText(levels.front()));
+    painter.drawText(QRect(0, plot.center().y() - line / 2, leftMargin - 4, line), Qt::AlignRight, level);
+    painter.drawText(QRect(plot.left(), plot.bottom() + 2, plot.width(), line), Qt::AlignLeft,
+                     QString::number(spots.front(), 'f', 2));
+    painter.drawText(QRect(plot.left(), plot.bottom() + 2, plot.width(), line), Qt::AlignHCenter, "Spot");
+    painter.drawText(QRect(plot.left(), plot.bottom() + 2, plot.width(), line), Qt::AlignRight,
+                     QString::number(spots.back(), 'f', 2));
+    if (high >= low) {
+        painter.drawText(QRect(plot.left(), plot.bottom() + 2 + line, plot.width(), line), Qt::AlignHCenter,
+                         QString("%1: %2 (blue) to %3 (red)")
+                             .arg(metricNames[metric])
+                             .arg(low, 0, 'g', 4)
+                             .arg(high, 0, 'g', 4));
+    }
+}
+
+void ScenarioHeatmap::mouseMoveEvent(QMouseEvent *) {
+    QPoint position = mapFromGlobal(QCursor::pos());
+    QRect plot = plotRect();
+    if (image.isNull() || !plot.contains(position)) {
+        QToolTip::hideText();
+        return;
+    }
+    std::size_t column = std::min(spots.size() - 1,
+                                  std::size_t(double(position.x() - plot.left()) * spots.size() / plot.width()));
+    std::size_t fromTop = std::min(levels.size() - 1,
+                                   std::size_t(double(position.y() - plot.top()) * levels.size() / plot.height()));
+    std::size_t row = levels.size() - 1 - fromTop;
+    std::size_t index = row * spots.size() + column;
+
+    QString scenario = QString("Spot %1, %2 %3")
+                           .arg(spots[column], 0, 'f', 2)
+                           .arg(axis == ScenarioAxis::Volatility ? "vol" : "expiry")
+                           .arg(axis == ScenarioAxis::Volatility ? QString("%1%").arg(100.0 * levels[row], 0, 'f', 1)
+                                                                 : QString("%1y").arg(levels[row], 0, 'f', 3));
+    QString text = known[index]
+                       ? QString("%1\n%2: %3").arg(scenario).arg(metricNames[metric]).arg(value(index), 0, 'f', 4)
+                       : QString("%1\nPricing...").arg(scenario);
+    QToolTip::showText(QCursor::pos(), text, this);
+}
@@ -0,0 +1,58 @@
+#ifndef SCENARIO_HEATMAP_H
+#define SCENARIO_HEATMAP_H
+
+#include <QtWidgets/QWidget>
+#include <QtGui/QImage>
+#include "scenario_grid.h"
+#include <vector>
+
+// Colour map of one quantity over a scenario grid, spot across and volatility or expiry
+// upwards. Cells arrive in tiles: a tile repaints only its own rectangle unless it widens
+// the colour scale. Cells not priced yet are grey; hovering shows a cell's value.
+class ScenarioHeatmap : public QWidget {
+    Q_OBJECT
+
+public:
+    enum Metric { Price, ProfitLoss, Delta, Gamma, Theta, Vega, Rho };
+
+    explicit ScenarioHeatmap(QWidget *parent = nullptr);
+
+    // New axes, with the cells known so far in row-major order
+    void setGrid(ScenarioAxis axis, const std::vector<double>& spots, const std::vector<double>& levels,
+                 std::vector<PricingResult> cells, std::vector<unsigned char> known);
+    // Cells of one tile, row-major within the tile
+    void setTile(const ScenarioTile& tile, const std::vector<PricingResult>& tileCells);
+    void setMetric(Metric metric);
+    // Price of the current contract, from which ProfitLoss is measured
+    void setReferencePrice(double price);
+
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    ScenarioAxis axis = ScenarioAxis::Volatility;
+    std::vector<double> spots;
+    std::vector<double> levels;
+    std::vector<PricingResult> cells;
+    std::vector<unsigned char> known;
+    Metric metric = Price;
+    double referencePrice = 0.0;
+
+    // One pixel per cell, highest level in the top row, coloured over [low, high]
+    QImage image;
+    double low = 0.0;
+    double high = 0.0;
+
+    double value(std::size_t index) const;
+    QRect plotRect() const;
+    QRect cellsRect(std::size_t firstRow, std::size_t rows, std::size_t firstColumn, std::size_t columns) const;
+    // Widens [low, high] to the values of the given cells; true when it changed
+    bool extendScale(const std::vector<std::size_t>& indices);
+    void recolour();
+    void colourCell(std::size_t index);
+};
+
+#endif // SCENARIO_HEATMAP_H
@@ -0,0 +1,139 @@
+#include "strike_ladder.h"
+#include "option_pricing.h"
+#include <algorithm>
+#include <cmath>
+
+template<typename T>
+StrikeLadderPricerT<T>::StrikeLadderPricerT(int steps, std::size_t cacheCapacity)
+    : steps(steps), cacheCapacity(cacheCapacity) {
+    if (steps < 1) {
+        throw OptionPricingError("Strike ladder needs at least 1 step");
+    }
+}
+
+// Backward induction over steps + 2 * halfWidth steps from a unit spot and strike, stopped
+// at the layer 2 * halfWidth steps from the root. Spot levels and payoffs are tabulated
+// once and split by parity, as in runLattice in option_pricing.cpp.
+template<typename T>
+typename StrikeLadderPricerT<T>::Solution StrikeLadderPricerT<T>::solve(const OptionParametersT<T>& params,
+                                                                         int halfWidth) const {
+    using std::exp;
+    using std::max;
+    using std::sqrt;
+    int total = steps + 2 * halfWidth;
+    T dt = params.expiry / T(steps);
+    T logU = params.sigma * sqrt(dt);
+    T u = exp(logU);
+    T d = T(1) / u;
+    T p = (exp((params.r - params.q) * dt) - d) / (u - d);
+    if (p < T(0) || p > T(1)) {
+        throw NumericalError("Invalid probability in binomial model");
+    }
+    T pDown = T(1) - p;
+    T discount = exp(-params.r * dt);
+    T sign = params.style == OptionStyle::Call ? T(1) : T(-1);
+    bool earlyExercise = params.type == OptionType::American &&
+                         !(params.style == OptionStyle::Call && params.q == T(0));
+
+    // Level j = 0..2 * total is spot u^(total - j); node i of step s sits on level total - s + 2i
+    const T floor = T(1e-300);
+    std::vector<T> payoff[2];
+    payoff[0].resize(total + 1);
+    payoff[1].resize(total + 1);
+    for (int j = 0; j <= 2 * total; ++j) {
+        payoff[j & 1][j >> 1] = max(floor, sign * (exp(T(total - j) * logU) - T(1)));
+    }
+
+    std::vector<T> values(payoff[0]);   // Terminal nodes, on the even levels
+    for (int step = total - 1; step >= 2 * halfWidth; --step) {
+        int parity = (total - step) & 1;
+        const T* exercise = payoff[parity].data() + (total - step - parity) / 2;
+        T* node = values.data();
+        for (int i = 0; i <= step; ++i) {
+            T continuation = discount * (p * node[i] + pDown * node[i + 1]);
+            node[i] = earlyExercise ? max(continuation, exercise[i]) : continuation;
+        }
+    }
+
+    Solution solution;
+    solution.halfWidth = halfWidth;
+    solution.spacing = T(2) * logU;
+    solution.values.assign(values.rbegin() + (total - 2 * halfWidth), values.rend());
+    return solution;
+}
+
+template<typename T>
+void StrikeLadderPricerT<T>::price(const OptionParametersT<T>& params, std::size_t count, const T* K, T* prices) {
+    using std::abs;
+    using std::ceil;
+    using std::log;
+    using std::max;
+    using std::sqrt;
+
+    T widest = T(0);
+    for (std::size_t i = 0; i < count; ++i) {
+        OptionParametersT<T> row = params;
+        row.K = K[i];
+        validateOptionParametersT(row);
+        widest = max(widest, abs(log(params.S / K[i])));
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // Two levels beyond the widest strike keep the interpolation stencil inside the layer
+    T spacing = T(2) * params.sigma * sqrt(params.expiry / T(steps));
+    int halfWidth = std::min(steps, int(ceil(widest / spacing)) + 2);
+
+    Key key(params.r, params.q, params.sigma, params.expiry, params.style, params.type);
+    auto found = cache.find(key);
+    if (found == cache.end() || found->second.halfWidth < halfWidth) {
+        Solution solution = solve(params, halfWidth);
+        if (found != cache.end()) {
+            found->second = std::move(solution);
+        } else {
+            if (cache.size() >= cacheCapacity) {
+                cache.clear();
+            }
+            found = cache.emplace(key, std::move(solution)).first;
+        }
+    }
+    const Solution& solution = found->second;
+
+    BinomialModelT<T> fallback(steps);
+    T sign = params.style == OptionStyle::Call ? T(1) : T(-1);
+    for (std::size_t i = 0; i < count; ++i) {
+        // Position in the layer, in units of levels from its lowest moneyness
+        T x = log(params.S / K[i]) / solution.spacing + T(solution.halfWidth);
+        if (!(x >= T(1) && x <= T(2 * solution.halfWidth - 2))) {
+            OptionParametersT<T> row = params;
+            row.K = K[i];
+            prices[i] = fallback.calculatePrice(row);
+            continue;
+        }
+
+        // Four-point Lagrange interpolation on levels k - 1 .. k + 2
+        int k = std::min(int(x), 2 * solution.halfWidth - 3);
+        T t = x - T(k);
+        const T* v = solution.values.data() + k - 1;
+        T unitPrice = -t * (t - T(1)) * (t - T(2)) / T(6) * v[0] +
+                      (t + T(1)) * (t - T(1)) * (t - T(2)) / T(2) * v[1] -
+                      (t + T(1)) * t * (t - T(2)) / T(2) * v[2] +
+                      (t + T(1)) * t * (t - T(1)) / T(6) * v[3];
+
+        // Never below the exercise value, which interpolation near the boundary could undercut
+        T intrinsic = max(T(0), sign * (params.S - K[i]));
+        T price = K[i] * unitPrice;
+        prices[i] = params.type == OptionType::American ? max(price, intrinsic) : price;
+    }
+}
+
+template<typename T>
+T StrikeLadderPricerT<T>::price(const OptionParametersT<T>& params) {
+    T result;
+    price(params, 1, &params.K, &result);
+    return result;
+}
+
+// Explicit instantiations
+template class StrikeLadderPricerT<double>;
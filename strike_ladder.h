@@ -0,0 +1,61 @@
+#ifndef STRIKE_LADDER_H
+#define STRIKE_LADDER_H
+
+#include "types.h"
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Prices ladders of American strikes from one binomial lattice. Prices are homogeneous of
+// degree one in (S, K), so V(S, K) = K v(S / K) with v the price for a unit strike. The
+// pricer runs one CRR lattice for a unit strike, extended by 2M steps before the valuation
+// date, whose first real layer holds v at the 2M + 1 moneyness levels u^(2k), k = -M..M.
+// A strike is priced by cubic interpolation in log moneyness between those levels. That
+// normalized solution is cached per (r, q, sigma, T, style), for the pricer's step count.
+//
+// Error bound: at a level the price equals the N-step tree price for that strike. Between
+// levels cubic interpolation adds an error of O(h^2) in the level spacing
+// h = 2 sigma sqrt(T / N), not O(h^4), because v'' jumps at the exercise boundary. Since
+// h^2 = 4 sigma^2 T / N, that is the order of the tree's own O(1 / N) discretization error.
+// Measured at 500 steps, spot 100 and strikes 60 to 140 (benchStrikeLadder), ladder prices
+// are within about 9e-3 of the per-strike trees, mostly because tree prices oscillate as
+// strikes cross nodes. Both are within 6e-3 of the exact price, and the ladder can be
+// slightly further off than the trees: 4.1e-3 against 3.6e-3 for a 2-year put at 12%.
+//
+// Strikes whose moneyness lies beyond M = N levels fall back to a per-strike tree. The
+// cache is emptied when it would exceed its capacity. A pricer is not thread-safe; use
+// one per thread.
+template<typename T = double>
+class StrikeLadderPricerT {
+public:
+    explicit StrikeLadderPricerT(int steps = 500, std::size_t cacheCapacity = 256);
+
+    // prices[i] for strike K[i], with the other parameters from params (params.K is
+    // ignored). Throws OptionPricingError for invalid parameters.
+    void price(const OptionParametersT<T>& params, std::size_t count, const T* K, T* prices);
+    T price(const OptionParametersT<T>& params);
+
+    std::size_t cachedSolutions() const { return cache.size(); }
+    void clearCache() { cache.clear(); }
+
+private:
+    // Unit-strike prices at moneyness u^(2k) for k = -halfWidth..halfWidth, ascending
+    struct Solution {
+        int halfWidth = 0;
+        T spacing{};   // Log moneyness between levels
+        std::vector<T> values;
+    };
+    using Key = std::tuple<T, T, T, T, OptionStyle, OptionType>;   // r, q, sigma, T, style, type
+
+    int steps;
+    std::size_t cacheCapacity;
+    std::map<Key, Solution> cache;
+
+    Solution solve(const OptionParametersT<T>& params, int halfWidth) const;
+};
+
+// Type aliases for backward compatibility
+using StrikeLadderPricer = StrikeLadderPricerT<double>;
+
+#endif // STRIKE_LADDER_H
@@ -0,0 +1,130 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+
+// Set on pool worker threads; run() falls back to inline execution there
+thread_local bool insideWorker = false;
+
+} // namespace
+
+WorkStealingPool& WorkStealingPool::shared() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+WorkStealingPool::WorkStealingPool(std::size_t workers) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    if (insideWorker) {
+        for (std::size_t i = 0; i < taskCount; ++i) {
+            task(i);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> runLock(runMutex);
+
+    // Publish the job before any task becomes visible: a worker still scanning the
+    // queues from the previous run may pick up a new task straight away
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        job = &task;
+        remaining = taskCount;
+        failure = nullptr;
+    }
+    std::size_t workers = queues.size();
+    for (std::size_t w = 0; w < workers; ++w) {
+        std::lock_guard<std::mutex> lock(queues[w]->mutex);
+        for (std::size_t i = w; i < taskCount; i += workers) {
+            queues[w]->tasks.push_back(i);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    ++generation;
+    wake.notify_all();
+    done.wait(lock, [this] { return remaining == 0; });
+    job = nullptr;
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+bool WorkStealingPool::takeTask(std::size_t self, std::size_t& task) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < queues.size(); ++k) {
+        Queue& victim = *queues[(self + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(std::size_t self) {
+    insideWorker = true;
+    std::size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        std::size_t task;
+        while (takeTask(self, task)) {
+            std::exception_ptr error;
+            try {
+                (*job)(task);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (error && !failure) {
+                failure = error;
+            }
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        }
+    }
+}
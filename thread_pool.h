@@ -0,0 +1,62 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. Owners take tasks from the
+// front of their own deque; an idle worker steals from the back of another's.
+// Tasks are plain indices into a job submitted through run().
+class WorkStealingPool {
+public:
+    // Zero selects std::thread::hardware_concurrency()
+    explicit WorkStealingPool(std::size_t workers = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const { return threads.size(); }
+
+    // Process-wide pool sized to the hardware, created on first use
+    static WorkStealingPool& shared();
+
+    // Runs task(i) once for every i in [0, taskCount) and blocks until all have finished.
+    // Task i starts on worker i % size(), so callers control the initial distribution by
+    // ordering their tasks. The first exception thrown by a task is rethrown here once the
+    // remaining tasks have been drained. Calls to run() are serialized. Called from inside a
+    // task of any pool, run() executes the tasks inline on the calling thread instead, so
+    // nested parallel code cannot deadlock waiting for busy workers.
+    void run(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex runMutex;                  // One job at a time
+    std::mutex stateMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::size_t generation = 0;
+    std::size_t remaining = 0;
+    std::exception_ptr failure;
+    bool stopping = false;
+
+    void workerLoop(std::size_t self);
+    bool takeTask(std::size_t self, std::size_t& task);
+};
+
+#endif // THREAD_POOL_H
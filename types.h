@@ -1,8 +1,18 @@
 #ifndef TYPES_H
 #define TYPES_H
 
-enum class OptionType { European, American };
-enum class OptionStyle { Call, Put };
+#include <cstddef>
+#include <cstdint>
+
+// One byte each, so columnar files can store them as is
+enum class OptionType : std::uint8_t { European, American };
+enum class OptionStyle : std::uint8_t { Call, Put };
+
+// Model used for American options
+enum class AmericanModel { BaroneAdesiWhaley, BjerksundStensland, AndersenLakeOffengelt, Binomial, CrankNicolson };
+
+// Accuracy presets for the Andersen-Lake-Offengelt boundary solver
+enum class AloAccuracy { Fast, Accurate, HighPrecision };
 
 // Template for Greeks to allow different numeric types
 template<typename T = double>
@@ -33,9 +43,56 @@ struct PricingResultT {
     GreeksT<T> greeks{};
 };
 
+// Columnar (structure-of-arrays) view over a batch of options
+template<typename T = double>
+struct OptionBatchT {
+    std::size_t size{};
+    const T* S{};
+    const T* K{};
+    const T* r{};
+    const T* q{};
+    const T* sigma{};
+    const T* expiry{};
+    const OptionStyle* style{};
+    const OptionType* type{};   // Optional; when null every row is European
+};
+
+// Columnar output buffers for batch pricing, each holding at least size elements
+template<typename T = double>
+struct PricingResultBatchT {
+    T* price{};
+    T* delta{};
+    T* gamma{};
+    T* theta{};
+    T* vega{};
+    T* rho{};
+};
+
+// Outcome of validating one option: zero when it is valid, otherwise one ValidationFlag bit
+// per failed check. The range bits come first in field order and the non-finite bits after
+// them, so the lowest set bit names the error validateOptionParametersT throws.
+using ValidationStatus = std::uint16_t;
+
+namespace ValidationFlag {
+constexpr ValidationStatus StockPriceNotPositive = 1u << 0;
+constexpr ValidationStatus StrikeNotPositive = 1u << 1;
+constexpr ValidationStatus RateNegative = 1u << 2;
+constexpr ValidationStatus VolatilityNotPositive = 1u << 3;
+constexpr ValidationStatus ExpiryNotPositive = 1u << 4;
+constexpr ValidationStatus DividendYieldNegative = 1u << 5;
+constexpr ValidationStatus StockPriceNotFinite = 1u << 8;
+constexpr ValidationStatus StrikeNotFinite = 1u << 9;
+constexpr ValidationStatus RateNotFinite = 1u << 10;
+constexpr ValidationStatus VolatilityNotFinite = 1u << 11;
+constexpr ValidationStatus ExpiryNotFinite = 1u << 12;
+constexpr ValidationStatus DividendYieldNotFinite = 1u << 13;
+} // namespace ValidationFlag
+
 // Type aliases for backward compatibility
 using Greeks = GreeksT<double>;
 using OptionParameters = OptionParametersT<double>;
 using PricingResult = PricingResultT<double>;
+using OptionBatch = OptionBatchT<double>;
+using PricingResultBatch = PricingResultBatchT<double>;
 
 #endif // TYPES_H
\ No newline at end of file
@@ -0,0 +1,251 @@
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#define OPTION_PRICING_HAS_SIMD 1
+#else
+#define OPTION_PRICING_HAS_SIMD 0
+#endif
+
+#if OPTION_PRICING_HAS_SIMD
+
+// Packed double lane group for the widest instruction set enabled at compile time.
+// The kernels below are written once against this small set of operations.
+#if defined(__AVX512F__)
+
+struct PackedDouble {
+    static constexpr int width = 8;
+    __m512d v;
+};
+using PackedMask = __mmask8;
+
+inline PackedDouble packedLoad(const double* p) { return {_mm512_loadu_pd(p)}; }
+inline void packedStore(double* p, PackedDouble a) { _mm512_storeu_pd(p, a.v); }
+inline PackedDouble packedSet(double x) { return {_mm512_set1_pd(x)}; }
+
+inline PackedDouble operator+(PackedDouble a, PackedDouble b) { return {_mm512_add_pd(a.v, b.v)}; }
+inline PackedDouble operator-(PackedDouble a, PackedDouble b) { return {_mm512_sub_pd(a.v, b.v)}; }
+inline PackedDouble operator*(PackedDouble a, PackedDouble b) { return {_mm512_mul_pd(a.v, b.v)}; }
+inline PackedDouble operator/(PackedDouble a, PackedDouble b) { return {_mm512_div_pd(a.v, b.v)}; }
+
+inline PackedDouble packedFma(PackedDouble a, PackedDouble b, PackedDouble c) {
+    return {_mm512_fmadd_pd(a.v, b.v, c.v)};
+}
+inline PackedDouble packedSqrt(PackedDouble a) { return {_mm512_sqrt_pd(a.v)}; }
+inline PackedDouble packedMin(PackedDouble a, PackedDouble b) { return {_mm512_min_pd(a.v, b.v)}; }
+inline PackedDouble packedMax(PackedDouble a, PackedDouble b) { return {_mm512_max_pd(a.v, b.v)}; }
+inline PackedDouble packedRound(PackedDouble a) {
+    return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+}
+inline PackedDouble packedAbs(PackedDouble a) {
+    return {_mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a.v),
+                                                 _mm512_set1_epi64(0x7FFFFFFFFFFFFFFFLL)))};
+}
+inline PackedMask packedLess(PackedDouble a, PackedDouble b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ); }
+inline PackedMask packedGreater(PackedDouble a, PackedDouble b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ); }
+inline PackedDouble packedSelect(PackedMask m, PackedDouble a, PackedDouble b) {
+    return {_mm512_mask_blend_pd(m, b.v, a.v)};
+}
+
+// 2^n for integral n in [-1022, 1023], built directly in the exponent field
+inline PackedDouble packedPow2(PackedDouble n) {
+    __m512i bits = _mm512_castpd_si512(_mm512_add_pd(n.v, _mm512_set1_pd(6755399441055744.0)));
+    bits = _mm512_slli_epi64(_mm512_add_epi64(bits, _mm512_set1_epi64(1023)), 52);
+    return {_mm512_castsi512_pd(bits)};
+}
+
+// Splits positive normal x into a mantissa in [1, 2) and its unbiased exponent
+inline PackedDouble packedFrexp(PackedDouble x, PackedDouble& exponent) {
+    __m512i bits = _mm512_castpd_si512(x.v);
+    __m512i e = _mm512_srli_epi64(bits, 52);
+    exponent.v = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(e, _mm512_set1_epi64(0x4330000000000000LL))),
+                               _mm512_set1_pd(4503599627371519.0));
+    __m512i m = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL)),
+                                _mm512_set1_epi64(0x3FF0000000000000LL));
+    return {_mm512_castsi512_pd(m)};
+}
+
+#else // AVX2
+
+struct PackedDouble {
+    static constexpr int width = 4;
+    __m256d v;
+};
+using PackedMask = __m256d;
+
+inline PackedDouble packedLoad(const double* p) { return {_mm256_loadu_pd(p)}; }
+inline void packedStore(double* p, PackedDouble a) { _mm256_storeu_pd(p, a.v); }
+inline PackedDouble packedSet(double x) { return {_mm256_set1_pd(x)}; }
+
+inline PackedDouble operator+(PackedDouble a, PackedDouble b) { return {_mm256_add_pd(a.v, b.v)}; }
+inline PackedDouble operator-(PackedDouble a, PackedDouble b) { return {_mm256_sub_pd(a.v, b.v)}; }
+inline PackedDouble operator*(PackedDouble a, PackedDouble b) { return {_mm256_mul_pd(a.v, b.v)}; }
+inline PackedDouble operator/(PackedDouble a, PackedDouble b) { return {_mm256_div_pd(a.v, b.v)}; }
+
+inline PackedDouble packedFma(PackedDouble a, PackedDouble b, PackedDouble c) {
+#if defined(__FMA__)
+    return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+#else
+    return {_mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v)};
+#endif
+}
+inline PackedDouble packedSqrt(PackedDouble a) { return {_mm256_sqrt_pd(a.v)}; }
+inline PackedDouble packedMin(PackedDouble a, PackedDouble b) { return {_mm256_min_pd(a.v, b.v)}; }
+inline PackedDouble packedMax(PackedDouble a, PackedDouble b) { return {_mm256_max_pd(a.v, b.v)}; }
+inline PackedDouble packedRound(PackedDouble a) {
+    return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+}
+inline PackedDouble packedAbs(PackedDouble a) {
+    return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)};
+}
+inline PackedMask packedLess(PackedDouble a, PackedDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+inline PackedMask packedGreater(PackedDouble a, PackedDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+inline PackedDouble packedSelect(PackedMask m, PackedDouble a, PackedDouble b) {
+    return {_mm256_blendv_pd(b.v, a.v, m)};
+}
+
+// 2^n for integral n in [-1022, 1023], built directly in the exponent field
+inline PackedDouble packedPow2(PackedDouble n) {
+    __m256i bits = _mm256_castpd_si256(_mm256_add_pd(n.v, _mm256_set1_pd(6755399441055744.0)));
+    bits = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)), 52);
+    return {_mm256_castsi256_pd(bits)};
+}
+
+// Splits positive normal x into a mantissa in [1, 2) and its unbiased exponent
+inline PackedDouble packedFrexp(PackedDouble x, PackedDouble& exponent) {
+    __m256i bits = _mm256_castpd_si256(x.v);
+    __m256i e = _mm256_srli_epi64(bits, 52);
+    exponent.v = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000LL))),
+                               _mm256_set1_pd(4503599627371519.0));
+    __m256i m = _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                _mm256_set1_epi64x(0x3FF0000000000000LL));
+    return {_mm256_castsi256_pd(m)};
+}
+
+#endif
+
+inline PackedDouble operator-(PackedDouble a) { return packedSet(0.0) - a; }
+
+// Exponential (Cephes rational approximation), accurate to about 1 ulp for x in [-708, 709]
+inline PackedDouble packedExp(PackedDouble x) {
+    x = packedMin(packedMax(x, packedSet(-708.0)), packedSet(709.0));
+
+    PackedDouble n = packedRound(x * packedSet(1.4426950408889634073599));
+    x = packedFma(n, packedSet(-6.93145751953125e-1), x);
+    x = packedFma(n, packedSet(-1.42860682030941723212e-6), x);
+
+    PackedDouble xx = x * x;
+    PackedDouble px = packedFma(packedFma(packedSet(1.26177193074810590878e-4), xx,
+                                          packedSet(3.02994407707441961300e-2)), xx,
+                                packedSet(9.99999999999999999910e-1)) * x;
+    PackedDouble qx = packedFma(packedFma(packedFma(packedSet(3.00198505138664455042e-6), xx,
+                                                    packedSet(2.52448340349684104192e-3)), xx,
+                                          packedSet(2.27265548208155028766e-1)), xx,
+                                packedSet(2.00000000000000000009e0));
+    PackedDouble e = packedSet(1.0) + packedSet(2.0) * px / (qx - px);
+
+    return e * packedPow2(n);
+}
+
+// Natural logarithm (fdlibm polynomial) for positive normal inputs
+inline PackedDouble packedLog(PackedDouble x) {
+    PackedDouble k;
+    PackedDouble m = packedFrexp(x, k);
+
+    // Bring the mantissa into [sqrt(2)/2, sqrt(2)) so that f = m - 1 stays small
+    PackedMask large = packedGreater(m, packedSet(1.41421356237309504880));
+    m = packedSelect(large, m * packedSet(0.5), m);
+    k = packedSelect(large, k + packedSet(1.0), k);
+
+    PackedDouble f = m - packedSet(1.0);
+    PackedDouble s = f / (packedSet(2.0) + f);
+    PackedDouble z = s * s;
+    PackedDouble w = z * z;
+    PackedDouble t1 = w * packedFma(packedFma(packedSet(1.531383769920937332e-01), w,
+                                              packedSet(2.222219843214978396e-01)), w,
+                                    packedSet(3.999999999940941908e-01));
+    PackedDouble t2 = z * packedFma(packedFma(packedFma(packedSet(1.479819860511658591e-01), w,
+                                                        packedSet(1.818357216161805012e-01)), w,
+                                              packedSet(2.857142874366239149e-01)), w,
+                                    packedSet(6.666666666666735130e-01));
+    PackedDouble R = t1 + t2;
+    PackedDouble hfsq = packedSet(0.5) * f * f;
+
+    return k * packedSet(6.93147180369123816490e-01)
+         - ((hfsq - (s * (hfsq + R) + k * packedSet(1.90821492927058770002e-10))) - f);
+}
+
+// exp(-x^2 / 2), correcting for the rounding error of x * x as gaussianKernel in math_utils.h
+inline PackedDouble packedGaussianKernel(PackedDouble x) {
+    x = packedMin(packedAbs(x), packedSet(40.0));
+    PackedDouble square = x * x;
+    PackedDouble error = packedFma(x, x, -square);
+    return packedExp(packedSet(-0.5) * square) * packedFma(packedSet(-0.5), error, packedSet(1.0));
+}
+
+inline PackedDouble packedNormalPDF(PackedDouble x) {
+    return packedSet(0.39894228040143267794) * packedGaussianKernel(x);
+}
+
+// Counterpart of normalCDF(x, pdf) in math_utils.h
+inline PackedDouble packedNormalCDF(PackedDouble x, PackedDouble& pdf) {
+    PackedDouble a = packedMin(packedAbs(x), packedSet(40.0));
+    PackedDouble a2 = a * a;
+    PackedDouble a4 = a2 * a2;
+    auto pair = [&](double c1, double c0) { return packedFma(packedSet(c1), a, packedSet(c0)); };
+    PackedDouble numerator = packedFma(packedFma(pair(1.3579298331428026e-06, 3.663980117744294e-05), a2,
+                                                 pair(0.0004837313138343239, 0.00404353102351409)), a4,
+                                       packedFma(pair(0.02340872431650421, 0.09700532196357908), a2,
+                                                 pair(0.2877976724449385, 0.5919128149273417)));
+    numerator = packedFma(numerator, a2, pair(0.7734132764189351, 0.5));
+    PackedDouble high = packedFma(packedFma(packedSet(3.403825314732371e-06), a2,
+                                            pair(9.184236160584978e-05, 0.0012159384141165182)), a4,
+                                  packedFma(pair(0.01022747154226705, 0.05988269764290914), a2,
+                                            pair(0.25310821474561734, 0.777687981402208)));
+    PackedDouble denominator = packedFma(high, a4, packedFma(pair(1.70750467611014, 2.5546344269717673), a2,
+                                                             pair(2.3447111136407277, 1.0)));
+    PackedDouble kernel = packedGaussianKernel(a);
+    pdf = packedSet(0.39894228040143267794) * kernel;
+    PackedDouble tail = kernel * (numerator / denominator);
+    return packedSelect(packedLess(x, packedSet(0.0)), tail, packedSet(1.0) - tail);
+}
+
+inline PackedDouble packedNormalCDF(PackedDouble x) {
+    PackedDouble pdf;
+    return packedNormalCDF(x, pdf);
+}
+
+// Branch-free counterpart of inverseNormalCDF in math_utils.h
+inline PackedDouble packedInverseNormalCDF(PackedDouble p) {
+    PackedDouble q = p - packedSet(0.5);
+    PackedDouble r = q * q;
+    PackedDouble centralNumerator = packedFma(packedFma(packedFma(packedFma(packedFma(
+        packedSet(-3.969683028665376e+01), r, packedSet(2.209460984245205e+02)), r,
+        packedSet(-2.759285104469687e+02)), r, packedSet(1.383577518672690e+02)), r,
+        packedSet(-3.066479806614716e+01)), r, packedSet(2.506628277459239e+00));
+    PackedDouble centralDenominator = packedFma(packedFma(packedFma(packedFma(packedFma(
+        packedSet(-5.447609879822406e+01), r, packedSet(1.615858368580409e+02)), r,
+        packedSet(-1.556989798598866e+02)), r, packedSet(6.680131188771972e+01)), r,
+        packedSet(-1.328068155288572e+01)), r, packedSet(1.0));
+    PackedDouble central = centralNumerator * q / centralDenominator;
+
+    PackedDouble s = packedSqrt(packedSet(-2.0) * packedLog(packedMin(p, packedSet(1.0) - p)));
+    PackedDouble tailNumerator = packedFma(packedFma(packedFma(packedFma(packedFma(
+        packedSet(-7.784894002430293e-03), s, packedSet(-3.223964580411365e-01)), s,
+        packedSet(-2.400758277161838e+00)), s, packedSet(-2.549732539343734e+00)), s,
+        packedSet(4.374664141464968e+00)), s, packedSet(2.938163982698783e+00));
+    PackedDouble tailDenominator = packedFma(packedFma(packedFma(packedFma(
+        packedSet(7.784695709041462e-03), s, packedSet(3.224671290700398e-01)), s,
+        packedSet(2.445134137142996e+00)), s, packedSet(3.754408661907416e+00)), s, packedSet(1.0));
+    PackedDouble tail = tailNumerator / tailDenominator;
+    tail = packedSelect(packedLess(p, packedSet(0.5)), tail, -tail);
+
+    return packedSelect(packedGreater(packedAbs(q), packedSet(0.5 - 0.02425)), tail, central);
+}
+
+#endif // OPTION_PRICING_HAS_SIMD
+
+#endif // VECTOR_MATH_H